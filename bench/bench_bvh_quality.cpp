@@ -0,0 +1,116 @@
+#include "psx_collider.h"
+#include "psx_partition.h"
+#include "psx_ray.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+/*
+    tree quality report, builds each scene with the incremental tree, the
+    median split and the binned SAH builder. static level geometry is
+    attached to one spacial at offsets, the way levels are authored
+*/
+
+static constexpr U32 bench_rays = 4096;
+
+typedef void (*SceneFn)(Inst world, std::mt19937& rng, std::vector<Inst>& out);
+
+// uniform grid of equal tiles
+static void scene_grid(Inst world, std::mt19937& rng, std::vector<Inst>& out) {
+    for (U32 i = 0; i < 4096; ++i) {
+        out.push_back(collider_new_rect({ 30, 30 }, { .spacial = world, .offset = { (F32) (i % 64) * 32, (F32) (i / 64) * 32 } }));
+    }
+}
+
+// tight clusters of debris spread over a large level
+static void scene_clusters(Inst world, std::mt19937& rng, std::vector<Inst>& out) {
+    std::uniform_real_distribution<F32> center(-20000.f, 20000.f);
+    std::normal_distribution<F32> spread(0.f, 60.f);
+
+    for (U32 c = 0; c < 32; ++c) {
+        Vec2 at = { center(rng), center(rng) };
+        for (U32 i = 0; i < 128; ++i) {
+            out.push_back(collider_new_circle(6.f, { .spacial = world, .offset = { at.x + spread(rng), at.y + spread(rng) } }));
+        }
+    }
+}
+
+// long walls mixed with small props
+static void scene_mixed(Inst world, std::mt19937& rng, std::vector<Inst>& out) {
+    std::uniform_real_distribution<F32> pos(0.f, 8000.f);
+    std::uniform_real_distribution<F32> size(4.f, 40.f);
+
+    for (U32 i = 0; i < 64; ++i) {
+        bool horizontal = i % 2;
+        Vec2 area = horizontal ? Vec2{ 2000.f, 20.f } : Vec2{ 20.f, 2000.f };
+        out.push_back(collider_new_rect(area, { .spacial = world, .offset = { pos(rng), pos(rng) } }));
+    }
+
+    for (U32 i = 0; i < 4000; ++i) {
+        out.push_back(collider_new_rect({ size(rng), size(rng) }, { .spacial = world, .offset = { pos(rng), pos(rng) } }));
+    }
+}
+
+static double bench_rays_us(AABB bounds, std::mt19937& rng) {
+    std::uniform_real_distribution<F32> x(bounds.min.x, bounds.max.x);
+    std::uniform_real_distribution<F32> y(bounds.min.y, bounds.max.y);
+    std::uniform_real_distribution<F32> a(0.f, 2.f * (F32) M_PI);
+
+    U32 hits = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (U32 i = 0; i < bench_rays; ++i) {
+        F32 angle = a(rng);
+        PsxRay ray = { .origin = { x(rng), y(rng) }, .dir = { cosf(angle), sinf(angle) }, .max_dist = 500.f };
+        hits += ray_cast(ray).touched;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    (void) hits;
+
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static void report(const char* scene, const char* builder, AABB bounds) {
+    BvhQuality q = bvh_measure_quality();
+    std::mt19937 rng(1234); // same rays for every builder
+
+    printf("%s,%s,%u,%.3f,%u,%.2f,%.4f,%.1f\n", 
+        scene, builder, q.leaf_count, q.sah_cost, q.max_depth, q.avg_leaf_depth, q.overlap, 
+        bench_rays_us(bounds, rng));
+}
+
+int main() {
+    struct { const char* name; SceneFn fn; } scenes[] = {
+        { "grid", scene_grid },
+        { "clusters", scene_clusters },
+        { "mixed", scene_mixed },
+    };
+
+    printf("scene,builder,leaves,sah_cost,max_depth,avg_leaf_depth,overlap,rays_us\n");
+
+    for (auto& scene : scenes) {
+        std::mt19937 rng(42);
+        Inst world = spacial_new({ .flags = SPACIAL_FLAG_STATIC });
+        std::vector<Inst> colliders;
+
+        scene.fn(world, rng, colliders);
+
+        AABB bounds = bvh_get_node_box(bvh_get_root());
+
+        report(scene.name, "incremental", bounds);
+
+        collider_rebuild_bvh(BVH_BUILD_MEDIAN);
+        report(scene.name, "median", bounds);
+
+        collider_rebuild_bvh(BVH_BUILD_SAH);
+        report(scene.name, "sah", bounds);
+
+        for (Inst c : colliders) {
+            collider_free(c);
+        }
+        spacial_free(world);
+    }
+
+    return 0;
+}
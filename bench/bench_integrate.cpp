@@ -0,0 +1,169 @@
+#include "psx_kernel.h"
+#include "psx_spacial.h"
+#include <chrono>
+#include <vector>
+
+/*
+    micro benchmark for the integrator kernels
+
+    compares the pre-SoA integrator loop (fat structs, every slot visited,
+    expf per body) with the kernels on packed streams at every instruction
+    set the cpu supports. half the world is static, an eighth has no gravity
+*/
+
+static constexpr F32 bench_dt = 1.f / 60.f;
+static constexpr F32 bench_gravity = 1000.f;
+static constexpr F32 bench_seconds = 0.25f; // minimum runtime per case
+
+// PsxSpacial as it was laid out before the SoA streams
+struct LegacySpacial {
+    void* user_data;
+    Vec2 vel, force, pos, prev_pos;
+    F32 ang_vel, torque, ang, prev_ang;
+    F32 mass, inv_mass, inertia, inv_inertia;
+    U32 flags, index, layer, group;
+    bool in_use;
+};
+
+static void legacy_integrate(LegacySpacial* spacials, U32 count, F32 dt) {
+    for (U32 i = 0; i < count; ++i) {
+        LegacySpacial& s = spacials[i];
+        if (!s.in_use) continue;
+        if (s.flags & SPACIAL_FLAG_STATIC) continue;
+
+        Vec2 g_vector = { 0, 0 };
+        if (!(s.flags & SPACIAL_FLAG_NO_GRAV)) g_vector.y = bench_gravity;
+
+        Vec2 acc = (s.force * s.inv_mass) + g_vector;
+        s.vel += acc * dt;
+        s.vel *= expf(-CFG_DRAG_COEFFICIENT * dt);
+
+        s.ang_vel += s.torque * dt;
+        s.ang_vel *= expf(-CFG_ANG_DRAG_COEFFICIENT * dt);
+
+        s.force = { 0, 0 };
+        s.torque = 0.f;
+    }
+
+    for (U32 i = 0; i < count; ++i) {
+        LegacySpacial& s = spacials[i];
+        if (!s.in_use) continue;
+        if (s.flags & SPACIAL_FLAG_STATIC) continue;
+
+        s.prev_pos = s.pos;
+        s.prev_ang = s.ang;
+        s.pos += s.vel * dt;
+        s.ang += s.ang_vel * dt;
+    }
+}
+
+struct BenchStreams {
+    std::vector<Vec2> vel, force, pos, prev_pos;
+    std::vector<F32> ang_vel, torque, ang, prev_ang, inv_mass;
+    std::vector<U32> flags;
+
+    explicit BenchStreams(U32 n) 
+        : vel(n), force(n), pos(n), prev_pos(n), ang_vel(n), torque(n), 
+          ang(n), prev_ang(n), inv_mass(n), flags(n) {}
+
+    PsxKernelBodies bodies() {
+        return {
+            vel.data(), force.data(), pos.data(), prev_pos.data(),
+            ang_vel.data(), torque.data(), ang.data(), prev_ang.data(),
+            inv_mass.data(), flags.data(), (U32) vel.size()
+        };
+    }
+};
+
+static U32 bench_flags(U32 i) {
+    U32 flags = SPACIAL_FLAG_NONE;
+    if (i % 2) flags |= SPACIAL_FLAG_STATIC;
+    if (i % 8 == 0) flags |= SPACIAL_FLAG_NO_GRAV;
+    return flags;
+}
+
+// runs fn until bench_seconds have passed, returns seconds per call
+template <typename Fn>
+static double bench_time(Fn fn) {
+    using clock = std::chrono::steady_clock;
+
+    // warm up caches and clocks
+    for (U32 i = 0; i < 16; ++i) fn();
+
+    U32 calls = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < bench_seconds);
+
+    return elapsed / calls;
+}
+
+int main() {
+    const U32 sizes[] = { 1024, 8192, 65536 };
+    const PsxKernelIsa best = kernel_detect_isa();
+
+    printf("bodies,static,impl,dynamic_bodies_per_sec,speedup\n");
+
+    for (U32 n : sizes) {
+        const U32 dynamic_count = n / 2;
+
+        // legacy layout, static and dynamic bodies interleaved
+        std::vector<LegacySpacial> legacy(n);
+        for (U32 i = 0; i < n; ++i) {
+            LegacySpacial& s = legacy[i];
+            s = { };
+            s.in_use = true;
+            s.flags = bench_flags(i);
+            s.inv_mass = (s.flags & SPACIAL_FLAG_STATIC) ? 0.f : 1.f;
+            s.force = { 1.f, -2.f };
+        }
+
+        double legacy_time = bench_time([&]() { legacy_integrate(legacy.data(), n, bench_dt); });
+        printf("%u,%u,legacy,%.0f,1.00\n", n, n - dynamic_count, dynamic_count / legacy_time);
+
+        for (U32 isa = KERNEL_ISA_SCALAR; isa <= best; ++isa) {
+            kernel_set_isa((PsxKernelIsa) isa);
+            const char* name = kernel_isa_name((PsxKernelIsa) isa);
+
+            // packed awake list, only dynamic bodies
+            BenchStreams packed(dynamic_count);
+            for (U32 i = 0; i < dynamic_count; ++i) {
+                packed.flags[i] = bench_flags(i * 2);
+                packed.inv_mass[i] = 1.f;
+                packed.force[i] = { 1.f, -2.f };
+            }
+
+            // unpacked streams, static bodies handled by the masks
+            BenchStreams masked(n);
+            for (U32 i = 0; i < n; ++i) {
+                masked.flags[i] = bench_flags(i);
+                masked.inv_mass[i] = (masked.flags[i] & SPACIAL_FLAG_STATIC) ? 0.f : 1.f;
+                masked.force[i] = { 1.f, -2.f };
+            }
+
+            const PsxKernelBodies pb = packed.bodies();
+            const PsxKernelBodies mb = masked.bodies();
+
+            double packed_time = bench_time([&]() {
+                kernel_integrate_velocities(pb, kernel_make_step(bench_dt, bench_gravity));
+                kernel_integrate_positions(pb, bench_dt);
+            });
+
+            double masked_time = bench_time([&]() {
+                kernel_integrate_velocities(mb, kernel_make_step(bench_dt, bench_gravity));
+                kernel_integrate_positions(mb, bench_dt);
+            });
+
+            printf("%u,%u,%s_packed,%.0f,%.2f\n", n, n - dynamic_count, name, dynamic_count / packed_time, legacy_time / packed_time);
+            printf("%u,%u,%s_masked,%.0f,%.2f\n", n, n - dynamic_count, name, dynamic_count / masked_time, legacy_time / masked_time);
+        }
+    }
+
+    kernel_set_isa(best);
+    return 0;
+}
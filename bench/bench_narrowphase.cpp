@@ -0,0 +1,124 @@
+#include "psx_collider.h"
+#include "psx_manifold.h"
+#include "psx_world.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+/*
+    sat against gjk/epa on pairs of regular polygons, to find the vertex
+    count where gjk starts to win. pairs are spread so about half of them
+    overlap, every pair is tested cold without its cached separating axis.
+    normal_diff is the largest angle between the two paths' contact normals
+    in radians, depth_diff the largest difference of the deepest contact
+*/
+
+static constexpr U32 bench_pairs = 2048;
+static constexpr F32 bench_radius = 20.f;
+static constexpr F32 bench_seconds = 0.25f; // minimum runtime per case
+
+struct BenchPair { Inst a; Inst b; };
+
+// runs fn until bench_seconds have passed, returns seconds per call
+template <typename Fn>
+static double bench_time(Fn fn) {
+    using clock = std::chrono::steady_clock;
+
+    // warm up caches and clocks
+    for (U32 i = 0; i < 4; ++i) fn();
+
+    U32 calls = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < bench_seconds);
+
+    return elapsed / calls;
+}
+
+static Inst bench_polygon(const std::vector<Vec2>& shape, Vec2 pos, F32 ang) {
+    Inst s = spacial_new({ .pos = pos, .iang = ang, .flags = SPACIAL_FLAG_STATIC });
+    return collider_new_poly(GlxPolygon(shape.data(), (U32) shape.size()), 1.f, { .spacial = s });
+}
+
+static F32 bench_max_depth(const PsxManifold& m) {
+    F32 depth = 0.f;
+    for (U32 i = 0; i < m.contact_count; ++i) depth = fmaxf(depth, m.contacts[i].depth);
+    return depth;
+}
+
+int main() {
+    const U32 sizes[] = { 3, 4, 6, 8, 10, 12, 16, 20, 24, 32, 48, 64 };
+
+    printf("vertices,pair_vertices,sat_ns,gjk_ns,speedup,hits_sat,hits_gjk,normal_diff,depth_diff\n");
+
+    for (U32 n : sizes) {
+        PsxWorld* world = world_new();
+        PsxWorld* previous = world_bind(world);
+
+        std::vector<Vec2> shape(n);
+        for (U32 i = 0; i < n; ++i) {
+            F32 a = 2.f * (F32) M_PI * i / n;
+            shape[i] = { cosf(a) * bench_radius, sinf(a) * bench_radius };
+        }
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<F32> angle(0.f, 2.f * (F32) M_PI);
+        std::uniform_real_distribution<F32> dist(0.5f * bench_radius, 2.5f * bench_radius);
+
+        std::vector<BenchPair> pairs(bench_pairs);
+        for (U32 i = 0; i < bench_pairs; ++i) {
+            Vec2 at = { (F32) (i % 64) * 200.f, (F32) (i / 64) * 200.f };
+            F32 dir = angle(rng);
+            Vec2 to = at + Vec2{ cosf(dir), sinf(dir) } * dist(rng);
+
+            pairs[i] = { bench_polygon(shape, at, angle(rng)), bench_polygon(shape, to, angle(rng)) };
+        }
+
+        // both paths on every pair, compare what they found
+        std::vector<PsxManifold> sat(bench_pairs), gjk(bench_pairs);
+        std::vector<bool> sat_hit(bench_pairs), gjk_hit(bench_pairs);
+        U32 hits_sat = 0, hits_gjk = 0;
+
+        manifold_set_gjk_min_vertices(UINT32_MAX);
+        for (U32 i = 0; i < bench_pairs; ++i) hits_sat += sat_hit[i] = manifold_collide(pairs[i].a, pairs[i].b, sat[i]);
+
+        manifold_set_gjk_min_vertices(0);
+        for (U32 i = 0; i < bench_pairs; ++i) hits_gjk += gjk_hit[i] = manifold_collide(pairs[i].a, pairs[i].b, gjk[i]);
+
+        F32 normal_diff = 0.f, depth_diff = 0.f;
+        for (U32 i = 0; i < bench_pairs; ++i) {
+            if (!sat_hit[i] || !gjk_hit[i]) continue;
+
+            F32 c = f32_clamp(vec2_dot(sat[i].normal, gjk[i].normal), -1.f, 1.f);
+            normal_diff = fmaxf(normal_diff, acosf(c));
+            depth_diff = fmaxf(depth_diff, fabsf(bench_max_depth(sat[i]) - bench_max_depth(gjk[i])));
+        }
+
+        U32 sink = 0;
+        auto run = [&]() {
+            PsxManifold m;
+            for (const BenchPair& p : pairs) sink += manifold_collide(p.a, p.b, m);
+        };
+
+        manifold_set_gjk_min_vertices(UINT32_MAX);
+        double sat_time = bench_time(run) / bench_pairs;
+
+        manifold_set_gjk_min_vertices(0);
+        double gjk_time = bench_time(run) / bench_pairs;
+
+        (void) sink;
+
+        printf("%u,%u,%.1f,%.1f,%.2f,%u,%u,%.4f,%.4f\n",
+            n, 2 * n, sat_time * 1e9, gjk_time * 1e9, sat_time / gjk_time, hits_sat, hits_gjk, normal_diff, depth_diff);
+
+        world_bind(previous);
+        world_free(world);
+    }
+
+    return 0;
+}
@@ -0,0 +1,462 @@
+#include "psx_physics.h"
+#include "psx_material.h"
+#include "psx_ray.h"
+#include "psx_job.h"
+#include "psx_profile.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/*
+    headless stress scenes, each one runs a fixed number of steps at a fixed
+    dt and reports the time spent in every physics pass as CSV. every
+    scene runs in a world of its own, peak memory is the most its pools,
+    streams and vertex arena held at the end of any step
+
+    kinematix_bench [steps] [scene]
+*/
+
+static constexpr F32 bench_dt = 1.f / 60.f;
+static constexpr U32 bench_default_steps = 600;
+static constexpr U32 bench_storm_rays = 2048;
+
+enum BenchPhase : U32 {
+    BENCH_PHASE_INTEGRATE_VEL = 0,
+    BENCH_PHASE_FILTER,
+    BENCH_PHASE_BROADPHASE,
+    BENCH_PHASE_NARROWPHASE,
+    BENCH_PHASE_ISLANDS,
+    BENCH_PHASE_SOLVE,
+    BENCH_PHASE_INTEGRATE_POS,
+    BENCH_PHASE_CCD,
+    BENCH_PHASE_RAYCAST,
+    BENCH_PHASE_COUNT
+};
+
+// profiler zone every column is read from, physics_step records them all
+static const U32 bench_phase_zones[BENCH_PHASE_COUNT] = {
+    PROFILE_ZONE_INTEGRATE_VEL,
+    PROFILE_ZONE_FILTER,
+    PROFILE_ZONE_BROADPHASE,
+    PROFILE_ZONE_NARROWPHASE,
+    PROFILE_ZONE_ISLANDS,
+    PROFILE_ZONE_SOLVE,
+    PROFILE_ZONE_INTEGRATE_POS,
+    PROFILE_ZONE_CCD,
+    PROFILE_ZONE_RAYCAST,
+};
+
+static const char* bench_phase_names[BENCH_PHASE_COUNT] = {
+    "integrate_vel_ns",
+    "filter_ns",
+    "broadphase_ns",
+    "narrowphase_ns",
+    "islands_ns",
+    "solve_ns",
+    "integrate_pos_ns",
+    "ccd_ns",
+    "raycast_ns",
+};
+
+struct BenchScene {
+    std::vector<Inst> spacials;
+    std::vector<Inst> colliders;
+    std::mt19937 rng { 42 };
+    Inst material = NO_INSTANCE;
+    AABB bounds = {};       // where the raycast storm aims
+    U32 rays_per_step = 0;
+};
+
+typedef void (*BenchSetupFn)(BenchScene& scene);
+typedef void (*BenchStepFn)(BenchScene& scene, U32 step);
+
+/*
+    scene helpers
+*/
+
+static Inst bench_static(BenchScene& scene, Vec2 pos) {
+    Inst s = spacial_new({ .pos = pos, .flags = SPACIAL_FLAG_STATIC });
+    scene.spacials.push_back(s);
+    return s;
+}
+
+static Inst bench_body(BenchScene& scene, Vec2 pos) {
+    Inst s = spacial_new({ .pos = pos, .flags = SPACIAL_FLAG_RIGID });
+    scene.spacials.push_back(s);
+    return s;
+}
+
+static void bench_rect(BenchScene& scene, Inst spacial, Vec2 area, Vec2 offset = { 0, 0 }) {
+    scene.colliders.push_back(collider_new_rect(area, { .spacial = spacial, .material = scene.material, .offset = offset }));
+}
+
+static void bench_circle(BenchScene& scene, Inst spacial, F32 radius) {
+    scene.colliders.push_back(collider_new_circle(radius, { .spacial = spacial, .material = scene.material }));
+}
+
+// random convex polygon, vertices on a circle at sorted angles
+static void bench_poly(BenchScene& scene, Inst spacial, U32 count, F32 radius) {
+    std::uniform_real_distribution<F32> jitter(0.f, 0.6f);
+    Vec2 vertices[8];
+
+    for (U32 i = 0; i < count; ++i) {
+        F32 a = ((F32) i + jitter(scene.rng)) * 2.f * (F32) M_PI / (F32) count;
+        vertices[i] = { cosf(a) * radius, sinf(a) * radius };
+    }
+
+    scene.colliders.push_back(collider_new_poly(GlxPolygon(vertices, count), 1.f, { .spacial = spacial, .material = scene.material }));
+}
+
+// open box, floor at y = 0 and walls going up
+static void bench_container(BenchScene& scene, F32 width, F32 height) {
+    Inst world = bench_static(scene, { 0, 0 });
+
+    bench_rect(scene, world, { width + 200.f, 100.f }, { 0, 50.f });
+    bench_rect(scene, world, { 100.f, height }, { -width * 0.5f - 50.f, -height * 0.5f });
+    bench_rect(scene, world, { 100.f, height }, {  width * 0.5f + 50.f, -height * 0.5f });
+
+    scene.bounds = { { -width * 0.5f, -height }, { width * 0.5f, 0 } };
+}
+
+/*
+    scenes
+*/
+
+// box pyramid on a static floor, the classic stacking test
+static void scene_pyramid_setup(BenchScene& scene) {
+    constexpr U32 base = 30;
+    constexpr F32 size = 20.f;
+
+    bench_container(scene, base * size * 2.f, 200.f);
+
+    for (U32 row = 0; row < base; ++row) {
+        for (U32 i = 0; i < base - row; ++i) {
+            F32 x = ((F32) i - (F32) (base - row - 1) * 0.5f) * size;
+            F32 y = -size * 0.5f - (F32) row * size;
+            bench_rect(scene, bench_body(scene, { x, y }), { size, size });
+        }
+    }
+}
+
+// the pyramid with a random body freed every few steps once it settled, its collider outlives it
+static void scene_demolish_step(BenchScene& scene, U32 step) {
+    if (step < 180 || step % 10) return;
+
+    // the container is the first spacial, freeing a spacial twice is a no-op
+    std::uniform_int_distribution<size_t> body(1, scene.spacials.size() - 1);
+    spacial_free(scene.spacials[body(scene.rng)]);
+}
+
+// circles spawned in rows above a container until it fills up
+static void scene_rain_step(BenchScene& scene, U32 step) {
+    constexpr U32 per_row = 24;
+    constexpr U32 max_bodies = 2000;
+
+    if (step % 4 || scene.spacials.size() > max_bodies) return;
+
+    std::uniform_real_distribution<F32> jitter(-2.f, 2.f);
+    std::uniform_real_distribution<F32> radius(4.f, 8.f);
+
+    for (U32 i = 0; i < per_row; ++i) {
+        F32 x = ((F32) i - (F32) per_row * 0.5f) * 20.f + jitter(scene.rng);
+        bench_circle(scene, bench_body(scene, { x, -1000.f }), radius(scene.rng));
+    }
+}
+
+static void scene_rain_setup(BenchScene& scene) {
+    bench_container(scene, 600.f, 1200.f);
+}
+
+// random convex polygons dropped into a container
+static void scene_polygons_setup(BenchScene& scene) {
+    constexpr U32 count = 1000;
+
+    bench_container(scene, 800.f, 1600.f);
+
+    std::uniform_int_distribution<U32> sides(3, 8);
+    std::uniform_real_distribution<F32> radius(6.f, 14.f);
+
+    for (U32 i = 0; i < count; ++i) {
+        F32 x = ((F32) (i % 25) - 12.f) * 30.f;
+        F32 y = -30.f - (F32) (i / 25) * 30.f;
+        bench_poly(scene, bench_body(scene, { x, y }), sides(scene.rng), radius(scene.rng));
+    }
+}
+
+// large static tile level with a handful of moving bodies
+static void scene_level_setup(BenchScene& scene) {
+    constexpr U32 tiles_x = 128;
+    constexpr U32 tiles_y = 32;
+    constexpr F32 tile = 32.f;
+    constexpr U32 movers = 64;
+
+    Inst world = bench_static(scene, { 0, 0 });
+
+    // solid ground with a ragged surface and floating platforms
+    std::uniform_int_distribution<U32> ground(2, 6);
+    for (U32 x = 0; x < tiles_x; ++x) {
+        U32 top = ground(scene.rng);
+        for (U32 y = 0; y < tiles_y; ++y) {
+            bool solid = y < top || (y % 8 == 0 && x % 16 < 6);
+            if (!solid) continue;
+
+            bench_rect(scene, world, { tile, tile }, { (F32) x * tile, -(F32) y * tile });
+        }
+    }
+
+    std::uniform_real_distribution<F32> px(tile, (tiles_x - 1) * tile);
+    for (U32 i = 0; i < movers; ++i) {
+        bench_rect(scene, bench_body(scene, { px(scene.rng), -(F32) tiles_y * tile }), { 16.f, 16.f });
+    }
+
+    scene.bounds = { { 0, -(F32) tiles_y * tile }, { tiles_x * tile, 0 } };
+}
+
+// the level scene with a burst of rays every step
+static void scene_storm_setup(BenchScene& scene) {
+    scene_level_setup(scene);
+    scene.rays_per_step = bench_storm_rays;
+}
+
+// bullets fired across a field of thin static plates, swept with CCD
+static void scene_bullets_step(BenchScene& scene, U32 step) {
+    constexpr U32 per_burst = 8;
+    constexpr size_t max_bodies = 512;
+
+    if (step % 4 || scene.spacials.size() > max_bodies) return;
+
+    std::uniform_real_distribution<F32> angle(-0.4f, 0.4f);
+    std::uniform_real_distribution<F32> speed(3000.f, 6000.f);
+
+    for (U32 i = 0; i < per_burst; ++i) {
+        F32 a = angle(scene.rng);
+        F32 v = speed(scene.rng);
+
+        Inst s = spacial_new({
+            .pos = { -380.f, -100.f - (F32) i * 100.f },
+            .ivel = { cosf(a) * v, sinf(a) * v },
+            .flags = SPACIAL_FLAG_RIGID | SPACIAL_FLAG_BULLET,
+        });
+
+        scene.spacials.push_back(s);
+        bench_circle(scene, s, 3.f);
+    }
+}
+
+static void scene_bullets_setup(BenchScene& scene) {
+    bench_container(scene, 800.f, 1000.f);
+
+    Inst plates = bench_static(scene, { 0, 0 });
+    for (U32 x = 0; x < 6; ++x) {
+        for (U32 y = 0; y < 8; ++y) {
+            bench_rect(scene, plates, { 4.f, 80.f }, { -250.f + (F32) x * 100.f, -60.f - (F32) y * 115.f });
+        }
+    }
+}
+
+// capsule bodies on static segment ramps, or the same rods as 16 sided polygons
+static void bench_capsule_scene(BenchScene& scene, bool as_polygons) {
+    constexpr U32 count = 1000;
+    constexpr U32 sides = 16;
+
+    bench_container(scene, 800.f, 1600.f);
+
+    Inst ramps = bench_static(scene, { 0, 0 });
+    for (U32 y = 0; y < 4; ++y) {
+        F32 dir = (y & 1) ? 1.f : -1.f;
+        Vec2 a = { -300.f * dir, -200.f - (F32) y * 250.f };
+        Vec2 b = {  100.f * dir, -120.f - (F32) y * 250.f };
+        scene.colliders.push_back(collider_new_segment(a, b, { .spacial = ramps, .material = scene.material }));
+    }
+
+    std::uniform_real_distribution<F32> half(4.f, 12.f);
+    std::uniform_real_distribution<F32> radius(3.f, 6.f);
+
+    for (U32 i = 0; i < count; ++i) {
+        F32 x = ((F32) (i % 25) - 12.f) * 30.f;
+        F32 y = -1200.f - (F32) (i / 25) * 30.f;
+        Inst s = bench_body(scene, { x, y });
+
+        F32 h = half(scene.rng);
+        F32 r = radius(scene.rng);
+
+        if (!as_polygons) {
+            scene.colliders.push_back(collider_new_capsule({ -h, 0 }, { h, 0 }, r, { .spacial = s, .material = scene.material }));
+            continue;
+        }
+
+        // half circles around each end
+        Vec2 vertices[sides];
+        for (U32 v = 0; v < sides; ++v) {
+            U32 end = v / (sides / 2);
+            F32 a = (F32) M_PI * (-0.5f + (F32) (v % (sides / 2)) / (F32) (sides / 2 - 1) + (F32) end);
+            Vec2 c = end ? Vec2{ -h, 0 } : Vec2{ h, 0 };
+            vertices[v] = c + Vec2{ cosf(a), sinf(a) } * r;
+        }
+
+        scene.colliders.push_back(collider_new_poly(GlxPolygon(vertices, sides), 1.f, { .spacial = s, .material = scene.material }));
+    }
+}
+
+static void scene_capsules_setup(BenchScene& scene) {
+    bench_capsule_scene(scene, false);
+}
+
+static void scene_capsule_polys_setup(BenchScene& scene) {
+    bench_capsule_scene(scene, true);
+}
+
+// bodies built from 16 tiles each, as compounds or as loose colliders on the same spacial
+static void bench_compound_scene(BenchScene& scene, bool as_compounds) {
+    constexpr U32 count = 200;
+    constexpr U32 tiles = 4;
+    constexpr F32 tile = 8.f;
+
+    bench_container(scene, 800.f, 1600.f);
+
+    for (U32 i = 0; i < count; ++i) {
+        F32 x = ((F32) (i % 16) - 7.5f) * 45.f;
+        F32 y = -40.f - (F32) (i / 16) * 45.f;
+        Inst s = bench_body(scene, { x, y });
+
+        Inst compound = NO_INSTANCE;
+        if (as_compounds) {
+            compound = collider_new_compound({ .spacial = s });
+            scene.colliders.push_back(compound);
+        }
+
+        for (U32 t = 0; t < tiles * tiles; ++t) {
+            Vec2 offset = { ((F32) (t % tiles) - 1.5f) * tile, ((F32) (t / tiles) - 1.5f) * tile };
+            PsxColliderConfig cfg = { .spacial = s, .material = scene.material, .offset = offset, .compound = compound };
+
+            scene.colliders.push_back(collider_new_rect({ tile, tile }, cfg));
+        }
+    }
+}
+
+static void scene_compounds_setup(BenchScene& scene) {
+    bench_compound_scene(scene, true);
+}
+
+static void scene_compound_loose_setup(BenchScene& scene) {
+    bench_compound_scene(scene, false);
+}
+
+/*
+    runner
+*/
+
+// bytes held by the pools, streams and vertex arena of the bound world
+static U64 bench_memory_bytes() {
+    return spacial_memory_bytes() + collider_memory_bytes() + manifold_memory_bytes() + material_memory_bytes();
+}
+
+static void bench_raycast(BenchScene& scene) {
+    std::uniform_real_distribution<F32> x(scene.bounds.min.x, scene.bounds.max.x);
+    std::uniform_real_distribution<F32> y(scene.bounds.min.y, scene.bounds.max.y);
+    std::uniform_real_distribution<F32> a(0.f, 2.f * (F32) M_PI);
+
+    U32 hits = 0;
+    for (U32 i = 0; i < scene.rays_per_step; ++i) {
+        F32 angle = a(scene.rng);
+        PsxRay ray = { .origin = { x(scene.rng), y(scene.rng) }, .dir = { cosf(angle), sinf(angle) }, .max_dist = 400.f };
+        hits += ray_cast(ray).touched;
+    }
+
+    (void) hits;
+}
+
+static void bench_run(const char* name, BenchSetupFn setup, BenchStepFn step_fn, U32 steps) {
+    // every scene gets a world of its own, pools never shrink and would carry the last scene's peak
+    PsxWorld* world = world_new();
+    PsxWorld* previous = world_bind(world);
+
+    BenchScene scene;
+    scene.material = material_new({ .friction = 0.5f, .restitution = 0.f });
+
+    setup(scene);
+
+    U64 phase_ns[BENCH_PHASE_COUNT] = { };
+    U64 step_ns = 0;
+    U64 pairs_tested = 0;
+    U32 peak_manifolds = 0;
+    U64 peak_memory = bench_memory_bytes();
+    U32 created_before = count_manifolds_created();
+
+    for (U32 s = 0; s < steps; ++s) {
+        if (step_fn) step_fn(scene, s);
+
+        // the real step, every pass is timed by its own profiler zone
+        profile_reset();
+
+        physics_step(bench_dt);
+        if (scene.rays_per_step) bench_raycast(scene);
+
+        for (U32 p = 0; p < BENCH_PHASE_COUNT; ++p) {
+            PsxProfileStats stats = profile_summarize(bench_phase_zones[p]);
+            phase_ns[p] += stats.avg_ns * stats.count;
+        }
+
+        PsxProfileStats step = profile_summarize(PROFILE_ZONE_STEP);
+        step_ns += step.avg_ns * step.count;
+
+        pairs_tested += bvh_count_pairs_tested();
+        if (count_manifolds() > peak_manifolds) peak_manifolds = count_manifolds();
+        peak_memory = std::max(peak_memory, bench_memory_bytes());
+    }
+
+    // the whole step and the rays cast next to it
+    U64 total = step_ns + phase_ns[BENCH_PHASE_RAYCAST];
+
+    printf("%s,%u,%u,%zu,%zu,%u", name, job_thread_count(), steps, scene.spacials.size(), scene.colliders.size(), scene.rays_per_step);
+    for (U32 p = 0; p < BENCH_PHASE_COUNT; ++p) {
+        printf(",%llu", (unsigned long long) (phase_ns[p] / steps));
+    }
+    printf(",%llu,%llu,%u,%u,%llu\n",
+        (unsigned long long) (total / steps),
+        (unsigned long long) (pairs_tested / steps),
+        count_manifolds_created() - created_before,
+        peak_manifolds,
+        (unsigned long long) (peak_memory / 1024));
+    fflush(stdout);
+
+    world_bind(previous);
+    world_free(world);
+}
+
+int main(int argc, char** argv) {
+    U32 steps = argc > 1 ? (U32) atoi(argv[1]) : bench_default_steps;
+    const char* only = argc > 2 ? argv[2] : nullptr;
+
+    if (steps == 0) steps = bench_default_steps;
+
+    // the phase columns come from the profiler zones
+    profile_set_enabled(true);
+
+    struct { const char* name; BenchSetupFn setup; BenchStepFn step; } scenes[] = {
+        { "pyramid",  scene_pyramid_setup,  nullptr },
+        { "rain",     scene_rain_setup,     scene_rain_step },
+        { "polygons", scene_polygons_setup, nullptr },
+        { "level",    scene_level_setup,    nullptr },
+        { "raycast",  scene_storm_setup,    nullptr },
+        { "bullets",  scene_bullets_setup,  scene_bullets_step },
+        { "demolish", scene_pyramid_setup,  scene_demolish_step },
+        { "capsules", scene_capsules_setup, nullptr },
+        { "capsule_polys", scene_capsule_polys_setup, nullptr },
+        { "compounds", scene_compounds_setup, nullptr },
+        { "compound_loose", scene_compound_loose_setup, nullptr },
+    };
+
+    printf("scene,threads,steps,bodies,colliders,rays_per_step");
+    for (U32 p = 0; p < BENCH_PHASE_COUNT; ++p) {
+        printf(",%s", bench_phase_names[p]);
+    }
+    printf(",total_ns,pairs_tested_per_step,manifolds_created,peak_manifolds,peak_memory_kb\n");
+
+    for (auto& scene : scenes) {
+        if (only && strcmp(only, scene.name)) continue;
+        bench_run(scene.name, scene.setup, scene.step, steps);
+    }
+
+    return 0;
+}
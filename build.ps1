@@ -1,3 +1,3 @@
-g++ src/*.cpp src/libs/glad/*.c -Iinc -Isrc/libs -I. -lSDL2 -lopengl32 -o main.exe
+g++ src/*.cpp src/libs/glad/*.c -Iinc -Isrc/libs -I. -lSDL2 -lopengl32 -pthread -o main.exe
 ./main.exe
 rm main.exe
\ No newline at end of file
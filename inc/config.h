@@ -4,11 +4,29 @@
 /*
     psx config
 */
-#define CFG_MAX_MANIFOLDS 8000
-#define CFG_MAX_COLLIDERS 16000
-#define CFG_MAX_SPACIALS  8000
-#define CFG_MAX_MATERIALS 128
+#define CFG_POOL_CHUNK_SHIFT 8           // object pools grow by 1 << shift objects at a time
 #define CFG_MAX_RAYS 64
+#define CFG_MANIFOLD_TABLE_MIN 1024      // initial pair cache slots, power of two, doubled at half load
+#define CFG_VERTEX_ARENA_CHUNK 16384     // polygon vertices per arena chunk, power of two
+
+#define CFG_BVH_FAT_MARGIN 4.f           // leaf boxes are grown by this much
+#define CFG_BVH_DISPLACEMENT_SCALE 2.f   // and stretched along the step displacement
+#define CFG_BVH_BUILD_MODE BVH_BUILD_SAH  // builder used by bulk builds (BVH_BUILD_MEDIAN/BVH_BUILD_SAH)
+#define CFG_BVH_SAH_BINS 16
+#define CFG_BVH_SAH_TRAVERSAL_COST 1.f
+#define CFG_BVH_SAH_LEAF_COST 1.f
+#define CFG_BVH_TASKS_PER_THREAD 8       // subtree pair tasks handed to each thread
+
+/*
+    stepping
+*/
+#define CFG_FIXED_DT (1.f / 60.f)        // step of physics_advance
+#define CFG_MAX_SUBSTEPS 8               // steps physics_advance runs per call at most
+
+/*
+    job system
+*/
+#define CFG_JOB_THREADS 0                // 0 uses every hardware thread
 
 #define CFG_FILL_ON_COLLIDE false
 #define CFG_RENDER_BOUNDING_BOX false
@@ -16,15 +34,56 @@
 #define CFG_MANIFOLDS_RENDER true
 #define CFG_RENDER_FORCES false
 
+/*
+    solver
+*/
+#define CFG_SOLVER_ITERATIONS 8
+#define CFG_SOLVER_WARM_START true
+#define CFG_SOLVER_BLOCK true                  // solve both points of a manifold together
+#define CFG_SOLVER_MAX_CONDITION 1000.f        // block solve only while the point pair is well conditioned
+#define CFG_SOLVER_BAUMGARTE 0.2f              // fraction of the penetration pushed out per step
+#define CFG_SOLVER_SLOP 0.5f                   // penetration left alone to keep contacts alive
+#define CFG_SOLVER_RESTITUTION_THRESHOLD 30.f  // closing speed below which contacts do not bounce
+#define CFG_ISLAND_TASKS_PER_THREAD 4          // island batches handed to each thread by islands_solve
+#define CFG_SOLVER_COLOR_MIN 256               // manifolds in an island before it is graph colored and solved in SIMD rows
+#define CFG_SOLVER_COLOR_CHUNK 64              // least rows of a color per task, multiple of 8
+
+/*
+    sleeping
+*/
+#define CFG_SLEEP true                   // put resting islands to sleep
+#define CFG_SLEEP_LINEAR 4.f             // px/s a body has to stay below to count as resting
+#define CFG_SLEEP_ANGULAR 0.05f          // rad/s
+#define CFG_SLEEP_TIME 0.5f              // seconds every body of an island has to rest before it sleeps
+
+/*
+    narrowphase
+*/
+#define CFG_GJK_MIN_VERTICES 24          // polygon pairs with this many vertices together use gjk/epa instead of sat
+#define CFG_GJK_ITERATIONS 32
+#define CFG_EPA_ITERATIONS 32            // vertices epa adds to the simplex at most
+#define CFG_EPA_TOLERANCE 0.01f          // accepted error of the penetration depth
+#define CFG_CAPSULE_PARALLEL 0.05f       // sine of the angle below which capsules lying on each other get two contacts
+#define CFG_CAPSULE_FACE_SLOP 0.1f       // px a capsule can be further than a face plane and still rest on the face
+
+/*
+    continuous collision
+*/
+#define CFG_CCD_DEPTH 0.25f              // bullets are stopped this far inside what they hit so the narrowphase sees the contact
+#define CFG_CCD_TOLERANCE 0.1f           // accepted error of the stopping depth
+#define CFG_CCD_ITERATIONS 32            // conservative advancement steps per sweep
+#define CFG_CCD_SUBSTEPS 4               // sweeps per bullet and step, each one after bouncing off a static collider
+
 #define CFG_DRAG_COEFFICIENT 2.f
 #define CFG_ANG_DRAG_COEFFICIENT 2.f
 #define CFG_INTERTIA_SCALAR 500.f
 
 /*
-    analytics
+    profiler
 */
-#define CFG_ANALYTIC_LOG_INTERVAL 240
-#define CFG_ENABLE_ANALYTICS false
+#define CFG_PROFILE true                 // compile the profiler in, it stays off until profile_set_enabled
+#define CFG_PROFILE_RING_SIZE 32768      // samples kept, power of two
+#define CFG_PROFILE_MAX_THREADS 64       // threads with their own counters
 
 /*
     draw config
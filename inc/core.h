@@ -0,0 +1,81 @@
+#ifndef _CORE_H
+#define _CORE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include "math.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/*
+    core util, shared by the physics library and the renderer so no SDL or GL
+*/
+
+#define LOGI(fmt, ...) do { printf("I: " fmt "\n",##__VA_ARGS__); } while (0)
+#define LOGE(fmt, ...) do { printf("E: " fmt "\n",##__VA_ARGS__); } while (0)
+#define THROW(fmt, ...) do { LOGE(__FILE__ ":%i " fmt, __LINE__, ##__VA_ARGS__); exit(1); } while (0)
+
+template <typename T>
+inline void vswap(T& a, T& b) { T t = a; a = b; b = t; }
+
+typedef int32_t  S32;
+typedef uint32_t U32;
+typedef uint64_t U64;
+typedef float   F32;
+typedef uint8_t  U8;
+typedef int8_t   S8;
+
+#define F32_MAX 3.4e38
+
+typedef U32 Inst;
+#define NO_INSTANCE UINT32_MAX
+
+/*
+    handles, the low bits index a pool slot and the high bits hold the
+    generation of that slot when the handle was made
+*/
+#define INST_INDEX_BITS 24
+#define INST_INDEX_MASK ((1u << INST_INDEX_BITS) - 1)
+#define INST_MAX_INDEX (INST_INDEX_MASK - 1) // keeps NO_INSTANCE from being a valid handle
+
+inline U32 inst_index(Inst inst) { return inst & INST_INDEX_MASK; }
+inline U32 inst_generation(Inst inst) { return inst >> INST_INDEX_BITS; }
+inline Inst inst_make(U32 index, U32 generation) { return (generation << INST_INDEX_BITS) | index; }
+
+/*
+    error types
+*/
+
+typedef enum {
+    OK = 0x00,
+    ERROR = 0x01,
+} Status;
+
+typedef enum {
+    AXIS_X = 0,
+    AXIS_Y = 1
+} Axis;
+
+/*
+    utilities
+*/
+template <typename T>
+struct StaticBuffer {
+    const T* data;
+    U32 count;
+    U32 bytes;
+
+    // generate at compile time
+    template <U32 N>
+    constexpr StaticBuffer(const T (&arr)[N]) : data(arr), count(N), bytes(N * sizeof(T)) {};
+
+    // generate at runtime
+    StaticBuffer(const T* arr, const U32 N) : data(arr), count(N), bytes(N * sizeof(T)) {};
+};
+
+#endif
\ No newline at end of file
@@ -5,17 +5,7 @@
 #include "vector.h"
 #include "gl_wrapper.h"
 #include "gl_express.h"
-
-typedef StaticBuffer<Vec2> GlxPolygon;
-typedef struct { Vec2 min, max; } GlxBoundingBox, AABB;
-
-bool glx_aabb_check(const AABB& a, const AABB& b);
-
-AABB glx_aabb_merge(const AABB& a, const AABB& b);
-
-Vec2 glx_aabb_center(const AABB& bb);
-
-F32 glx_aabb_perimeter(const AABB& a);
+#include "glx_geometry.h"
 
 /*
     glx shapes
@@ -33,16 +23,4 @@ Status glx_rect_2d(GLX& glx, F32 x, F32 y, F32 w, F32 h, F32 angle = 0.f);
 // draw a circle
 Status glx_circle_2d(GLX& glx, F32 x, F32 y, F32 r, S32 lod = -1);
 
-// transform polygon with angle, viewport, scale, position
-void glx_transform_poly_2d(
-    Vec2 pos, 
-    Vec2* out, 
-    const Vec2* identity, 
-    U32 count, 
-    F32 scale = 1.f, 
-    F32 angle = 0.f, 
-    GlxBoundingBox* bounding_box = nullptr,
-    Vec2* center = nullptr
-);
-
 #endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef _GLX_GEOMETRY_H
+#define _GLX_GEOMETRY_H
+
+#include "core.h"
+#include "vector.h"
+
+/*
+    shape math shared by the physics library and the renderer, nothing in
+    here touches GL
+*/
+
+enum Shape {
+    SHAPE_NONE   = 0 << 0,
+    SHAPE_CIRCLE = 1 << 0,
+    SHAPE_RECT   = 1 << 1,
+    SHAPE_POLY   = 1 << 2,
+    SHAPE_POINT  = 1 << 3,
+    SHAPE_CAPSULE = 1 << 4,
+    SHAPE_SEGMENT = 1 << 5,
+    SHAPE_COMPOUND = 1 << 6
+};
+
+typedef StaticBuffer<Vec2> GlxPolygon;
+typedef struct { Vec2 min, max; } GlxBoundingBox, AABB;
+
+bool glx_aabb_check(const AABB& a, const AABB& b);
+
+AABB glx_aabb_merge(const AABB& a, const AABB& b);
+
+Vec2 glx_aabb_center(const AABB& bb);
+
+F32 glx_aabb_perimeter(const AABB& a);
+
+bool glx_aabb_contains(const AABB& outer, const AABB& inner);
+
+AABB glx_aabb_expand(const AABB& a, F32 margin);
+
+// transform polygon with angle, viewport, scale, position
+void glx_transform_poly_2d(
+    Vec2 pos, 
+    Vec2* out, 
+    const Vec2* identity, 
+    U32 count, 
+    F32 scale = 1.f, 
+    F32 angle = 0.f, 
+    GlxBoundingBox* bounding_box = nullptr,
+    Vec2* center = nullptr
+);
+
+// transform polygon by a precomputed rotation (cos, sin) in one pass, bounding_box is reset and center is the vertex mean
+void glx_transform_poly_2d(
+    Vec2 pos,
+    Vec2* out,
+    const Vec2* identity,
+    U32 count,
+    F32 scale,
+    Vec2 rot,
+    GlxBoundingBox& bounding_box,
+    Vec2& center
+);
+
+#endif
\ No newline at end of file
@@ -10,14 +10,6 @@
 #include "gl_express_shape.h"
 #include "config.h"
 
-enum Shape {
-    SHAPE_NONE   = 0 << 0,
-    SHAPE_CIRCLE = 1 << 0,
-    SHAPE_RECT   = 1 << 1,
-    SHAPE_POLY   = 1 << 2,
-    SHAPE_POINT  = 1 << 3
-};
-
 // define a polygon as a static buffer
 
 void shape_color(Color color);
@@ -1,8 +1,9 @@
 #ifndef _PSX_ALGO_H
 #define _PSX_ALGO_H
 
-#include "main.h"
+#include "core.h"
 #include "vector.h"
+#include "config.h"
 
 /*
     manifold helpers
@@ -12,21 +13,99 @@ void algo_project_1d(const Vec2* vertices, U32 count, const Vec2& axis, F32& min
 
 bool algo_overlap_1d(F32 min1, F32 max1, F32 min2, F32 max2);
 
+// true when the projections of a and b on axis don't overlap
+bool algo_axis_separates(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    const Vec2& axis
+);
+
+/*
+    test the edge normals of a as separating axes. returns false with the
+    separating edge in edge, otherwise keeps the shallowest overlap in
+    best_axis and best_depth. zero normals of degenerate edges are skipped
+*/
 bool algo_separate_axis(
-    const Vec2* poly_a, U32 poly_a_count, 
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count, 
     const Vec2* poly_b, U32 poly_b_count, 
     Vec2& best_axis, 
-    F32& best_depth
+    F32& best_depth,
+    U32& edge
+);
+
+// 1 for counter clockwise polygons, -1 for clockwise
+F32 algo_poly_winding(const Vec2* poly, U32 count);
+
+// unit outward normal of the edge starting at vertex edge
+Vec2 algo_edge_normal(const Vec2* poly, U32 count, U32 edge, F32 winding);
+
+// keep the part of a segment with dot(n, p) <= offset, a new point gets clip_id
+U32 algo_clip_segment(
+    const Vec2* in, const U32* in_ids,
+    Vec2* out, U32* out_ids,
+    const Vec2& n, F32 offset, U32 clip_id
+);
+
+/*
+    gjk/epa for large convex polygons. both only look at the vertices the
+    support function hill climbs over, sat projects every vertex on every
+    edge normal. simplex points are a[ia] - b[ib]
+*/
+
+struct PsxSimplexVertex {
+    Vec2 w;
+    U32 ia;
+    U32 ib;
+};
+
+struct PsxSimplex {
+    PsxSimplexVertex v[3];
+    F32 bary[3];
+    U32 count;
+};
+
+// vertex of a convex polygon furthest along dir, climbs from start so a nearby guess is cheap
+U32 algo_support(const Vec2* poly, U32 count, const Vec2& dir, U32 start);
+
+/*
+    true when a and b overlap, then simplex is the triangle around the origin
+    or has fewer points when the polygons only touch. otherwise simplex.v[0]
+    is a support pair of the closest features, a good seed for the next
+    query. seeds are read from simplex.v[0] when simplex.count is 1
+*/
+bool algo_gjk(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    PsxSimplex& simplex
 );
 
-U32 algo_find_segment(
-    const Vec2* poly,
-    const U32 count,
-    const Vec2& n,
-    Vec2* out
+/*
+    penetration of overlapping polygons from the triangle gjk left, normal
+    points from a to b. the normal is snapped to an edge normal of a or b so
+    it is a real face of the minkowski difference. normals are the unit
+    outward edge normals of each polygon. false without a triangle
+*/
+bool algo_epa(
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count,
+    const Vec2* poly_b, const Vec2* normals_b, U32 poly_b_count,
+    const PsxSimplex& simplex,
+    Vec2& normal,
+    F32& depth
+);
+
+/*
+    separation queries for time of impact, negative when overlapping
+*/
+
+// largest gap between b and the edge planes of a, a lower bound of the distance. axis is the outward normal of a
+F32 algo_poly_separation(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    Vec2& axis
 );
 
-bool algo_plane_contains_point(const Vec2* plane, const Vec2& point);
+// signed distance from point to a convex polygon, normal points from the polygon to point
+F32 algo_point_poly_distance(const Vec2* poly, U32 count, const Vec2& point, Vec2& normal);
 
 bool algo_plane_intersection(
     const Vec2& p1_a,
@@ -37,12 +116,30 @@ bool algo_plane_intersection(
     Vec2& normal
 );
 
-// returns number of contact point (1 or 2)
-// moves contact points to out
-Vec2 algo_get_contact_point(
-    const Vec2* poly_a, U32 poly_a_count, 
-    const Vec2* poly_b, U32 poly_b_count,
-    const Vec2& normal
+/*
+    reference/incident face clipping. the incident edge is clipped to the
+    side planes of the reference face and points behind the face are kept.
+    returns up to 2 points with their depths and feature ids, normal is
+    replaced by the reference face normal pointing from a to b. normals are
+    the unit outward edge normals of each polygon. b may be rounded by
+    radius_b, a capsule is its core segment as a 2 vertex polygon
+*/
+U32 algo_clip_contacts(
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count,
+    const Vec2* poly_b, const Vec2* normals_b, U32 poly_b_count,
+    Vec2& normal,
+    Vec2* points, F32* depths, U32* ids,
+    F32 radius_b = 0.f
 );
 
+/*
+    segment queries for capsules
+*/
+
+// point of the segment a b closest to p, t is its parameter along the segment
+Vec2 algo_closest_on_segment(const Vec2& a, const Vec2& b, const Vec2& p, F32& t);
+
+// closest points of the segments p1 q1 and p2 q2, returns their squared distance
+F32 algo_segments_closest(const Vec2& p1, const Vec2& q1, const Vec2& p2, const Vec2& q2, Vec2& c1, Vec2& c2);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef _PSX_ARENA_H
+#define _PSX_ARENA_H
+
+#include "core.h"
+#include "vector.h"
+#include "config.h"
+
+/*
+    vertex arena that owns every polygon's identity and transform vertices.
+    blocks are rounded up to a power of two and freed blocks go on a free
+    list per size class, new blocks are bumped off the end so polygons
+    spawned together sit next to each other. memory comes in chunks of
+    CFG_VERTEX_ARENA_CHUNK vertices that never move, a block never crosses
+    a chunk, so only growing the arena by a chunk allocates
+*/
+
+#define ARENA_MIN_CLASS 2 // smallest block is 4 vertices
+
+// offset of a block of at least count vertices, NO_INSTANCE if it's larger than a chunk
+U32 arena_alloc_vertices(U32 count);
+
+void arena_free_vertices(U32 offset, U32 count);
+
+Vec2* arena_get_vertices(U32 offset);
+
+// vertices a block of count really takes
+U32 arena_block_size(U32 count);
+
+/*
+    compaction, the owner of the blocks places every live block in
+    increasing offset order and points at the offset it got back. free
+    lists are dropped and empty chunks at the end are released
+*/
+void arena_compact_begin();
+
+U32 arena_compact_place(U32 from, U32 count);
+
+void arena_compact_end();
+
+// vertices bumped off the arena so far, live or free
+U32 arena_count_top();
+
+// vertices in live blocks
+U32 arena_count_used();
+
+U64 arena_memory_bytes();
+
+// per world state, owned by PsxWorld
+struct PsxArenaState;
+
+PsxArenaState* arena_state_new();
+
+void arena_state_free(PsxArenaState* state);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef _PSX_CCD_H
+#define _PSX_CCD_H
+
+#include "core.h"
+#include "vector.h"
+#include "config.h"
+
+/*
+    continuous collision for bullets, spacials flagged SPACIAL_FLAG_BULLET.
+    once the positions are integrated every collider of a bullet is swept
+    from prev_pos/prev_ang to pos/ang against the BVH and the time of impact
+    is found by conservative advancement. a bullet that hits something is
+    put back at the time of impact, CFG_CCD_DEPTH inside the other collider
+    so the next narrowphase picks the contact up. off static colliders the
+    bullet bounces and sweeps on for the rest of the step, up to
+    CFG_CCD_SUBSTEPS times, hits on dynamic bodies are left to the solver
+*/
+
+// motion of a spacial over part of a step
+struct PsxSweep {
+    Vec2 pos0;
+    F32 ang0;
+    Vec2 pos1;
+    F32 ang1;
+};
+
+struct PsxToi {
+    bool hit;
+    F32 t;       // fraction of the sweep
+    Vec2 normal; // from the swept collider to the other one, zero when advancement ran out of iterations short of it
+};
+
+// sweep collider with its spacial along sweep against other, which stays where the last collider update put it
+PsxToi ccd_time_of_impact(Inst collider, const PsxSweep& sweep, Inst other);
+
+// sweep every awake bullet, runs after spacial_integrate_positions
+void ccd_solve(F32 dt);
+
+#endif
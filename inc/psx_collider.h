@@ -1,13 +1,14 @@
 #ifndef _PSX_COLLIDER_H
 #define _PSX_COLLIDER_H
 
-#include "main.h"
+#include "core.h"
 #include "vector.h"
 #include "config.h"
 #include "psx_spacial.h"
-#include "glx_shape.h"
+#include "glx_geometry.h"
 #include "psx_manifold.h"
 #include "psx_partition.h"
+#include "psx_arena.h"
 
 enum PsxColliderPhase : U32 {
     COLLIDER_PHASE_NONE   = 0 << 0,  // not running any collision checks
@@ -20,12 +21,41 @@ struct PsxCircleCollider {
     F32 radius;
 };
 
+/*
+    identity, transform and the edge normals are one block of the vertex
+    arena in that order. normal i is the unit outward normal of the edge
+    from vertex i to i + 1, computed once from the scaled identity and
+    rotated along with the transform. degenerate edges have a zero normal
+*/
 struct PsxPolyCollider {
     Vec2* identity;
     Vec2* transform;
+    Vec2* local_normals;
+    Vec2* normals;
     Vec2 center;
     F32 scale;
     U32 count;
+    U32 arena; // offset of the block
+};
+
+/*
+    a capsule is every point within radius of its core segment, a segment
+    collider is a capsule of radius 0. local endpoints are around the
+    collider offset, world is where the last collider update put them
+*/
+struct PsxCapsuleCollider {
+    Vec2 local[2];
+    Vec2 world[2];
+    F32 radius;
+};
+
+/*
+    a compound groups colliders of one spacial under a single leaf of the
+    global tree, its children sit in a local tree (see psx_partition.h).
+    children are placed by their own offsets on the spacial
+*/
+struct PsxCompoundCollider {
+    Inst tree;
 };
 
 struct PsxColliderConfig {
@@ -33,6 +63,7 @@ struct PsxColliderConfig {
     Inst material = NO_INSTANCE;
     Vec2 offset;
     void* user_data;
+    Inst compound = NO_INSTANCE; // join this compound, the spacial is taken from it
 };
 
 struct PsxCollider {
@@ -46,6 +77,8 @@ struct PsxCollider {
     union {
        PsxCircleCollider circ;
        PsxPolyCollider   poly;
+       PsxCapsuleCollider caps;
+       PsxCompoundCollider comp;
     };
     
     Shape shape;
@@ -55,24 +88,51 @@ struct PsxCollider {
     Inst material;      // reference to collider material
     U32 id;             // index of collider in g_colliders
     U32 phase;          // current phase of collision
-
-    U8* heap_buffer;
-    U32 alloc_bytes = 0;
+    Inst bvh_leaf;      // leaf in the dynamic tree
+    U32 moving_index;   // position in the moving list, NO_INSTANCE when static or sleeping
+    Inst next;          // next collider on the same spacial
+    Inst compound;      // compound this collider is a child of, NO_INSTANCE when it has its own leaf
+
+    // spacial pose the transform and bounding box were computed for
+    Vec2 pose_pos;
+    F32 pose_ang;
 };
 
 PsxCollider& collider_get(U32 index); // get reference to existing collider
 
+// false for NO_INSTANCE and handles of freed colliders
+bool collider_valid(Inst collider);
+
+// current handle of a pool slot, for walking every slot up to count_collider_slots
+Inst collider_handle(U32 slot);
+
 PsxCollider& collider_alloc();
 
 void collider_free(U32 index);
 
-void collider_update(Inst collider);
+// recompute transform and bounding box, returns false when the spacial hasn't moved since the last update
+bool collider_update(Inst collider);
 
 void collider_filter_updated();
 
 void collider_build_bvh();
 
-void collider_make_heap_buffer(PsxCollider& collider, U32 size);
+enum BvhBuildMode : U32;
+
+void collider_rebuild_bvh(); // uses CFG_BVH_BUILD_MODE
+
+void collider_rebuild_bvh(BvhBuildMode mode);
+
+void collider_add_phase(PsxCollider& c, U32 phase);
+
+// take a collider of a sleeping island off the moving list, or put it back
+void collider_set_sleeping(PsxCollider& c, bool sleeping);
+
+// the spacial is going away, its colliders leave the broadphase and their manifolds but stay allocated
+void colliders_detach_spacial(Inst spacial);
+
+// pack every polygon's vertices to the front of the arena and release empty chunks, e.g. after a level unload
+void collider_compact_vertices();
 
 
 /*
@@ -85,6 +145,14 @@ Inst collider_new_rect(Vec2 area, PsxColliderConfig cfg = {});
 
 Inst collider_new_poly(GlxPolygon identity, F32 scale = 1.f, PsxColliderConfig cfg = {});
 
+// endpoints a and b are relative to the collider offset
+Inst collider_new_capsule(Vec2 a, Vec2 b, F32 radius, PsxColliderConfig cfg = {});
+
+Inst collider_new_segment(Vec2 a, Vec2 b, PsxColliderConfig cfg = {});
+
+// empty compound on cfg.spacial, colliders join it through PsxColliderConfig::compound. freeing it frees its children
+Inst collider_new_compound(PsxColliderConfig cfg = {});
+
 /*
     get properties
 */
@@ -111,10 +179,20 @@ const AABB& collider_get_bounding_box(Inst collider);
 /*
     base utility
 */
-void collider_draw(Inst collider);
 
-void collider_draw_all();
+// slots handed out so far, live or free
+U32 count_collider_slots();
 
 U32 count_colliders();
 
+// pool, list and vertex arena memory
+U64 collider_memory_bytes();
+
+// per world state, owned by PsxWorld
+struct PsxColliderState;
+
+PsxColliderState* collider_state_new();
+
+void collider_state_free(PsxColliderState* state);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef _PSX_DEBUG_DRAW_H
+#define _PSX_DEBUG_DRAW_H
+
+#include "main.h"
+#include "config.h"
+#include "glx_shape.h"
+#include "psx_collider.h"
+#include "psx_manifold.h"
+#include "psx_partition.h"
+#include "psx_spacial.h"
+
+/*
+    debug drawing of the physics state through the glx renderer. this is
+    the only physics code that needs SDL/GL and it is built separately from
+    the physics library
+*/
+
+// colliders are drawn at their spacial's interpolated pose, alpha from physics_get_alpha
+void collider_draw(Inst collider, F32 alpha = 1.f);
+
+void collider_draw_all(F32 alpha = 1.f);
+
+void manifolds_render();
+
+void bvh_render();
+
+void spacial_render();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef _PSX_ISLAND_H
+#define _PSX_ISLAND_H
+
+#include "core.h"
+#include "config.h"
+
+/*
+    islands are the connected parts of the contact graph, dynamic bodies
+    joined by touching manifolds. static bodies don't join islands, a floor
+    doesn't glue everything on it together. islands_build numbers the awake
+    islands every step after the narrowphase, islands_solve solves them in
+    parallel since they share no dynamic body, islands_sleep puts an island
+    to sleep once every body in it stayed below the sleep thresholds for
+    CFG_SLEEP_TIME. a sleeping island is parked outside the awake range of
+    the streams, off the moving list and out of the solver until something
+    touches or pushes one of its bodies
+*/
+
+// awake islands of the last islands_build, bodies and manifolds are stored per island
+struct PsxIslandList {
+    const U32* body_start;      // island i owns bodies [body_start[i], body_start[i + 1])
+    const U32* bodies;          // stream slots
+    const U32* manifold_start;  // island i owns manifolds [manifold_start[i], manifold_start[i + 1])
+    const Inst* manifolds;
+    U32 count;
+};
+
+// wake sleeping islands touched by awake bodies and group the awake bodies into islands
+void islands_build();
+
+/*
+    solve the manifolds of the awake islands on the job pool. islands below
+    CFG_SOLVER_COLOR_MIN manifolds give the same result as manifolds_solve,
+    larger ones are graph colored and solved in SIMD rows. either way the
+    result is the same for any thread count
+*/
+void islands_solve(F32 dt, U32 iterations);
+
+void islands_solve(F32 dt);
+
+// advance the sleep timers of the awake bodies and put resting islands to sleep
+void islands_sleep(F32 dt);
+
+// wake the island of spacial, returns true if it was sleeping and has moved slots. resets the sleep timer of awake bodies
+bool island_wake(Inst spacial);
+
+PsxIslandList island_list();
+
+// islands currently asleep
+U32 count_sleeping_islands();
+
+// per world state, owned by PsxWorld
+struct PsxIslandState;
+
+PsxIslandState* island_state_new();
+
+void island_state_free(PsxIslandState* state);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _PSX_JOB_H
+#define _PSX_JOB_H
+
+#include "core.h"
+#include "config.h"
+
+/*
+    fixed pool of worker threads with work stealing. a batch of tasks is
+    spread over per thread queues, threads that run dry steal from the
+    others. the calling thread takes part as thread 0
+*/
+
+// index is the task, thread is in [0, job_thread_count())
+typedef void (*PsxJobFn)(void* data, U32 index, U32 thread);
+
+// 0 picks the hardware thread count
+void job_init(U32 thread_count = CFG_JOB_THREADS);
+
+void job_shutdown();
+
+U32 job_thread_count();
+
+// run fn for every index in [0, count) and wait for all of them
+void job_parallel_for(U32 count, PsxJobFn fn, void* data);
+
+#endif
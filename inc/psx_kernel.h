@@ -0,0 +1,132 @@
+#ifndef _PSX_KERNEL_H
+#define _PSX_KERNEL_H
+
+#include "core.h"
+#include "vector.h"
+
+/*
+    vectorized integrator and contact kernels, the instruction set is picked
+    at runtime and falls back to scalar code when SSE/AVX2 are not available
+*/
+
+enum PsxKernelIsa : U32 {
+    KERNEL_ISA_SCALAR = 0,
+    KERNEL_ISA_SSE    = 1, // 4 bodies per iteration
+    KERNEL_ISA_AVX2   = 2, // 8 bodies per iteration
+};
+
+// contiguous body streams the kernels run over
+struct PsxKernelBodies {
+    Vec2* vel;
+    Vec2* force;
+    Vec2* pos;
+    Vec2* prev_pos;
+
+    F32* ang_vel;
+    F32* torque;
+    F32* ang;
+    F32* prev_ang;
+
+    const F32* inv_mass;
+    const U32* flags;
+
+    U32 count;
+};
+
+// per step constants, drag factors are computed once and not per body
+struct PsxKernelStep {
+    F32 dt;
+    F32 gravity;
+    F32 drag;     // expf(-CFG_DRAG_COEFFICIENT * dt)
+    F32 ang_drag; // expf(-CFG_ANG_DRAG_COEFFICIENT * dt)
+};
+
+PsxKernelStep kernel_make_step(F32 dt, F32 gravity);
+
+// static bodies and bodies without mass are masked out, not branched over
+void kernel_integrate_velocities(const PsxKernelBodies& b, const PsxKernelStep& step);
+
+void kernel_integrate_positions(const PsxKernelBodies& b, F32 dt);
+
+/*
+    contact rows of the colored solver, one manifold per lane with up to two
+    points. velocities are gathered from the body streams by slot and
+    scattered back, a body without inverse mass is read but never written.
+    a manifold with one point has zero masses and impulses on the second
+*/
+struct PsxKernelContacts {
+    Vec2* vel;
+    F32* ang_vel;
+
+    const U32* body_a; // stream slots
+    const U32* body_b;
+
+    const F32* normal_x;
+    const F32* normal_y;
+    const F32* tangent_x;
+    const F32* tangent_y;
+    const F32* friction;
+
+    const F32* inv_mass_a;
+    const F32* inv_mass_b;
+    const F32* inv_inertia_a;
+    const F32* inv_inertia_b;
+
+    // 2x2 normal mass matrix and its inverse, used where block is set
+    const U32* block;
+    const F32* k11;
+    const F32* k12;
+    const F32* k22;
+    const F32* inv_k11;
+    const F32* inv_k12;
+    const F32* inv_k22;
+
+    // per point
+    const F32* ra_x[2];
+    const F32* ra_y[2];
+    const F32* rb_x[2];
+    const F32* rb_y[2];
+    const F32* normal_mass[2];
+    const F32* tangent_mass[2];
+    const F32* bias[2];
+    F32* normal_impulse[2];
+    F32* tangent_impulse[2];
+};
+
+// one velocity iteration over rows [begin, end), no two of them may share a dynamic body
+void kernel_solve_contacts(const PsxKernelContacts& c, U32 begin, U32 end);
+
+// rows a vector kernel solves at once for the current instruction set
+U32 kernel_contact_width();
+
+/*
+    circle pairs of the narrowphase, one pair per lane. centers and summed
+    radii are gathered by the caller, the kernel writes the squared center
+    distance and sets hit to all ones where the circles overlap
+*/
+struct PsxKernelCircles {
+    const F32* ax;
+    const F32* ay;
+    const F32* bx;
+    const F32* by;
+    const F32* radius; // sum of both radii
+
+    F32* dist_sq;
+    U32* hit;
+
+    U32 count;
+};
+
+void kernel_collide_circles(const PsxKernelCircles& c);
+
+// best instruction set supported by the cpu
+PsxKernelIsa kernel_detect_isa();
+
+PsxKernelIsa kernel_get_isa();
+
+// force an instruction set, clamped to what the cpu supports
+PsxKernelIsa kernel_set_isa(PsxKernelIsa isa);
+
+const char* kernel_isa_name(PsxKernelIsa isa);
+
+#endif
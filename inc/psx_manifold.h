@@ -1,38 +1,92 @@
 #ifndef _PSX_MANIFOLD_H
 #define _PSX_MANIFOLD_H
 
-#include "main.h"
+#include "core.h"
 #include "vector.h"
 #include "config.h"
 #include "psx_collider.h"
 #include "psx_material.h"
 #include "psx_algo.h"
+#include <vector>
 
 #define MM_MAX_CONTACT_PTS 2
 
+// contact point, impulses are accumulated and kept between steps to warm start the solver
+struct PsxContact {
+    Vec2 point;
+    F32  depth;
+    U32  id; // feature key used to match contacts between steps
+
+    F32  normal_impulse;
+    F32  tangent_impulse;
+
+    // solver prestep
+    Vec2 ra;
+    Vec2 rb;
+    F32  normal_mass;
+    F32  tangent_mass;
+    F32  bias;
+};
+
+// persistent per collider pair, kept while the pair is touching
 struct PsxManifold {
     void* user_data;
 
     Vec2 normal;
     Vec2 tangent;
-    Vec2 contact;
+
+    PsxContact contacts[MM_MAX_CONTACT_PTS];
+    U32 contact_count;
 
     Inst collider_a;
     Inst collider_b;
+    Inst spacial_a;
+    Inst spacial_b;
 
     U32 index;
-    F32 depth;
+    U32 step; // last step the pair was touching
+
+    F32 friction;
+    F32 restitution;
+
+    // solver prestep
+    F32 inv_mass_a;
+    F32 inv_mass_b;
+    F32 inv_inertia_a;
+    F32 inv_inertia_b;
+
+    // normal mass matrix of two point manifolds and its inverse
+    F32 k11, k12, k22;
+    F32 inv_k11, inv_k12, inv_k22;
 
     bool colliding;
+    bool active;
+    bool sleeping; // part of a sleeping island, kept but not solved
+    bool block;
     bool in_use;
 };
 
 PsxManifold& manifold_get(Inst manifold); // get reference to existing manifold
 
+// false for NO_INSTANCE and handles of freed manifolds
+bool manifold_valid(Inst manifold);
+
+// current handle of a pool slot, for walking every slot up to count_manifold_slots
+Inst manifold_handle(U32 slot);
+
 PsxManifold& manifold_alloc();
 
 void manifold_free(Inst manifold);
 
+// free every manifold a collider is part of
+void manifolds_free_collider(Inst collider);
+
+// order independent key of a collider pair
+U64 manifold_pair_key(Inst collider_a, Inst collider_b);
+
+// cached manifold of a collider pair or NO_INSTANCE
+Inst manifold_find(Inst collider_a, Inst collider_b);
+
 Inst manifold_new(
     Inst collider_a, 
     Inst collider_b, 
@@ -43,20 +97,101 @@ Inst manifold_new(
     F32  depth         = 0.f
 );
 
-void manifold_solve(const PsxManifold& m, F32 dt);
+// compute contact masses and biases and apply the warm start impulses
+void manifold_prestep(PsxManifold& m, F32 inv_dt);
+
+// one velocity iteration over the contacts of a manifold
+void manifold_solve(PsxManifold& m);
+
+// prestep every cached manifold and run the velocity iterations, single threaded. islands_solve splits the same work over the job pool
+void manifolds_solve(F32 dt, U32 iterations);
 
 void manifolds_solve(F32 dt);
 
 bool manifold_get_colliding(Inst manifold);
 
-void manifolds_render();
-
 /*
     get a manifolder between two colliders
 */
 
 Inst manifold_generate(U32 collider_a, U32 collider_b);
 
+// narrowphase only, does not touch the manifold pool so workers can call it
+bool manifold_collide(U32 collider_a, U32 collider_b, PsxManifold& out);
+
+/*
+    batched narrowphase. candidate pairs are bucketed by the kind of their
+    shape pair and every bucket runs through one routine, circle pairs are
+    tested in SIMD rows. capsules and segments share a kind, shapes
+    without a routine share kind 0 and never touch
+*/
+
+#define MM_SHAPE_KINDS 4 // none, circle, poly, capsule
+#define MM_PAIR_KINDS (MM_SHAPE_KINDS * MM_SHAPE_KINDS)
+
+// axis is set to the separating axis to cache, NO_INSTANCE when the pair touched
+struct PsxCollidePair {
+    Inst a;
+    Inst b;
+    U32 axis;
+};
+
+typedef void (*PsxCollideBatchFn)(PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts);
+
+U32 manifold_shape_kind(U32 shape);
+
+U32 manifold_pair_kind(U32 shape_a, U32 shape_b);
+
+// collide pairs of one kind, touching pairs are appended to contacts
+void manifold_collide_batch(U32 kind, PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts);
+
+/*
+    same, axis is the pair's cached separating axis from manifold_sat_axis
+    and is tested before any other. when the pair is apart it returns the
+    axis that separated them, NO_INSTANCE otherwise
+*/
+bool manifold_collide(U32 collider_a, U32 collider_b, PsxManifold& out, U32& axis);
+
+/*
+    separating axis cache. pairs whose boxes touch but whose shapes don't
+    keep the edge that separated them, most of them are still apart along
+    it next step and exit after one projection. the cache of the last pass
+    is read only while the next one is filled, so workers can read it
+*/
+U32 manifold_sat_axis(Inst collider_a, Inst collider_b);
+
+// remember the separating axis of a pair for the next narrowphase pass
+void manifold_sat_store(Inst collider_a, Inst collider_b, U32 axis);
+
+// polygon pairs with this many vertices together go through gjk/epa, the rest through sat. defaults to CFG_GJK_MIN_VERTICES
+void manifold_set_gjk_min_vertices(U32 vertices);
+
+U32 manifold_get_gjk_min_vertices();
+
+// add or refresh the cached manifold of the pair, impulses of matching contacts are kept
+Inst manifold_store(const PsxManifold& m);
+
+// bracket a narrowphase pass, pairs not stored in between are freed at the end
+void manifolds_begin_update();
+
+void manifolds_end_update();
+
+// slots handed out so far, live or free
+U32 count_manifold_slots();
+
 U32 count_manifolds();
 
+// pool, pair cache and separating axis cache memory
+U64 manifold_memory_bytes();
+
+// manifolds allocated since startup, new pairs only, cached pairs are not counted again
+U32 count_manifolds_created();
+
+// per world state, owned by PsxWorld
+struct PsxManifoldState;
+
+PsxManifoldState* manifold_state_new();
+
+void manifold_state_free(PsxManifoldState* state);
+
 #endif
\ No newline at end of file
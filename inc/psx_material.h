@@ -1,7 +1,7 @@
 #ifndef _PSX_MATERIAL_H
 #define _PSX_MATERIAL_H
 
-#include "main.h"
+#include "core.h"
 #include "config.h"
 
 struct PsxMaterialConfig {
@@ -23,6 +23,9 @@ extern PsxMaterial g_default_material;
 
 PsxMaterial& material_get(Inst material);
 
+// false for NO_INSTANCE and handles of freed materials
+bool material_valid(Inst material);
+
 PsxMaterial& material_alloc();
 
 void material_free(Inst material);
@@ -32,4 +35,19 @@ Inst material_new(PsxMaterialConfig config);
 F32 material_get_friction(Inst material);
 
 F32 material_get_restitution(Inst material);
+
+// combined values of two touching materials
+F32 material_mix_friction(Inst a, Inst b);
+
+F32 material_mix_restitution(Inst a, Inst b);
+
+U64 material_memory_bytes();
+
+// per world state, owned by PsxWorld
+struct PsxMaterialState;
+
+PsxMaterialState* material_state_new();
+
+void material_state_free(PsxMaterialState* state);
+
 #endif 
\ No newline at end of file
@@ -1,42 +1,123 @@
 #ifndef _PSX_PARTITION_H
 #define _PSX_PARTITION_H
 
-#include "main.h"
-#include "glx_shape.h"
+#include "core.h"
+#include "glx_geometry.h"
 #include "psx_spacial.h"
 #include "psx_collider.h"
 #include "psx_ray.h"
+#include <vector>
 
+/*
+    persistent dynamic AABB tree, leaves hold fattened collider boxes so a
+    collider is only reinserted once it leaves its fat box
+*/
 struct BvhNode {
     AABB box;
-    Inst parent = NO_INSTANCE;
+    Inst parent = NO_INSTANCE;  // next free node while on the free list
     Inst child1 = NO_INSTANCE;
     Inst child2 = NO_INSTANCE;
     Inst collider = NO_INSTANCE;
+    S32 height = -1;            // leaf = 0, free = -1
+    bool dynamic = false;       // subtree contains a non static leaf
 };
 
 bool bvh_is_leaf(const BvhNode& node);
 
 Inst bvh_new_node();
 
+void bvh_free_node(Inst id);
+
 BvhNode& bvh_get_node(Inst id);
 
+Inst bvh_get_root();
+
 void bvh_set_node_parent(Inst id, Inst parent);
 
 const AABB& bvh_get_node_box(Inst id);
 
+/*
+    incremental updates
+*/
+
+// insert collider box, returns the leaf
+Inst bvh_insert(Inst collider, const AABB& box, bool dynamic);
+
+void bvh_remove(Inst leaf);
+
+// returns true when the box left the fat box and the leaf was reinserted
+bool bvh_move(Inst leaf, const AABB& box, Vec2 displacement);
+
+// sleeping leaves are treated like static ones, pairs of them are never tested
+void bvh_set_dynamic(Inst leaf, bool dynamic);
+
+/*
+    bulk build, replaces the whole tree
+*/
+
+enum BvhBuildMode : U32 {
+    BVH_BUILD_MEDIAN = 0, // spatial median of the longest axis
+    BVH_BUILD_SAH    = 1, // binned surface area heuristic over centroid bounds
+};
+
 U32 bvh_partition_ids(Inst* ids, U32 count, Axis axis, F32 split);
 
 Inst bvh_build_recursive(Inst* ids, U32 count);
 
-void bvh_build(Inst* colliders, U32 count);
+Inst bvh_build_sah(Inst* ids, U32 count);
+
+void bvh_build(Inst* colliders, U32 count, BvhBuildMode mode = CFG_BVH_BUILD_MODE);
+
+/*
+    tree quality, used to compare builders on the same scene
+*/
+
+struct BvhQuality {
+    F32 sah_cost;       // expected cost of a query, relative to the root perimeter
+    F32 overlap;        // area shared by sibling boxes, relative to the root area
+    F32 avg_leaf_depth;
+    U32 max_depth;
+    U32 leaf_count;
+    U32 node_count;
+};
 
-void bvh_render_node(U32 node_id);
+BvhQuality bvh_measure_quality();
 
-void bvh_render();
+void bvh_log_quality(const char* label);
+
+/*
+    local trees of compound colliders. the children of a compound stay out
+    of the global tree, it holds one leaf for the whole compound and the
+    pair traversal, queries and rays descend into the local tree. the
+    topology is built when children join or leave and only refit from the
+    children's boxes as the body moves
+*/
+
+Inst bvh_local_new();
+
+void bvh_local_free(Inst tree);
+
+// rebuilds the tree
+void bvh_local_add(Inst tree, Inst collider);
+
+void bvh_local_remove(Inst tree, Inst collider);
+
+const std::vector<Inst>& bvh_local_colliders(Inst tree);
+
+// refresh the node boxes from the colliders, false when the tree is empty
+bool bvh_local_refit(Inst tree, AABB& box);
+
+// colliders of the tree whose box overlaps box are appended to out
+void bvh_local_query_aabb(Inst tree, const AABB& box, std::vector<Inst>& out);
 
 void bvh_calculate_manifolds();
 
+// pairs handed to the narrowphase by the last bvh_calculate_manifolds
+U32 bvh_count_pairs_tested();
+
+// colliders whose leaf box overlaps box are appended to out, compounds add their children instead
+void bvh_query_aabb(const AABB& box, std::vector<Inst>& out);
+
 struct PsxRay;
 struct PsxRayResult;
 PsxRayResult bvh_cast_ray(
@@ -45,4 +126,11 @@ PsxRayResult bvh_cast_ray(
     bool search_layer = false
 );
 
+// per world state, owned by PsxWorld
+struct PsxBvhState;
+
+PsxBvhState* bvh_state_new();
+
+void bvh_state_free(PsxBvhState* state);
+
 #endif
\ No newline at end of file
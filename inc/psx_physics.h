@@ -0,0 +1,54 @@
+#ifndef _PSX_PHYSICS_H
+#define _PSX_PHYSICS_H
+
+#include "core.h"
+#include "psx_spacial.h"
+#include "psx_collider.h"
+#include "psx_manifold.h"
+#include "psx_partition.h"
+#include "psx_world.h"
+
+/*
+    one simulation step, the order the physics passes are run in
+*/
+void physics_step(F32 dt);
+
+// step world from any thread, the world bound to the thread is left as it was
+void physics_step(PsxWorld* world, F32 dt);
+
+/*
+    fixed timestep. physics_advance adds the frame time to the world's
+    accumulator and runs physics_step with the fixed dt while a whole step
+    fits, at most max substeps per call. time past that is dropped so a
+    long frame can't make the next one longer still. the part of a step
+    left in the accumulator is the alpha to render bodies between their
+    last two poses with, see spacial_get_interpolated_pos
+*/
+
+// returns the steps taken
+U32 physics_advance(F32 frame_dt);
+
+U32 physics_advance(PsxWorld* world, F32 frame_dt);
+
+void physics_set_fixed_dt(F32 dt);
+
+F32 physics_get_fixed_dt();
+
+void physics_set_max_substeps(U32 steps);
+
+// accumulated time over the fixed dt, in [0, 1)
+F32 physics_get_alpha();
+
+// run before every step physics_advance takes with the fixed dt, where input goes so it's applied per step
+typedef void (*PsxStepFn)(F32 dt, void* data);
+
+void physics_set_pre_step(PsxStepFn fn, void* data);
+
+// per world state, owned by PsxWorld
+struct PsxPhysicsState;
+
+PsxPhysicsState* physics_state_new();
+
+void physics_state_free(PsxPhysicsState* state);
+
+#endif
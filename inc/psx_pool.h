@@ -0,0 +1,126 @@
+#ifndef _PSX_POOL_H
+#define _PSX_POOL_H
+
+#include "core.h"
+#include "config.h"
+
+/*
+    growable object pool. storage comes in chunks of 1 << CHUNK_SHIFT
+    objects that are never moved, so references and handles stay valid
+    while the pool grows. every slot has a generation that is bumped when
+    it is freed, handles carry it so stale ones can be detected. the pool
+    holds no memory until the first alloc
+*/
+template <typename T, U32 CHUNK_SHIFT = CFG_POOL_CHUNK_SHIFT>
+struct PsxPool {
+    static constexpr U32 chunk_size = 1u << CHUNK_SHIFT;
+    static constexpr U32 chunk_mask = chunk_size - 1;
+
+    struct Chunk {
+        T items[chunk_size];
+        U8 generation[chunk_size];
+    };
+
+    Chunk** chunks = nullptr;
+    U32 chunk_count = 0;
+    U32 chunk_capacity = 0;
+
+    U32* free_slots = nullptr;
+    U32 free_top = 0;
+    U32 free_capacity = 0;
+
+    U32 count = 0; // slots handed out, live or free
+
+    // accepts a slot index or a handle, the generation is not checked
+    T& operator[](U32 slot) {
+        slot &= INST_INDEX_MASK;
+        return chunks[slot >> CHUNK_SHIFT]->items[slot & chunk_mask];
+    }
+
+    const T& operator[](U32 slot) const {
+        slot &= INST_INDEX_MASK;
+        return chunks[slot >> CHUNK_SHIFT]->items[slot & chunk_mask];
+    }
+
+    U32 generation(U32 slot) const {
+        slot &= INST_INDEX_MASK;
+        return chunks[slot >> CHUNK_SHIFT]->generation[slot & chunk_mask];
+    }
+
+    Inst handle(U32 slot) const {
+        return inst_make(slot & INST_INDEX_MASK, generation(slot));
+    }
+
+    // handle points at a slot handed out with the generation it has now
+    bool valid(Inst h) const {
+        if (h == NO_INSTANCE) return false;
+
+        U32 slot = inst_index(h);
+        return slot < count && generation(slot) == inst_generation(h);
+    }
+
+    // slot of a new object, a freed one if there is any
+    U32 alloc() {
+        if (free_top > 0) {
+            return free_slots[--free_top];
+        }
+
+        if (count > INST_MAX_INDEX) {
+            THROW("Pool: out of handles");
+        }
+
+        if ((count >> CHUNK_SHIFT) >= chunk_count) {
+            grow();
+        }
+
+        return count++;
+    }
+
+    void free(U32 slot) {
+        slot &= INST_INDEX_MASK;
+
+        U8& gen = chunks[slot >> CHUNK_SHIFT]->generation[slot & chunk_mask];
+        gen++;
+
+        if (free_top >= free_capacity) {
+            free_capacity = free_capacity ? free_capacity * 2 : chunk_size;
+            free_slots = (U32*) realloc(free_slots, free_capacity * sizeof(U32));
+
+            if (!free_slots) THROW("Pool: out of memory");
+        }
+
+        free_slots[free_top++] = slot;
+    }
+
+    void grow() {
+        if (chunk_count >= chunk_capacity) {
+            chunk_capacity = chunk_capacity ? chunk_capacity * 2 : 8;
+            chunks = (Chunk**) realloc(chunks, chunk_capacity * sizeof(Chunk*));
+
+            if (!chunks) THROW("Pool: out of memory");
+        }
+
+        chunks[chunk_count++] = new Chunk();
+    }
+
+    // hand every chunk back, handles and references into the pool die with it
+    void release() {
+        for (U32 i = 0; i < chunk_count; ++i) {
+            delete chunks[i];
+        }
+
+        ::free(chunks);
+        ::free(free_slots);
+        *this = {};
+    }
+
+    U32 capacity() const {
+        return chunk_count * chunk_size;
+    }
+
+    U64 bytes() const {
+        return (U64) chunk_count * sizeof(Chunk) + (U64) chunk_capacity * sizeof(Chunk*) + (U64) free_capacity * sizeof(U32);
+    }
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef _PSX_PROFILE_H
+#define _PSX_PROFILE_H
+
+#include "core.h"
+#include "config.h"
+#include <atomic>
+
+/*
+    scoped timings and counters for the physics passes. samples go into a
+    lock-free ring shared by every thread, counters are kept per thread so
+    workers never contend. compiled out entirely with CFG_PROFILE false,
+    otherwise off until profile_set_enabled(true) and then a relaxed load
+    per scope
+*/
+
+enum PsxProfileZone : U32 {
+    PROFILE_ZONE_STEP = 0,
+    PROFILE_ZONE_INTEGRATE_VEL,
+    PROFILE_ZONE_FILTER,
+    PROFILE_ZONE_BROADPHASE,
+    PROFILE_ZONE_NARROWPHASE,
+    PROFILE_ZONE_PAIR_TASK,     // one subtree pair on a worker
+    PROFILE_ZONE_ISLANDS,
+    PROFILE_ZONE_SOLVE,
+    PROFILE_ZONE_SOLVE_TASK,    // one batch of islands on a worker
+    PROFILE_ZONE_INTEGRATE_POS,
+    PROFILE_ZONE_CCD,
+    PROFILE_ZONE_RAYCAST,
+    PROFILE_ZONE_COUNT
+};
+
+enum PsxProfileCounter : U32 {
+    PROFILE_COUNTER_BVH_NODES_VISITED = 0,
+    PROFILE_COUNTER_BROADPHASE_PAIRS,    // leaf pairs with overlapping boxes
+    PROFILE_COUNTER_NARROWPHASE_PAIRS,   // pairs handed to manifold_collide
+    PROFILE_COUNTER_CONTACTS,            // pairs that touched
+    PROFILE_COUNTER_MANIFOLDS_CREATED,
+    PROFILE_COUNTER_BVH_MOVES,           // leaves reinserted by the refit
+    PROFILE_COUNTER_RAYS,
+    PROFILE_COUNTER_COUNT
+};
+
+struct PsxProfileSample {
+    U64 start_ns;
+    U64 duration_ns;
+    U32 zone;
+    U32 thread;
+    U32 frame;
+};
+
+struct PsxProfileStats {
+    U32 count;
+    U64 min_ns;
+    U64 avg_ns;
+    U64 p99_ns;
+    U64 max_ns;
+};
+
+const char* profile_zone_name(U32 zone);
+
+const char* profile_counter_name(U32 counter);
+
+extern std::atomic<bool> g_profile_enabled;
+
+// runtime toggle, safe to flip from any thread
+void profile_set_enabled(bool enabled);
+
+inline bool profile_enabled() {
+    return g_profile_enabled.load(std::memory_order_relaxed);
+}
+
+// forget every sample and counter
+void profile_reset();
+
+// advance the frame number samples are tagged with, physics_step calls it
+void profile_frame();
+
+U32 profile_get_frame();
+
+U64 profile_now_ns();
+
+void profile_record(U32 zone, U64 start_ns, U64 end_ns);
+
+void profile_count(U32 counter, U64 amount);
+
+// small dense id of the calling thread, assigned on first use
+U32 profile_thread_id();
+
+/*
+    readers, the ring only holds the last CFG_PROFILE_RING_SIZE samples
+*/
+
+// copy the samples still in the ring, oldest first, returns how many were written
+U32 profile_read_samples(PsxProfileSample* out, U32 capacity);
+
+PsxProfileStats profile_summarize(U32 zone);
+
+U64 profile_get_counter(U32 counter);
+
+U64 profile_get_thread_counter(U32 thread, U32 counter);
+
+U32 profile_count_threads();
+
+// zone table and counter totals to stdout
+void profile_log();
+
+/*
+    chrome trace export, load the file in chrome://tracing or ui.perfetto.dev.
+    every sample becomes a complete event on the track of its thread
+*/
+
+// samples of frames [first_frame, last_frame] still in the ring, false if the file can't be written
+bool profile_write_chrome_trace(const char* path, U32 first_frame = 0, U32 last_frame = UINT32_MAX);
+
+/*
+    profile the next frames for a trace at path, the enabled state is
+    restored after the last one. the step only closes the capture, the
+    file is written by profile_write_capture on the thread that polls it so
+    no step waits on file io. the ring has to hold every sample of the
+    capture until then
+*/
+void profile_capture_frames(U32 frames, const char* path);
+
+bool profile_capturing();
+
+// the captured frames are done and waiting for profile_write_capture
+bool profile_capture_ready();
+
+// write a ready capture on the calling thread, false when none is ready or the file can't be written
+bool profile_write_capture();
+
+/*
+    instrumentation
+*/
+
+struct PsxProfileScope {
+    U32 zone;
+    U64 start;
+
+    PsxProfileScope(U32 zone) : zone(zone), start(profile_enabled() ? profile_now_ns() : 0) {}
+
+    ~PsxProfileScope() {
+        if (start) profile_record(zone, start, profile_now_ns());
+    }
+};
+
+#if CFG_PROFILE
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(zone) PsxProfileScope PROFILE_CONCAT(_profile_scope_, __LINE__)(zone)
+#define PROFILE_COUNT(counter, amount) do { if (profile_enabled()) profile_count(counter, amount); } while (0)
+#define PROFILE_FRAME() profile_frame()
+#else
+#define PROFILE_SCOPE(zone) do { } while (0)
+#define PROFILE_COUNT(counter, amount) do { } while (0)
+#define PROFILE_FRAME() do { } while (0)
+#endif
+
+#endif
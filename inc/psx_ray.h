@@ -1,11 +1,11 @@
 #ifndef _PSX_RAY_H
 #define _PSX_RAY_H
 
-#include "main.h"
+#include "core.h"
 #include "vector.h"
 
 #include "psx_algo.h"
-#include "gl_express_shape.h"
+#include "glx_geometry.h"
 #include "psx_collider.h"
 
 struct PsxRay {
@@ -40,6 +40,16 @@ bool ray_check_poly(
     Vec2& normal_out
 );
 
+// a segment when radius is 0
+bool ray_check_capsule(
+    const PsxRay& ray,
+    const Vec2& a,
+    const Vec2& b,
+    F32 radius,
+    F32& dist_out,
+    Vec2& normal_out
+);
+
 bool ray_check_aabb(
     const PsxRay& ray,
     const AABB& box,
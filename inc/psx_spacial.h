@@ -1,7 +1,7 @@
 #ifndef _PSX_MOTION
 #define _PSX_MOTION
 
-#include "main.h"
+#include "core.h"
 #include "vector.h"
 #include "config.h"
 
@@ -10,6 +10,8 @@ enum PsxSpacialFlag : U32 {
     SPACIAL_FLAG_STATIC  = 1 << 0,
     SPACIAL_FLAG_RIGID   = 1 << 1,
     SPACIAL_FLAG_NO_GRAV = 1 << 2,
+    SPACIAL_FLAG_NO_SLEEP = 1 << 3,
+    SPACIAL_FLAG_BULLET  = 1 << 4, // swept between steps so it can't pass through thin colliders, see psx_ccd.h
 };
 
 struct PsxSpacialConfig {
@@ -31,34 +33,95 @@ struct PsxSpacialConfig {
     void* user_data = nullptr;
 };
 
-struct PsxSpacial {
-    void* user_data;
-
+/*
+    hot body state is stored as structure-of-arrays streams indexed by slot.
+    slots [0, awake_count) are packed with awake dynamic bodies so the
+    integrators only walk contiguous memory, static and freed bodies are
+    parked after them. the streams are reallocated as they grow, so
+    pointers into them only hold until the next spacial_new. writing ang
+    through a view leaves rot behind, turn spacials with spacial_rotate_to
+*/
+struct PsxSpacialStreams {
     // positional
-    Vec2 vel;
-    Vec2 force;
-    Vec2 pos;
-    Vec2 prev_pos;
+    Vec2* vel;
+    Vec2* force;
+    Vec2* pos;
+    Vec2* prev_pos;
 
     // angular
-    F32 ang_vel;
-    F32 torque;
-    F32 ang;
-    F32 prev_ang;
+    F32* ang_vel;
+    F32* torque;
+    F32* ang;
+    F32* prev_ang;
+    Vec2* rot; // cos and sin of ang, kept up to date by everything that turns a spacial
+
+    // properties
+    F32* inv_mass;
+    F32* inv_inertia;
+    U32* flags;
+    F32* sleep_time; // seconds spent below the sleep thresholds
+
+    Inst* owner; // spacial stored in each slot
+
+    U32 count;       // slots handed out
+    U32 awake_count; // packed awake dynamic bodies
+    U32 capacity;
+};
+
+// per spacial data the integrators never touch
+struct PsxSpacialInfo {
+    void* user_data;
 
     // properties
     F32 mass;
-    F32 inv_mass;
     F32 inertia;
-    F32 inv_inertia;
 
     // data
-    U32 flags;
     U32 index;
+    U32 slot;  // location in the streams
     U32 layer; // collision layer
     U32 group; // category bit (player, enemy, world, etc)
 
+    Inst collider; // first attached collider, the rest are linked through PsxCollider::next
+    U32 island;    // sleeping island, NO_INSTANCE while awake
+
     bool in_use;
+    bool awake;
+};
+
+/*
+    view of a single spacial, members reference the streams so s.pos style
+    access keeps working. a view is invalidated when its spacial changes slot
+    (spacial_new/spacial_free, falling asleep or waking up) so don't hold on to it
+*/
+struct PsxSpacial {
+    void*& user_data;
+
+    // positional
+    Vec2& vel;
+    Vec2& force;
+    Vec2& pos;
+    Vec2& prev_pos;
+
+    // angular
+    F32& ang_vel;
+    F32& torque;
+    F32& ang;
+    F32& prev_ang;
+
+    // properties
+    F32& mass;
+    F32& inv_mass;
+    F32& inertia;
+    F32& inv_inertia;
+
+    // data
+    U32& flags;
+    U32& index;
+    U32& layer;
+    U32& group;
+
+    bool& in_use;
 };
 
 // void spacial_update(F32 dt);
@@ -66,23 +129,43 @@ struct PsxSpacial {
 void spacial_integrate_velocities(F32 dt);
 void spacial_integrate_positions(F32 dt);
 
-PsxSpacial& spacial_get(Inst spacial);
+PsxSpacial spacial_get(Inst spacial);
+
+// false for NO_INSTANCE and handles of freed spacials
+bool spacial_valid(Inst spacial);
+
+// current handle of a pool slot, for walking every slot up to count_spacial_slots
+Inst spacial_handle(U32 slot);
+
+PsxSpacial spacial_alloc();
+
+PsxSpacialStreams& spacial_streams();
+
+PsxSpacialInfo& spacial_get_info(Inst spacial);
+
+// dynamic spacial in a sleeping island
+bool spacial_is_sleeping(Inst spacial);
 
-PsxSpacial& spacial_alloc();
+// park a dynamic spacial in island with its velocities cleared, NO_INSTANCE moves it back into the awake range
+void spacial_set_sleeping(Inst spacial, U32 island);
 
 void spacial_free(Inst spacial);
 
 Inst spacial_new(PsxSpacialConfig cfg);
 
+// moving, pushing or accelerating a sleeping spacial wakes its island. moves and rotations are
+// teleports, prev_pos/prev_ang are set too so they are not interpolated
 void spacial_move_to(Inst spacial, Vec2 pos);
-void spacial_move_to(PsxSpacial& spacial, Vec2 pos);
+void spacial_move_to(PsxSpacial spacial, Vec2 pos);
+
+void spacial_rotate_to(Inst spacial, F32 ang);
 
 void spacial_add_force(Inst spacial, Vec2 impulse);
-void spacial_accellarate(PsxSpacial& spacial, Vec2 impulse);
+void spacial_accellarate(PsxSpacial spacial, Vec2 impulse);
 
 void spacial_impulse(Inst spacial, Vec2 impulse);
-void spacial_impulse(PsxSpacial& spacial, Vec2 impulse);
-void spacial_impulse(PsxSpacial& s, Vec2 impulse, Vec2 contact_point_world);
+void spacial_impulse(PsxSpacial spacial, Vec2 impulse);
+void spacial_impulse(PsxSpacial s, Vec2 impulse, Vec2 contact_point_world);
 
 /*
     getters
@@ -97,6 +180,29 @@ Vec2 spacial_get_acc(Inst spacial);
 
 F32 spacial_get_ang(Inst spacial);
 
-void spacial_render();
+// pose between the last two steps, alpha 0 is prev_pos/prev_ang and 1 is pos/ang, see physics_get_alpha
+Vec2 spacial_get_interpolated_pos(Inst spacial, F32 alpha);
+
+F32 spacial_get_interpolated_ang(Inst spacial, F32 alpha);
+
+U32 count_awake_spacials();
+
+// slots handed out so far, live or free
+U32 count_spacial_slots();
+
+// pool and stream memory
+U64 spacial_memory_bytes();
+
+// gravity of the current world
+void spacial_set_gravity(F32 gravity);
+
+F32 spacial_get_gravity();
+
+// per world state, owned by PsxWorld
+struct PsxSpacialState;
+
+PsxSpacialState* spacial_state_new();
+
+void spacial_state_free(PsxSpacialState* state);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef _PSX_WORLD_H
+#define _PSX_WORLD_H
+
+#include "core.h"
+
+/*
+    a world owns the spacial, collider, manifold and material pools, the
+    vertex arena, the BVH, the islands and the step accumulator of one
+    simulation. the free functions work on the world bound to the calling
+    thread, or the default world when none is, so independent worlds can be
+    stepped on separate threads without sharing anything. job workers run
+    on the world of the batch they were given. the job pool and the
+    profiler are shared by every world. the pool starts on first use and
+    that is safe from any world's thread, concurrent first steps start it
+    once
+*/
+
+struct PsxSpacialState;
+struct PsxColliderState;
+struct PsxArenaState;
+struct PsxManifoldState;
+struct PsxMaterialState;
+struct PsxBvhState;
+struct PsxIslandState;
+struct PsxPhysicsState;
+
+struct PsxWorld {
+    PsxSpacialState* spacial;
+    PsxColliderState* collider;
+    PsxArenaState* arena;
+    PsxManifoldState* manifold;
+    PsxMaterialState* material;
+    PsxBvhState* bvh;
+    PsxIslandState* island;
+    PsxPhysicsState* physics;
+};
+
+PsxWorld* world_new();
+
+// the world can't be bound to any thread when it's freed
+void world_free(PsxWorld* world);
+
+// bind world to the calling thread, nullptr goes back to the default world. returns the world bound before
+PsxWorld* world_bind(PsxWorld* world);
+
+// world the calling thread works on
+PsxWorld* world_current();
+
+// world used by threads that never bound one, created on first use
+PsxWorld* world_default();
+
+// binds a world for the lifetime of the scope
+struct PsxWorldScope {
+    PsxWorld* previous;
+
+    PsxWorldScope(PsxWorld* world) : previous(world_bind(world)) {}
+
+    ~PsxWorldScope() {
+        world_bind(previous);
+    }
+};
+
+#endif
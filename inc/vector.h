@@ -1,7 +1,7 @@
 #ifndef _VECTOR_H
 #define _VECTOR_H
 
-#include "main.h"
+#include "core.h"
 
 union Vec2 {
     struct { F32 x, y; };
@@ -78,6 +78,13 @@ inline Vec2 vec2_rotate(const Vec2& v, F32 s, F32 c) {
     return {v.x * c - v.y * s, v.x * s + v.y * c};
 }
 
+// cos and sin of a, rotate with vec2_rotate_by
+inline Vec2 vec2_rotation(F32 a) { return { cosf(a), sinf(a) }; }
+
+inline Vec2 vec2_rotate_by(const Vec2& v, const Vec2& rot) {
+    return { v.x * rot.x - v.y * rot.y, v.x * rot.y + v.y * rot.x };
+}
+
 inline Vec2 vec2_rotate(const Vec2& v, F32 a) {
     F32 s = sinf(a), c = cosf(a);
     return { v.x * c - v.y * s, v.x * s + v.y * c };
@@ -1,32 +1,5 @@
 #include "gl_express_shape.h"
 
-bool glx_aabb_check(const GlxBoundingBox& a, const GlxBoundingBox& b) {
-    if (a.max.x < b.min.x) return false;
-    if (a.min.x > b.max.x) return false;
-    if (a.max.y < b.min.y) return false;
-    if (a.min.y > b.max.y) return false;
-    return true;
-}
-
-AABB glx_aabb_merge(const AABB& a, const AABB& b) {
-    AABB out;
-    out.min.x = fminf(a.min.x, b.min.x);
-    out.min.y = fminf(a.min.y, b.min.y);
-    out.max.x = fmaxf(a.max.x, b.max.x);
-    out.max.y = fmaxf(a.max.y, b.max.y);
-    return out;
-}
-
-Vec2 glx_aabb_center(const AABB& bb) {
-    return (bb.min + bb.max) * 0.5f;
-}
-
-F32 glx_aabb_perimeter(const AABB& a) {
-    F32 wx = a.max.x - a.min.x;
-    F32 wy = a.max.y - a.min.y;
-    return 2.0f * (wx + wy);
-}
-
 Status glx_shape_2d(GLX& glx, const F32* xy, S32 count) {
     if (count < 2) return ERROR;
     S32 bytes = count * 2 * sizeof(F32);
@@ -148,44 +121,3 @@ Status glx_circle_2d(GLX& glx, F32 x, F32 y, F32 r, S32 lod) {
     return ret;
 }
 
-void glx_transform_poly_2d(
-    Vec2 pos, 
-    Vec2* out, 
-    const Vec2* identity, 
-    U32 count, 
-    F32 scale, 
-    F32 angle, 
-    GlxBoundingBox* bounding_box,
-    Vec2* center
-) {
-    F32 s = 0.f;
-    F32 c = 0.f;
-    if (angle != 0.f) {
-        s = sinf(angle);
-        c = cosf(angle);
-    }
-
-    bool set_center = center != nullptr;
-    bool set_bounding_box = bounding_box != nullptr;
-
-    if (set_center) *center = {0, 0};
-
-    for (U32 i = 0; i < count; ++i) {
-        if (angle == 0.f) {
-            out[i] = (identity[i] * scale) + pos;
-        } else {
-            out[i] = vec2_rotate((identity[i] * scale) + pos, pos, s, c);
-        }
-
-        if (set_bounding_box) {
-            if (out[i].x < bounding_box->min.x) bounding_box->min.x = out[i].x;
-            if (out[i].y < bounding_box->min.y) bounding_box->min.y = out[i].y;
-            if (out[i].x > bounding_box->max.x) bounding_box->max.x = out[i].x;
-            if (out[i].y > bounding_box->max.y) bounding_box->max.y = out[i].y;
-        }
-
-        if (set_center) *center += out[i];
-    }
-
-    if (set_center) *center /= (F32) count; 
-}
\ No newline at end of file
@@ -4,16 +4,37 @@
 #include "glx_shape.h"
 #include "psx_collider.h"
 #include "psx_manifold.h"
+#include "psx_physics.h"
+#include "psx_debug_draw.h"
+
+static PsxRay ground_ray(Inst player) {
+    return {
+        .origin = spacial_get_pos(player),
+        .dir = vec2_normal({0, 1}),
+        .max_dist = 30.f,
+        .group = 1
+    };
+}
+
+// input is applied once per fixed step, forces are cleared after every step
+static void player_input(F32 dt, void* data) {
+    Inst player = *(Inst*) data;
+
+    const U8* kb_state = SDL_GetKeyboardState(NULL);
+    constexpr float speed = 500.f;
 
-void physics_step(F32 dt) {
+    Vec2 impulse = { 0 };
+    if (kb_state[SDL_SCANCODE_W]) { impulse.y -= 1.f; }
+    if (kb_state[SDL_SCANCODE_S]) { impulse.y += 1.f; }
+    if (kb_state[SDL_SCANCODE_A]) { impulse.x -= 1.f; }
+    if (kb_state[SDL_SCANCODE_D]) { impulse.x += 1.f; }
 
-    spacial_integrate_velocities(dt);
-    spacial_integrate_positions(dt);
-    collider_filter_updated();
-    collider_build_bvh();
-    bvh_calculate_manifolds();
-    manifolds_solve(dt);
+    impulse = vec2_normal(impulse);
+    impulse *= speed;
 
+    spacial_add_force(player, impulse);
+
+    if (kb_state[SDL_SCANCODE_SPACE] && ray_cast(ground_ray(player)).touched) { spacial_impulse(player, {0, -20000 * dt}); }
 }
 
 int main() {
@@ -50,26 +71,29 @@ int main() {
         .restitution = 1.f,
     });
 
+    // one broadphase leaf for every wall
+    Inst walls = collider_new_compound({ .spacial = world_spacial });
+
     collider_new_rect({1000, 100}, 
         { 
-            .spacial = world_spacial,
             .material = world_material,
+            .compound = walls,
         }
     );
 
     collider_new_rect({100, 1000}, 
         { 
-            .spacial = world_spacial, 
             .material = world_material,
             .offset = { 500, -500},
+            .compound = walls,
         }
     );
 
     collider_new_rect({100, 1000}, 
         { 
-            .spacial = world_spacial, 
             .material = world_material,
             .offset = {-500, -500},
+            .compound = walls,
         }
     );
 
@@ -81,6 +105,8 @@ int main() {
     
     Inst rect = collider_new_rect({50, 50}, { .spacial = loc});
 
+    physics_set_pre_step(player_input, &player);
+
     // hook to SDL events
     glapp_bind_sdl_events(app, [&](SDL_Event e) {
         if (e.type == SDL_MOUSEWHEEL) {
@@ -113,33 +139,17 @@ int main() {
         */
         view_update(dt);
         shape_draw_lines();
-        physics_step(dt);
+
+        // fixed steps, whatever the frame rate
+        physics_advance(dt);
+        F32 alpha = physics_get_alpha();
 
         int mou_x, mou_y;
-        const U8* kb_state = SDL_GetKeyboardState(NULL);
         const U32 mou_state = SDL_GetMouseState(&mou_x, &mou_y);
-        constexpr float speed = 500.f;
-
-        Vec2 impulse = { 0 };
-        if (kb_state[SDL_SCANCODE_W]) { impulse.y -= 1.f; }
-        if (kb_state[SDL_SCANCODE_S]) { impulse.y += 1.f; }
-        if (kb_state[SDL_SCANCODE_A]) { impulse.x -= 1.f; }
-        if (kb_state[SDL_SCANCODE_D]) { impulse.x += 1.f; }
-
-        impulse = vec2_normal(impulse);
-        impulse *= speed;
 
-        spacial_add_force(player, impulse);
-
-        view_move_camera(spacial_get_pos(player));
-
-        PsxRay ray = {
-            .origin = spacial_get_pos(player),
-            .dir = vec2_normal({0, 1}),
-            .max_dist = 30.f,
-            .group = 1
-        };
+        view_move_camera(spacial_get_interpolated_pos(player, alpha));
 
+        PsxRay ray = ground_ray(player);
         F32 dist = ray.max_dist;
 
         PsxRayResult hit = ray_cast(ray);
@@ -147,15 +157,13 @@ int main() {
             dist = hit.dist;
         }
 
-        if (kb_state[SDL_SCANCODE_SPACE] && hit.touched) { spacial_impulse(player, {0, -20000 * dt}); }
-
         /*
             render pass
         */
         view_start();
         shape_line(ray.origin, ray.origin + ray.dir * dist);
 
-        collider_draw_all();
+        collider_draw_all(alpha);
         bvh_render();
         manifolds_render();
         spacial_render();
@@ -16,22 +16,29 @@ bool algo_overlap_1d(F32 min1, F32 max1, F32 min2, F32 max2) {
     return !(max1 < min2 || max2 < min1);
 }
 
+bool algo_axis_separates(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    const Vec2& axis
+) {
+    F32 min_a, max_a, min_b, max_b;
+
+    algo_project_1d(poly_a, poly_a_count, axis, min_a, max_a);
+    algo_project_1d(poly_b, poly_b_count, axis, min_b, max_b);
+
+    return !algo_overlap_1d(min_a, max_a, min_b, max_b);
+}
+
 bool algo_separate_axis(
-    const Vec2* poly_a, U32 poly_a_count, 
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count, 
     const Vec2* poly_b, U32 poly_b_count, 
     Vec2& best_axis, 
-    F32& best_depth
+    F32& best_depth,
+    U32& edge
 ) {
     for (U32 i = 0; i < poly_a_count; ++i) {
-        U32 j = (i + 1) % poly_a_count;
-
-        Vec2 edge = poly_a[j] - poly_a[i];
-        Vec2 axis = vec2_perp(edge);
-
-        F32 len_sq = vec2_length_sq(axis);
-        if (len_sq == 0.f) continue;
-
-        axis = vec2_normal(axis, sqrtf(len_sq));
+        const Vec2 axis = normals_a[i];
+        if (axis.x == 0.f && axis.y == 0.f) continue;
 
         F32 min_a, max_a, min_b, max_b;
 
@@ -39,6 +46,7 @@ bool algo_separate_axis(
         algo_project_1d(poly_b, poly_b_count, axis, min_b, max_b);
 
         if (!algo_overlap_1d(min_a, max_a, min_b, max_b)) {
+            edge = i;
             return false;
         }
 
@@ -53,121 +61,538 @@ bool algo_separate_axis(
     return true; // all axes overlapped
 }
 
-U32 algo_find_segment(
-    const Vec2* poly,
-    const U32 count,
-    const Vec2& n,
-    Vec2* out
-) {
-    constexpr U32 axis_size = 2;
+F32 algo_poly_winding(const Vec2* poly, U32 count) {
+    F32 area = 0.f;
 
-    F32 best_proj = -FLT_MAX;
-    Vec2 a{}, b{};
+    for (U32 i = 0; i < count; ++i) {
+        area += vec2_cross(poly[i], poly[(i + 1) % count]);
+    }
+
+    return area < 0.f ? -1.f : 1.f;
+}
+
+Vec2 algo_edge_normal(const Vec2* poly, U32 count, U32 edge, F32 winding) {
+    Vec2 e = poly[(edge + 1) % count] - poly[edge];
+    return vec2_normal({ e.y * winding, -e.x * winding });
+}
+
+// edge whose outward normal is closest to dir
+static U32 algo_best_edge(const Vec2* normals, U32 count, const Vec2& dir, F32& best_dot) {
+    U32 best = 0;
+    best_dot = -FLT_MAX;
 
     for (U32 i = 0; i < count; ++i) {
-        U32 j = (i + 1) % count;
+        F32 d = vec2_dot(normals[i], dir);
+        if (d > best_dot) {
+            best_dot = d;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+U32 algo_clip_segment(
+    const Vec2* in, const U32* in_ids,
+    Vec2* out, U32* out_ids,
+    const Vec2& n, F32 offset, U32 clip_id
+) {
+    U32 count = 0;
+
+    F32 d0 = vec2_dot(n, in[0]) - offset;
+    F32 d1 = vec2_dot(n, in[1]) - offset;
+
+    // points behind the plane are kept
+    if (d0 <= 0.f) { out[count] = in[0]; out_ids[count++] = in_ids[0]; }
+    if (d1 <= 0.f) { out[count] = in[1]; out_ids[count++] = in_ids[1]; }
+
+    // points on opposite sides, add the crossing
+    if (d0 * d1 < 0.f) {
+        F32 t = d0 / (d0 - d1);
+        out[count] = in[0] + (in[1] - in[0]) * t;
+        out_ids[count++] = clip_id;
+    }
 
-        Vec2 p1 = poly[i], p2 = poly[j];
-        Vec2 mid = (p1 + p2) * 0.5f;
-        F32 proj = vec2_dot(mid, n);
+    return count;
+}
 
-        if (proj > best_proj) {
-            best_proj = proj;
-            a = p1, b = p2;
+U32 algo_clip_contacts(
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count,
+    const Vec2* poly_b, const Vec2* normals_b, U32 poly_b_count,
+    Vec2& normal,
+    Vec2* points, F32* depths, U32* ids,
+    F32 radius_b
+) {
+    // faces of each polygon best aligned with the collision normal
+    F32 align_a, align_b;
+    U32 edge_a = algo_best_edge(normals_a, poly_a_count,  normal, align_a);
+    U32 edge_b = algo_best_edge(normals_b, poly_b_count, -normal, align_b);
+
+    // reference face is the better aligned one, a wins near ties so the choice does not flicker
+    bool flip = align_b > align_a * 0.98f + 0.001f;
+
+    const Vec2* ref_poly    = flip ? poly_b        : poly_a;
+    U32         ref_count   = flip ? poly_b_count  : poly_a_count;
+    U32         ref_edge    = flip ? edge_b        : edge_a;
+    const Vec2* ref_normals = flip ? normals_b     : normals_a;
+    const Vec2* inc_poly    = flip ? poly_a        : poly_b;
+    U32         inc_count   = flip ? poly_a_count  : poly_b_count;
+    const Vec2* inc_normals = flip ? normals_a     : normals_b;
+
+    Vec2 ref_normal = ref_normals[ref_edge];
+
+    // incident edge faces against the reference face
+    F32 inc_dot;
+    U32 inc_edge = algo_best_edge(inc_normals, inc_count, -ref_normal, inc_dot);
+    U32 inc_next = (inc_edge + 1) % inc_count;
+
+    // feature ids: reference edge, incident vertex or clipping vertex, flip
+    U32 base = (ref_edge << 16) | ((U32) flip << 24);
+    Vec2 inc[2] = { inc_poly[inc_edge], inc_poly[inc_next] };
+    U32 inc_ids[2] = { base | inc_edge, base | inc_next };
+
+    U32 ref_i = ref_edge;
+    U32 ref_j = (ref_edge + 1) % ref_count;
+    Vec2 v1 = ref_poly[ref_i];
+    Vec2 v2 = ref_poly[ref_j];
+
+    Vec2 tangent = vec2_normal(v2 - v1);
+
+    // clip the incident edge to the side planes of the reference face
+    Vec2 clip1[2], clip2[2];
+    U32 clip1_ids[2], clip2_ids[2];
+
+    if (algo_clip_segment(inc, inc_ids, clip1, clip1_ids, -tangent, -vec2_dot(tangent, v1), base | 0x100 | ref_i) < 2) return 0;
+    if (algo_clip_segment(clip1, clip1_ids, clip2, clip2_ids, tangent, vec2_dot(tangent, v2), base | 0x100 | ref_j) < 2) return 0;
+
+    // a rounded b pushes the reference face out when it is the reference, its incident points in otherwise
+    F32 front = vec2_dot(ref_normal, v1) + (flip ? radius_b : 0.f);
+    Vec2 sink = flip ? Vec2{ 0, 0 } : ref_normal * radius_b;
+    U32 count = 0;
+
+    // keep what is behind the reference face
+    for (U32 i = 0; i < 2; ++i) {
+        Vec2 p = clip2[i] - sink;
+        F32 separation = vec2_dot(ref_normal, p) - front;
+
+        if (separation <= 0.f) {
+            points[count] = p;
+            depths[count] = -separation;
+            ids[count] = clip2_ids[i];
+            count++;
         }
     }
 
-    out[0] = a, out[1] = b;
-    return axis_size; // always returns 2 vertices
+    // normal always points from a to b
+    normal = flip ? -ref_normal : ref_normal;
+
+    return count;
 }
 
-// breaks on large planes
-bool algo_plane_contains_point(const Vec2* plane, const Vec2& point) {
-    constexpr F32 eps = 0.25f;  // max deveviation from plane
-    constexpr F32 eps_sq = eps * eps;
+U32 algo_support(const Vec2* poly, U32 count, const Vec2& dir, U32 start) {
+    U32 best = start < count ? start : 0;
+    F32 best_d = vec2_dot(poly[best], dir);
+
+    // convex, the projection only rises towards the support vertex so pick a side and walk
+    U32 next = best + 1 == count ? 0 : best + 1;
+    U32 prev = best == 0 ? count - 1 : best - 1;
+    F32 next_d = vec2_dot(poly[next], dir);
+    F32 prev_d = vec2_dot(poly[prev], dir);
+
+    U32 step;
+    if (next_d > best_d && next_d >= prev_d) {
+        step = 1;
+        best = next;
+        best_d = next_d;
+    } else if (prev_d > best_d) {
+        step = count - 1;
+        best = prev;
+        best_d = prev_d;
+    } else {
+        return best;
+    }
+
+    for (U32 i = 2; i < count; ++i) {
+        U32 k = (best + step) % count;
+        F32 d = vec2_dot(poly[k], dir);
+        if (d <= best_d) break;
+
+        best = k;
+        best_d = d;
+    }
+
+    return best;
+}
+
+static void algo_simplex_vertex(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    const Vec2& dir, U32 start_a, U32 start_b,
+    PsxSimplexVertex& v
+) {
+    v.ia = algo_support(poly_a, poly_a_count, dir, start_a);
+    v.ib = algo_support(poly_b, poly_b_count, -dir, start_b);
+    v.w = poly_a[v.ia] - poly_b[v.ib];
+}
+
+// reduce a segment to the feature closest to the origin
+static void algo_simplex_solve2(PsxSimplex& s) {
+    Vec2 w1 = s.v[0].w;
+    Vec2 w2 = s.v[1].w;
+    Vec2 e12 = w2 - w1;
+
+    F32 d12_2 = -vec2_dot(w1, e12);
+    if (d12_2 <= 0.f) {
+        s.bary[0] = 1.f;
+        s.count = 1;
+        return;
+    }
+
+    F32 d12_1 = vec2_dot(w2, e12);
+    if (d12_1 <= 0.f) {
+        s.v[0] = s.v[1];
+        s.bary[0] = 1.f;
+        s.count = 1;
+        return;
+    }
+
+    F32 inv = 1.f / (d12_1 + d12_2);
+    s.bary[0] = d12_1 * inv;
+    s.bary[1] = d12_2 * inv;
+    s.count = 2;
+}
+
+// reduce a triangle to the feature closest to the origin, the whole triangle when it holds the origin
+static void algo_simplex_solve3(PsxSimplex& s) {
+    Vec2 w1 = s.v[0].w;
+    Vec2 w2 = s.v[1].w;
+    Vec2 w3 = s.v[2].w;
+
+    // barycentric coordinates of the edges
+    Vec2 e12 = w2 - w1;
+    F32 d12_1 = vec2_dot(w2, e12);
+    F32 d12_2 = -vec2_dot(w1, e12);
+
+    Vec2 e13 = w3 - w1;
+    F32 d13_1 = vec2_dot(w3, e13);
+    F32 d13_2 = -vec2_dot(w1, e13);
+
+    Vec2 e23 = w3 - w2;
+    F32 d23_1 = vec2_dot(w3, e23);
+    F32 d23_2 = -vec2_dot(w2, e23);
+
+    // and of the triangle
+    F32 n123 = vec2_cross(e12, e13);
+    F32 d123_1 = n123 * vec2_cross(w2, w3);
+    F32 d123_2 = n123 * vec2_cross(w3, w1);
+    F32 d123_3 = n123 * vec2_cross(w1, w2);
+
+    // vertex regions
+    if (d12_2 <= 0.f && d13_2 <= 0.f) {
+        s.bary[0] = 1.f;
+        s.count = 1;
+        return;
+    }
+
+    // edge regions
+    if (d12_1 > 0.f && d12_2 > 0.f && d123_3 <= 0.f) {
+        F32 inv = 1.f / (d12_1 + d12_2);
+        s.bary[0] = d12_1 * inv;
+        s.bary[1] = d12_2 * inv;
+        s.count = 2;
+        return;
+    }
+
+    if (d13_1 > 0.f && d13_2 > 0.f && d123_2 <= 0.f) {
+        F32 inv = 1.f / (d13_1 + d13_2);
+        s.bary[0] = d13_1 * inv;
+        s.bary[1] = d13_2 * inv;
+        s.v[1] = s.v[2];
+        s.count = 2;
+        return;
+    }
+
+    if (d12_1 <= 0.f && d23_2 <= 0.f) {
+        s.v[0] = s.v[1];
+        s.bary[0] = 1.f;
+        s.count = 1;
+        return;
+    }
+
+    if (d13_1 <= 0.f && d23_1 <= 0.f) {
+        s.v[0] = s.v[2];
+        s.bary[0] = 1.f;
+        s.count = 1;
+        return;
+    }
+
+    if (d23_1 > 0.f && d23_2 > 0.f && d123_1 <= 0.f) {
+        F32 inv = 1.f / (d23_1 + d23_2);
+        s.v[0] = s.v[2];
+        s.bary[0] = d23_2 * inv;
+        s.bary[1] = d23_1 * inv;
+        s.count = 2;
+        return;
+    }
+
+    // inside
+    F32 inv = 1.f / (d123_1 + d123_2 + d123_3);
+    s.bary[0] = d123_1 * inv;
+    s.bary[1] = d123_2 * inv;
+    s.bary[2] = d123_3 * inv;
+    s.count = 3;
+}
+
+// direction from the simplex towards the origin
+static Vec2 algo_simplex_search_dir(const PsxSimplex& s) {
+    if (s.count == 1) return -s.v[0].w;
+
+    Vec2 e12 = s.v[1].w - s.v[0].w;
+
+    // the side of the segment the origin is on
+    if (vec2_cross(e12, -s.v[0].w) > 0.f) {
+        return { -e12.y, e12.x };
+    }
+
+    return { e12.y, -e12.x };
+}
+
+bool algo_gjk(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    PsxSimplex& simplex
+) {
+    U32 seed_a = simplex.count == 1 && simplex.v[0].ia < poly_a_count ? simplex.v[0].ia : 0;
+    U32 seed_b = simplex.count == 1 && simplex.v[0].ib < poly_b_count ? simplex.v[0].ib : 0;
+
+    // start from a support point, epa needs every simplex point on the boundary of the minkowski difference
+    Vec2 dir = poly_a[seed_a] - poly_b[seed_b];
+    if (dir.x == 0.f && dir.y == 0.f) dir = { 1.f, 0.f };
+
+    algo_simplex_vertex(poly_a, poly_a_count, poly_b, poly_b_count, dir, seed_a, seed_b, simplex.v[0]);
+    simplex.bary[0] = 1.f;
+    simplex.count = 1;
+
+    for (U32 iter = 0; iter < CFG_GJK_ITERATIONS; ++iter) {
+        // support pairs already in the simplex, seeing one again means there is no progress left
+        U32 old_count = simplex.count;
+        U32 old_ia[3], old_ib[3];
+        for (U32 i = 0; i < old_count; ++i) {
+            old_ia[i] = simplex.v[i].ia;
+            old_ib[i] = simplex.v[i].ib;
+        }
+
+        if (simplex.count == 2) algo_simplex_solve2(simplex);
+        if (simplex.count == 3) algo_simplex_solve3(simplex);
 
-    const Vec2 a = plane[0], b = plane[1];
-    const Vec2 ab = {     b.x - a.x,     b.y - a.y };
-    const Vec2 ap = { point.x - a.x, point.y - a.y };
+        if (simplex.count == 3) return true;
 
-    F32 len_sq = vec2_length_sq(ab), dist_sq{};
-    if (len_sq == 0.0f) return vec2_length_sq(ap) < eps_sq;
+        dir = algo_simplex_search_dir(simplex);
 
-    F32 cross = vec2_cross(ab, ap);
-    return (cross * cross) / len_sq < eps_sq;
+        // the origin is on the simplex, touching
+        if (vec2_length_sq(dir) < FLT_EPSILON * FLT_EPSILON) return true;
+
+        const PsxSimplexVertex& last = simplex.v[simplex.count - 1];
+        PsxSimplexVertex& v = simplex.v[simplex.count];
+        algo_simplex_vertex(poly_a, poly_a_count, poly_b, poly_b_count, dir, last.ia, last.ib, v);
+
+        bool duplicate = false;
+        for (U32 i = 0; i < old_count; ++i) {
+            if (v.ia == old_ia[i] && v.ib == old_ib[i]) {
+                duplicate = true;
+                break;
+            }
+        }
+
+        if (duplicate) break;
+
+        simplex.count++;
+    }
+
+    // keep the closest feature's first support pair as the seed of the next query
+    simplex.count = 1;
+    return false;
 }
 
-// returns number of contact point (1 or 2)
-// moves contact points to out
-Vec2 algo_get_contact_point(
-    const Vec2* poly_a, U32 poly_a_count, 
+// overlap of a and b along axis pointing from a to b, the support climbs start at the given vertices
+static F32 algo_axis_penetration(
+    const Vec2* poly_a, U32 poly_a_count,
     const Vec2* poly_b, U32 poly_b_count,
-    const Vec2& normal
+    const Vec2& axis, U32 start_a, U32 start_b
+) {
+    PsxSimplexVertex v;
+    algo_simplex_vertex(poly_a, poly_a_count, poly_b, poly_b_count, axis, start_a, start_b, v);
+    return vec2_dot(v.w, axis);
+}
+
+bool algo_epa(
+    const Vec2* poly_a, const Vec2* normals_a, U32 poly_a_count,
+    const Vec2* poly_b, const Vec2* normals_b, U32 poly_b_count,
+    const PsxSimplex& simplex,
+    Vec2& normal,
+    F32& depth
 ) {
-    
+    if (simplex.count < 3) return false;
+
+    // polytope around the origin, counter clockwise
+    PsxSimplexVertex poly[CFG_EPA_ITERATIONS + 3];
+    U32 count = 3;
+
+    for (U32 i = 0; i < 3; ++i) poly[i] = simplex.v[i];
+    if (vec2_cross(poly[1].w - poly[0].w, poly[2].w - poly[0].w) < 0.f) vswap(poly[1], poly[2]);
+
+    U32 start_a = simplex.v[0].ia;
+    U32 start_b = simplex.v[0].ib;
+    U32 best = 0;
+
+    while (true) {
+        // edge closest to the origin
+        F32 best_d = FLT_MAX;
+        Vec2 best_n = { 0, 0 };
+
+        for (U32 i = 0; i < count; ++i) {
+            Vec2 e = poly[i + 1 == count ? 0 : i + 1].w - poly[i].w;
+
+            F32 len = vec2_length(e);
+            if (len == 0.f) continue;
+
+            Vec2 n = { e.y / len, -e.x / len };
+            F32 d = vec2_dot(n, poly[i].w);
+
+            if (d < best_d) {
+                best = i;
+                best_d = d;
+                best_n = n;
+            }
+        }
+
+        normal = best_n;
+        depth = best_d;
+
+        // the edge is on the boundary of the minkowski difference
+        PsxSimplexVertex v;
+        algo_simplex_vertex(poly_a, poly_a_count, poly_b, poly_b_count, best_n, start_a, start_b, v);
+        start_a = v.ia;
+        start_b = v.ib;
+
+        if (vec2_dot(v.w, best_n) - best_d <= CFG_EPA_TOLERANCE || count == CFG_EPA_ITERATIONS + 3) {
+            break;
+        }
+
+        // split the edge at the new point
+        for (U32 i = count; i > best + 1; --i) poly[i] = poly[i - 1];
+        poly[best + 1] = v;
+        count++;
+    }
+
     /*
-        a plane consists of at least 1 axis, and addition vertices
-        along another axis that fall along the primary axis
-        
-        plane[0] & plane[1] are initially defined as the planes axis
-        plane[2] & plane[3] are potentially extended points along that axis
+        within tolerance the edge can still cut a corner of the minkowski
+        difference, its normal then is no face normal and clipping finds no
+        reference face. every face of the difference is an edge of a or b at
+        the support vertices, the one that overlaps least is the real normal
     */
-    static constexpr U32 mpv = 4; // a plane will always consist of at most 4 vertices
-    static constexpr U32 acn = 2; // an axis will always contain exactly 2 points
-   
-    
-    // identify possible collision planes/axis
-    Vec2 pa[mpv]{}, pb[mpv]{};
-    U32 pa_cnt = algo_find_segment(poly_a, poly_a_count,  normal, pa);
-    U32 pb_cnt = algo_find_segment(poly_b, poly_b_count, -normal, pb);
-
-    for (int i = 0; i < acn; ++i) {
-        if (algo_plane_contains_point(pa, pb[i])) { pa[pa_cnt++] = pb[i]; }
-        if (algo_plane_contains_point(pb, pa[i])) { pb[pb_cnt++] = pa[i]; }
-    }
-
-    // axis & plane of collision
-    bool use_a  =      (pa_cnt >= pb_cnt);
-    Vec2* plane =       use_a ? pa     : pb;
-    U32   plane_count = use_a ? pa_cnt : pb_cnt;
-
-    if (plane_count > mpv)  return {}; // this is degenerate, never more than 4 vertices
-    if (plane_count <= acn) return {}; // a plane needs an axis and an vertex or two
-
-    F32 min_prj =  FLT_MAX, 
-        max_prj = -FLT_MAX;
-        
-    const Vec2* axis     = plane; // axis is first two indices on the plane
-    const Vec2  axis_dir = axis[1] - axis[0];
-
-    for (int i = 0; i < plane_count; ++i) {
-
-        // project plane point onto axis
-        F32 prj = vec2_dot(plane[i] - axis[0], axis_dir);
-        
-        // find extreme projections, anything between these is a collision point
-        min_prj = fminf(prj, min_prj);
-        max_prj = fmaxf(prj, max_prj);
-    }
-
-    U32 count{};
-    Vec2 contact{};
-
-    for (int i = 0; i < plane_count; ++i) {
-        
-        // project plane point onto axis
-        F32 prj = vec2_dot(plane[i] - axis[0], axis_dir);
-
-        // use as collision point, it has minimum two neighbors
-        if (prj > min_prj && prj < max_prj) {
-            contact += plane[i];
-            ++count;
+    const PsxSimplexVertex& p = poly[best];
+    const PsxSimplexVertex& q = poly[best + 1 == count ? 0 : best + 1];
+
+    const U32 edges_a[4] = { p.ia, (p.ia + poly_a_count - 1) % poly_a_count, q.ia, (q.ia + poly_a_count - 1) % poly_a_count };
+    const U32 edges_b[4] = { p.ib, (p.ib + poly_b_count - 1) % poly_b_count, q.ib, (q.ib + poly_b_count - 1) % poly_b_count };
+
+    F32 best_depth = FLT_MAX;
+    Vec2 best_axis = normal;
+
+    for (U32 i = 0; i < 8; ++i) {
+        Vec2 axis = i < 4 ? normals_a[edges_a[i]] : -normals_b[edges_b[i - 4]];
+        if (axis.x == 0.f && axis.y == 0.f) continue; // degenerate edge
+
+        F32 d = algo_axis_penetration(poly_a, poly_a_count, poly_b, poly_b_count, axis, p.ia, p.ib);
+        if (d < best_depth) {
+            best_depth = d;
+            best_axis = axis;
         }
     }
 
-    contact /= (F32) count;
+    // every candidate was degenerate, keep the polytope edge
+    if (best_depth == FLT_MAX) return true;
+
+    normal = best_axis;
+    depth = best_depth;
 
-    return contact;
+    return true;
+}
+
+F32 algo_poly_separation(
+    const Vec2* poly_a, U32 poly_a_count,
+    const Vec2* poly_b, U32 poly_b_count,
+    Vec2& axis
+) {
+    F32 winding = algo_poly_winding(poly_a, poly_a_count);
+    F32 best = -FLT_MAX;
+
+    for (U32 i = 0; i < poly_a_count; ++i) {
+        Vec2 n = algo_edge_normal(poly_a, poly_a_count, i, winding);
+
+        // deepest vertex of b below the edge
+        F32 min_b = FLT_MAX;
+        for (U32 j = 0; j < poly_b_count; ++j) {
+            F32 d = vec2_dot(n, poly_b[j] - poly_a[i]);
+            if (d < min_b) min_b = d;
+        }
+
+        if (min_b > best) {
+            best = min_b;
+            axis = n;
+        }
+    }
+
+    return best;
+}
+
+F32 algo_point_poly_distance(const Vec2* poly, U32 count, const Vec2& point, Vec2& normal) {
+    F32 winding = algo_poly_winding(poly, count);
+
+    // inside, the nearest edge plane
+    F32 inside = -FLT_MAX;
+    Vec2 inside_normal = { 0, 0 };
+    bool outside = false;
+
+    for (U32 i = 0; i < count; ++i) {
+        Vec2 n = algo_edge_normal(poly, count, i, winding);
+        F32 d = vec2_dot(n, point - poly[i]);
+
+        if (d > 0.f) outside = true;
+        if (d > inside) {
+            inside = d;
+            inside_normal = n;
+        }
+    }
+
+    if (!outside) {
+        normal = inside_normal;
+        return inside;
+    }
+
+    // outside, the nearest point on the boundary
+    F32 best_sq = FLT_MAX;
+    Vec2 best = poly[0];
+
+    for (U32 i = 0; i < count; ++i) {
+        Vec2 a = poly[i];
+        Vec2 e = poly[(i + 1) % count] - a;
+
+        F32 len_sq = vec2_length_sq(e);
+        F32 t = len_sq > 0.f ? f32_clamp(vec2_dot(point - a, e) / len_sq, 0.f, 1.f) : 0.f;
+
+        Vec2 q = a + e * t;
+        F32 d_sq = vec2_length_sq(point - q);
+        if (d_sq < best_sq) {
+            best_sq = d_sq;
+            best = q;
+        }
+    }
+
+    F32 dist = sqrtf(best_sq);
+    normal = vec2_normal(point - best, dist, inside_normal);
+    return dist;
 }
 
 bool algo_plane_intersection(
@@ -199,4 +624,56 @@ bool algo_plane_intersection(
     normal = vec2_normal(normal);
 
     return true;
-}
\ No newline at end of file
+}
+Vec2 algo_closest_on_segment(const Vec2& a, const Vec2& b, const Vec2& p, F32& t) {
+    Vec2 e = b - a;
+    F32 len_sq = vec2_length_sq(e);
+
+    t = len_sq > 0.f ? f32_clamp(vec2_dot(p - a, e) / len_sq, 0.f, 1.f) : 0.f;
+    return a + e * t;
+}
+
+F32 algo_segments_closest(const Vec2& p1, const Vec2& q1, const Vec2& p2, const Vec2& q2, Vec2& c1, Vec2& c2) {
+    Vec2 d1 = q1 - p1;
+    Vec2 d2 = q2 - p2;
+    Vec2 r = p1 - p2;
+
+    F32 a = vec2_dot(d1, d1);
+    F32 e = vec2_dot(d2, d2);
+    F32 f = vec2_dot(d2, r);
+
+    F32 s = 0.f;
+    F32 t = 0.f;
+
+    // parameters of the closest points, a degenerate segment is a point
+    if (a <= FLT_EPSILON && e <= FLT_EPSILON) {
+        s = t = 0.f;
+    } else if (a <= FLT_EPSILON) {
+        t = f32_clamp(f / e, 0.f, 1.f);
+    } else {
+        F32 c = vec2_dot(d1, r);
+
+        if (e <= FLT_EPSILON) {
+            s = f32_clamp(-c / a, 0.f, 1.f);
+        } else {
+            F32 b = vec2_dot(d1, d2);
+            F32 denom = a * e - b * b;
+
+            // parallel segments pick any s, t fixes it up
+            s = denom > 0.f ? f32_clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+            t = (b * s + f) / e;
+
+            if (t < 0.f) {
+                t = 0.f;
+                s = f32_clamp(-c / a, 0.f, 1.f);
+            } else if (t > 1.f) {
+                t = 1.f;
+                s = f32_clamp((b - c) / a, 0.f, 1.f);
+            }
+        }
+    }
+
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+    return vec2_length_sq(c1 - c2);
+}
@@ -0,0 +1,206 @@
+#include "psx_arena.h"
+#include "psx_world.h"
+
+static_assert((CFG_VERTEX_ARENA_CHUNK & (CFG_VERTEX_ARENA_CHUNK - 1)) == 0, "arena chunk must be a power of two");
+
+static constexpr U32 g_arena_classes = 32;
+
+struct PsxArenaState {
+    // chunks are allocated as the arena grows and never move, offsets run across them
+    Vec2** chunks = nullptr;
+    U32 chunk_count = 0;
+    U32 chunk_capacity = 0;
+
+    U32 free_lists[g_arena_classes] = {}; // head of each class, offset + 1
+    U32 top = 0;
+    U32 used = 0;
+
+    U32 pack_top = 0; // write cursor while compacting
+    U32 pack_used = 0;
+};
+
+static PsxArenaState& arena_state() {
+    return *world_current()->arena;
+}
+
+PsxArenaState* arena_state_new() {
+    return new PsxArenaState();
+}
+
+void arena_state_free(PsxArenaState* state) {
+    for (U32 i = 0; i < state->chunk_count; ++i) {
+        free(state->chunks[i]);
+    }
+
+    free(state->chunks);
+    delete state;
+}
+
+static U32 arena_class(U32 count) {
+    U32 c = ARENA_MIN_CLASS;
+    while ((1u << c) < count) c++;
+    return c;
+}
+
+static Vec2* arena_at(U32 offset) {
+    return arena_state().chunks[offset / CFG_VERTEX_ARENA_CHUNK] + (offset & (CFG_VERTEX_ARENA_CHUNK - 1));
+}
+
+// free blocks keep the link to the next one in their first vertex
+static U32 arena_get_link(U32 offset) {
+    U32 link;
+    memcpy(&link, arena_at(offset), sizeof(U32));
+    return link;
+}
+
+static void arena_set_link(U32 offset, U32 link) {
+    memcpy(arena_at(offset), &link, sizeof(U32));
+}
+
+static void arena_push_free(U32 offset, U32 c) {
+    PsxArenaState& state = arena_state();
+
+    arena_set_link(offset, state.free_lists[c]);
+    state.free_lists[c] = offset + 1;
+}
+
+static void arena_grow() {
+    PsxArenaState& state = arena_state();
+
+    if (state.chunk_count >= state.chunk_capacity) {
+        state.chunk_capacity = state.chunk_capacity ? state.chunk_capacity * 2 : 4;
+        state.chunks = (Vec2**) realloc(state.chunks, state.chunk_capacity * sizeof(Vec2*));
+
+        if (!state.chunks) THROW("Arena: out of memory");
+    }
+
+    Vec2* chunk = (Vec2*) malloc(CFG_VERTEX_ARENA_CHUNK * sizeof(Vec2));
+    if (!chunk) THROW("Arena: out of memory");
+
+    state.chunks[state.chunk_count++] = chunk;
+}
+
+// offset the next block of size goes to when bumping from top, blocks never straddle chunks
+static U32 arena_fit(U32 top, U32 size) {
+    U32 end = (top / CFG_VERTEX_ARENA_CHUNK + 1) * CFG_VERTEX_ARENA_CHUNK;
+    return (top + size > end) ? end : top;
+}
+
+U32 arena_block_size(U32 count) {
+    return 1u << arena_class(count);
+}
+
+U32 arena_alloc_vertices(U32 count) {
+    PsxArenaState& state = arena_state();
+
+    U32 c = arena_class(count);
+    U32 size = 1u << c;
+
+    if (size > CFG_VERTEX_ARENA_CHUNK) {
+        return NO_INSTANCE;
+    }
+
+    U32 offset;
+
+    if (state.free_lists[c]) {
+        offset = state.free_lists[c] - 1;
+        state.free_lists[c] = arena_get_link(offset);
+    }
+
+    else {
+        offset = arena_fit(state.top, size);
+
+        // the tail of a full chunk is split up into free blocks
+        for (U32 tail = state.top; tail < offset; ) {
+            U32 tc = ARENA_MIN_CLASS;
+            while (tail + (2u << tc) <= offset) tc++;
+
+            arena_push_free(tail, tc);
+            tail += 1u << tc;
+        }
+
+        while (offset + size > state.chunk_count * CFG_VERTEX_ARENA_CHUNK) {
+            arena_grow();
+        }
+
+        state.top = offset + size;
+    }
+
+    state.used += size;
+
+    return offset;
+}
+
+void arena_free_vertices(U32 offset, U32 count) {
+    PsxArenaState& state = arena_state();
+
+    if (offset == NO_INSTANCE) return;
+
+    U32 c = arena_class(count);
+    U32 size = 1u << c;
+
+    if (offset + size > state.top) {
+        THROW("Arena: free of block outside the arena @ offset=%u", offset);
+    }
+
+    arena_push_free(offset, c);
+
+    state.used -= size;
+}
+
+Vec2* arena_get_vertices(U32 offset) {
+    return arena_at(offset);
+}
+
+void arena_compact_begin() {
+    PsxArenaState& state = arena_state();
+
+    state.pack_top = 0;
+    state.pack_used = 0;
+}
+
+U32 arena_compact_place(U32 from, U32 count) {
+    PsxArenaState& state = arena_state();
+
+    U32 size = arena_block_size(count);
+    U32 to = arena_fit(state.pack_top, size);
+
+    if (to != from) {
+        memmove(arena_at(to), arena_at(from), size * sizeof(Vec2));
+    }
+
+    state.pack_top = to + size;
+    state.pack_used += size;
+
+    return to;
+}
+
+void arena_compact_end() {
+    PsxArenaState& state = arena_state();
+
+    memset(state.free_lists, 0, sizeof(state.free_lists));
+
+    // blocks skipped at chunk ends are lost until the next compaction
+    state.used = state.pack_used;
+    state.top = state.pack_top;
+
+    // hand back chunks nothing lives in anymore
+    U32 keep = (state.top + CFG_VERTEX_ARENA_CHUNK - 1) / CFG_VERTEX_ARENA_CHUNK;
+    while (state.chunk_count > keep) {
+        free(state.chunks[--state.chunk_count]);
+    }
+}
+
+U32 arena_count_top() {
+    return arena_state().top;
+}
+
+U32 arena_count_used() {
+    return arena_state().used;
+}
+
+U64 arena_memory_bytes() {
+    PsxArenaState& state = arena_state();
+
+    return (U64) state.chunk_count * CFG_VERTEX_ARENA_CHUNK * sizeof(Vec2) + (U64) state.chunk_capacity * sizeof(Vec2*);
+}
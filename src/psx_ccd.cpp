@@ -0,0 +1,296 @@
+#include "psx_ccd.h"
+#include "psx_spacial.h"
+#include "psx_collider.h"
+#include "psx_partition.h"
+#include "psx_material.h"
+#include "psx_algo.h"
+#include "psx_profile.h"
+#include <vector>
+
+// collider geometry at one pose, capsules are their core as a 2 vertex polygon rounded by radius
+struct CcdShape {
+    Shape shape;
+    Vec2 center;
+    F32 radius;
+    const Vec2* vertices;
+    U32 count;
+};
+
+static Vec2 ccd_lerp(Vec2 a, Vec2 b, F32 t) { return a + (b - a) * t; }
+static F32 ccd_lerp(F32 a, F32 b, F32 t) { return a + (b - a) * t; }
+
+static Vec2 ccd_center_at(const PsxCollider& c, Vec2 pos, F32 ang) {
+    Vec2 center = pos + c.offset;
+    if (ang == 0.f) return center;
+    return vec2_rotate(center, pos, ang);
+}
+
+// collider c with its spacial at pos/ang, polygon vertices are written to buffer
+static CcdShape ccd_shape_at(const PsxCollider& c, Vec2 pos, F32 ang, std::vector<Vec2>& buffer) {
+    Vec2 center = ccd_center_at(c, pos, ang);
+
+    if (c.shape == SHAPE_CIRCLE) {
+        return { SHAPE_CIRCLE, center, c.circ.radius, nullptr, 0 };
+    }
+
+    if (c.shape == SHAPE_CAPSULE || c.shape == SHAPE_SEGMENT) {
+        Vec2 rot = vec2_rotation(ang);
+
+        buffer.resize(2);
+        buffer[0] = center + vec2_rotate_by(c.caps.local[0], rot);
+        buffer[1] = center + vec2_rotate_by(c.caps.local[1], rot);
+
+        return { SHAPE_CAPSULE, center, c.caps.radius, buffer.data(), 2 };
+    }
+
+    buffer.resize(c.poly.count);
+    glx_transform_poly_2d(center, buffer.data(), c.poly.identity, c.poly.count, c.poly.scale, ang);
+
+    return { SHAPE_POLY, center, 0.f, buffer.data(), c.poly.count };
+}
+
+// collider c where the last collider update left it
+static CcdShape ccd_shape_of(const PsxCollider& c) {
+    if (c.shape == SHAPE_CIRCLE) {
+        return { SHAPE_CIRCLE, glx_aabb_center(c.bounding_box), c.circ.radius, nullptr, 0 };
+    }
+
+    if (c.shape == SHAPE_CAPSULE || c.shape == SHAPE_SEGMENT) {
+        return { SHAPE_CAPSULE, (c.caps.world[0] + c.caps.world[1]) * 0.5f, c.caps.radius, c.caps.world, 2 };
+    }
+
+    return { SHAPE_POLY, c.poly.center, 0.f, c.poly.transform, c.poly.count };
+}
+
+// farthest point of the collider from its center
+static F32 ccd_extent(const PsxCollider& c) {
+    if (c.shape == SHAPE_CIRCLE) return c.circ.radius;
+
+    if (c.shape == SHAPE_CAPSULE || c.shape == SHAPE_SEGMENT) {
+        return fmaxf(vec2_length(c.caps.local[0]), vec2_length(c.caps.local[1])) + c.caps.radius;
+    }
+
+    F32 extent_sq = 0.f;
+    for (U32 i = 0; i < c.poly.count; ++i) {
+        F32 d = vec2_length_sq(c.poly.identity[i] * c.poly.scale);
+        if (d > extent_sq) extent_sq = d;
+    }
+
+    return sqrtf(extent_sq);
+}
+
+// largest circle around the center that fits inside the collider
+static F32 ccd_inner_radius(const PsxCollider& c) {
+    if (c.shape == SHAPE_CIRCLE) return c.circ.radius;
+
+    if (c.shape == SHAPE_CAPSULE || c.shape == SHAPE_SEGMENT) {
+        F32 t;
+        Vec2 core = algo_closest_on_segment(c.caps.local[0], c.caps.local[1], { 0, 0 }, t);
+        return fmaxf(c.caps.radius - vec2_length(core), 0.f);
+    }
+
+    Vec2 axis;
+    Vec2 center = { 0, 0 };
+    F32 inner = -algo_poly_separation(c.poly.identity, c.poly.count, &center, 1, axis) * c.poly.scale;
+
+    return fmaxf(inner, 0.f);
+}
+
+// no point of the collider moves further than this over the sweep
+static F32 ccd_motion_bound(const PsxCollider& c, const PsxSweep& sweep) {
+    F32 reach = vec2_length(c.offset) + ccd_extent(c);
+    return vec2_length(sweep.pos1 - sweep.pos0) + fabsf(sweep.ang1 - sweep.ang0) * reach;
+}
+
+/*
+    gap between a and b, a lower bound of the distance when polygons are
+    involved. capsules are measured between the cores and the radii taken
+    off. normal points from a to b
+*/
+static F32 ccd_separation(const CcdShape& a, const CcdShape& b, Vec2& normal) {
+    if (a.shape == SHAPE_CIRCLE && b.shape == SHAPE_CIRCLE) {
+        Vec2 d = b.center - a.center;
+        F32 len = vec2_length(d);
+
+        normal = vec2_normal(d, len, { 0, 1 });
+        return len - a.radius - b.radius;
+    }
+
+    if (a.shape == SHAPE_CIRCLE) {
+        Vec2 n;
+        F32 d = algo_point_poly_distance(b.vertices, b.count, a.center, n);
+
+        normal = -n;
+        return d - a.radius - b.radius;
+    }
+
+    if (b.shape == SHAPE_CIRCLE) {
+        F32 d = algo_point_poly_distance(a.vertices, a.count, b.center, normal);
+        return d - a.radius - b.radius;
+    }
+
+    // two cores, exact
+    if (a.shape == SHAPE_CAPSULE && b.shape == SHAPE_CAPSULE) {
+        Vec2 pa, pb;
+        F32 d = sqrtf(algo_segments_closest(a.vertices[0], a.vertices[1], b.vertices[0], b.vertices[1], pa, pb));
+
+        normal = vec2_normal(pb - pa, d, vec2_normal(b.center - a.center, { 0, 1 }));
+        return d - a.radius - b.radius;
+    }
+
+    Vec2 axis_a, axis_b;
+    F32 sep_a = algo_poly_separation(a.vertices, a.count, b.vertices, b.count, axis_a);
+    F32 sep_b = algo_poly_separation(b.vertices, b.count, a.vertices, a.count, axis_b);
+
+    if (sep_a >= sep_b) {
+        normal = axis_a;
+        return sep_a - a.radius - b.radius;
+    }
+
+    normal = -axis_b;
+    return sep_b - a.radius - b.radius;
+}
+
+PsxToi ccd_time_of_impact(Inst collider, const PsxSweep& sweep, Inst other) {
+    thread_local std::vector<Vec2> buffer;
+
+    const PsxCollider& c = collider_get(collider);
+    const CcdShape b = ccd_shape_of(collider_get(other));
+
+    F32 bound = ccd_motion_bound(c, sweep);
+
+    PsxToi toi = { false, 1.f, { 0, 0 } };
+    F32 t = 0.f;
+
+    for (U32 it = 0; it < CFG_CCD_ITERATIONS; ++it) {
+        CcdShape a = ccd_shape_at(c, ccd_lerp(sweep.pos0, sweep.pos1, t), ccd_lerp(sweep.ang0, sweep.ang1, t), buffer);
+
+        Vec2 normal;
+        F32 sep = ccd_separation(a, b, normal);
+
+        // touching at the start of the sweep, the narrowphase already has the contact
+        if (it == 0 && sep <= 0.f) return toi;
+
+        if (sep <= CFG_CCD_TOLERANCE - CFG_CCD_DEPTH) {
+            return { true, t, normal };
+        }
+
+        // the gap can't close faster than bound, so no contact is skipped
+        t += (sep + CFG_CCD_DEPTH) / bound;
+        if (t >= 1.f) return toi;
+    }
+
+    // stop short of it, the next sweep carries on from here
+    return { true, t, { 0, 0 } };
+}
+
+// box around everything the collider touches over the sweep
+static AABB ccd_swept_box(const PsxCollider& c, const PsxSweep& sweep) {
+    Vec2 c0 = ccd_center_at(c, sweep.pos0, sweep.ang0);
+    Vec2 c1 = ccd_center_at(c, sweep.pos1, sweep.ang1);
+
+    // the center swings on an arc around the spacial when the collider is offset
+    F32 swing = vec2_length(c.offset) * fminf(fabsf(sweep.ang1 - sweep.ang0), (F32) M_PI) * 0.5f;
+    F32 extent = ccd_extent(c) + swing;
+
+    AABB box = {
+        { fminf(c0.x, c1.x), fminf(c0.y, c1.y) },
+        { fmaxf(c0.x, c1.x), fmaxf(c0.y, c1.y) },
+    };
+
+    return glx_aabb_expand(box, extent);
+}
+
+static bool ccd_can_hit(const PsxCollider& c, const PsxCollider& other) {
+    if (other.shape == SHAPE_NONE || other.spacial == NO_INSTANCE) return false;
+    if (other.spacial == c.spacial) return false;
+    if (!collider_compare_layer(c, other)) return false;
+
+    // two bullets meet in the narrowphase
+    return !collider_get_flags(other, SPACIAL_FLAG_BULLET);
+}
+
+static void ccd_sweep_bullet(Inst spacial, F32 dt) {
+    thread_local std::vector<Inst> candidates;
+
+    PsxSpacialStreams& st = spacial_streams();
+    const PsxSpacialInfo& info = spacial_get_info(spacial);
+    const U32 slot = info.slot;
+
+    PsxSweep sweep = { st.prev_pos[slot], st.prev_ang[slot], st.pos[slot], st.ang[slot] };
+    F32 time_left = dt;
+
+    for (U32 sub = 0; ; ++sub) {
+
+        // earliest hit of any collider of the bullet
+        PsxToi first = { false, 1.f, { 0, 0 } };
+        Inst first_collider = NO_INSTANCE;
+        Inst first_other = NO_INSTANCE;
+
+        for (Inst id = info.collider; id != NO_INSTANCE; id = collider_get(id).next) {
+            const PsxCollider& c = collider_get(id);
+            if (c.shape == SHAPE_NONE) continue;
+            if (c.shape == SHAPE_COMPOUND) continue; // its children are on the list themselves
+
+            // anything it could pass through still overlaps it at the end, the narrowphase has that
+            if (ccd_motion_bound(c, sweep) <= ccd_inner_radius(c)) continue;
+
+            candidates.clear();
+            bvh_query_aabb(ccd_swept_box(c, sweep), candidates);
+
+            for (Inst other : candidates) {
+                if (!ccd_can_hit(c, collider_get(other))) continue;
+
+                PsxToi toi = ccd_time_of_impact(id, sweep, other);
+                if (toi.hit && toi.t < first.t) {
+                    first = toi;
+                    first_collider = id;
+                    first_other = other;
+                }
+            }
+        }
+
+        if (!first.hit) break;
+
+        Vec2 pos = ccd_lerp(sweep.pos0, sweep.pos1, first.t);
+        F32 ang = ccd_lerp(sweep.ang0, sweep.ang1, first.t);
+        st.pos[slot] = pos;
+        st.ang[slot] = ang;
+        st.rot[slot] = vec2_rotation(ang);
+
+        // dynamic bodies take part of the momentum, that is the solver's job next step
+        const PsxCollider& other = collider_get(first_other);
+        if (!collider_get_flags(other, SPACIAL_FLAG_STATIC)) break;
+        if (sub + 1 >= CFG_CCD_SUBSTEPS) break;
+
+        // bounce off static colliders and sweep on with the rest of the step
+        Vec2& vel = st.vel[slot];
+        F32 vn = vec2_dot(vel, first.normal);
+
+        if (vn > 0.f) {
+            F32 e = vn > CFG_SOLVER_RESTITUTION_THRESHOLD
+                ? material_mix_restitution(collider_get(first_collider).material, other.material)
+                : 0.f;
+
+            vel -= first.normal * (vn * (1.f + e));
+        }
+
+        time_left *= 1.f - first.t;
+        sweep = { pos, ang, pos + vel * time_left, ang + st.ang_vel[slot] * time_left };
+
+        st.pos[slot] = sweep.pos1;
+        st.ang[slot] = sweep.ang1;
+        st.rot[slot] = vec2_rotation(sweep.ang1);
+    }
+}
+
+void ccd_solve(F32 dt) {
+    PROFILE_SCOPE(PROFILE_ZONE_CCD);
+    PsxSpacialStreams& st = spacial_streams();
+
+    for (U32 slot = 0; slot < st.awake_count; ++slot) {
+        if (!(st.flags[slot] & SPACIAL_FLAG_BULLET)) continue;
+
+        ccd_sweep_bullet(st.owner[slot], dt);
+    }
+}
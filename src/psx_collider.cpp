@@ -1,77 +1,326 @@
 #include "psx_collider.h"
-#include "analytics.h"
+#include "psx_profile.h"
+#include "psx_pool.h"
+#include "psx_world.h"
+#include "psx_island.h"
+#include <algorithm>
+#include <vector>
+
+struct PsxColliderState {
+    PsxPool<PsxCollider> colliders;
+    std::vector<Inst> updated;
+    std::vector<Inst> moving;
+    std::vector<Inst> phased;
+    U32 live_count = 0;
+};
+
+static PsxColliderState& collider_state() {
+    return *world_current()->collider;
+}
+
+PsxColliderState* collider_state_new() {
+    return new PsxColliderState();
+}
 
-static PsxCollider g_colliders[CFG_MAX_COLLIDERS] = { };
-static U32 g_updated_colliders[CFG_MAX_COLLIDERS] = { };
-static U32 g_collider_free[CFG_MAX_COLLIDERS] = { };
-static U32 g_colliders_free_top = 0;
-static U32 g_next_collider = 0;
-static U32 g_updated_collider_count = 0;
+void collider_state_free(PsxColliderState* state) {
+    state->colliders.release();
+    delete state;
+}
 
 PsxCollider& collider_get(U32 index) {
-    if (index >= g_next_collider) {
-        THROW("Collider: attempt to get invalid collider");
+    PsxColliderState& state = collider_state();
+
+    if (!state.colliders.valid(index)) {
+        THROW("Collider: attempt to get invalid or stale collider %u", index);
     }
 
-    return g_colliders[index];
+    return state.colliders[index];
 }
 
-PsxCollider& collider_alloc() {
-    U32 index;
+bool collider_valid(Inst collider) {
+    return collider_state().colliders.valid(collider);
+}
 
-    if (g_colliders_free_top > 0) {
-        g_colliders_free_top--;
-        index = g_collider_free[g_colliders_free_top];
-    }
+Inst collider_handle(U32 slot) {
+    return collider_state().colliders.handle(slot);
+}
 
-    else {
-        if (g_next_collider >= CFG_MAX_COLLIDERS) {
-            THROW("Physics: no more colliders");
-        }
+PsxCollider& collider_alloc() {
+    PsxColliderState& state = collider_state();
 
-        index = g_next_collider++;
-    }
+    U32 index = state.colliders.alloc();
 
     // instance new collider at index
-    PsxCollider& collider = g_colliders[index];
+    PsxCollider& collider = state.colliders[index];
 
     if (collider.shape != SHAPE_NONE) {
         THROW("Physics: got collider in use @ index=%i type=%i", index, collider.shape);
     }
 
     collider.phase = COLLIDER_PHASE_NONE;
-    collider.id = index;
+    collider.id = state.colliders.handle(index);
     collider.shape = SHAPE_NONE;
     collider.user_data = nullptr;
+    collider.bvh_leaf = NO_INSTANCE;
+    collider.moving_index = NO_INSTANCE;
+    collider.next = NO_INSTANCE;
+    collider.compound = NO_INSTANCE;
+    collider.pose_ang = NAN; // never equal, the first update always runs
+
+    state.live_count++;
 
     return collider;
 }
 
-void collider_make_heap_buffer(PsxCollider& collider, U32 size) {
-    collider.heap_buffer = (U8*) malloc(size);
-    collider.alloc_bytes = size;
+/*
+    polygon vertices
+*/
+
+// identity, transform, local normals, normals
+static const U32 COLLIDER_POLY_STREAMS = 4;
+
+static void collider_bind_vertices(PsxPolyCollider& poly) {
+    Vec2* block = arena_get_vertices(poly.arena);
+
+    poly.identity      = block;
+    poly.transform     = block + poly.count;
+    poly.local_normals = block + poly.count * 2;
+    poly.normals       = block + poly.count * 3;
+}
+
+static void collider_alloc_vertices(PsxCollider& collider, U32 count) {
+    U32 offset = arena_alloc_vertices(COLLIDER_POLY_STREAMS * count);
+
+    if (offset == NO_INSTANCE) {
+        THROW("Physics: polygon with %u vertices doesn't fit an arena chunk", count);
+    }
+
+    collider.poly.arena = offset;
+    collider.poly.count = count;
+    collider_bind_vertices(collider.poly);
+}
+
+void collider_compact_vertices() {
+    PsxColliderState& state = collider_state();
+
+    thread_local std::vector<Inst> polys;
+    polys.clear();
+
+    for (U32 i = 0; i < state.colliders.count; ++i) {
+        if (state.colliders[i].shape == SHAPE_POLY) polys.push_back(i);
+    }
+
+    U32 count = (U32) polys.size();
+
+    // moving blocks down in offset order never overwrites one that hasn't moved yet
+    std::sort(polys.begin(), polys.end(), [&](Inst a, Inst b) {
+        return state.colliders[a].poly.arena < state.colliders[b].poly.arena;
+    });
+
+    arena_compact_begin();
+
+    for (U32 i = 0; i < count; ++i) {
+        PsxPolyCollider& poly = state.colliders[polys[i]].poly;
+
+        poly.arena = arena_compact_place(poly.arena, COLLIDER_POLY_STREAMS * poly.count);
+        collider_bind_vertices(poly);
+    }
+
+    arena_compact_end();
+}
+
+/*
+    broadphase tracking, every collider gets a tree leaf and colliders on
+    awake dynamic spacials are kept on the moving list
+*/
+
+static void collider_moving_add(PsxCollider& c) {
+    PsxColliderState& state = collider_state();
+
+    c.moving_index = (U32) state.moving.size();
+    state.moving.push_back(c.id);
+}
+
+static void collider_moving_remove(PsxCollider& c) {
+    PsxColliderState& state = collider_state();
+
+    Inst last = state.moving.back();
+    state.moving.pop_back();
+    state.moving[c.moving_index] = last;
+    state.colliders[last].moving_index = c.moving_index;
+    c.moving_index = NO_INSTANCE;
+}
+
+// base config, children of a compound take its spacial
+static void collider_configure(PsxCollider& c, PsxColliderConfig cfg) {
+    if (cfg.compound != NO_INSTANCE) {
+        const PsxCollider& parent = collider_get(cfg.compound);
+
+        if (parent.shape != SHAPE_COMPOUND) {
+            THROW("Physics: collider %u is not a compound", cfg.compound);
+        }
+
+        cfg.spacial = parent.spacial;
+    }
+
+    c.spacial = cfg.spacial;
+    c.material = cfg.material;
+    c.offset = cfg.offset;
+    c.user_data = cfg.user_data;
+    c.compound = cfg.compound;
+}
+
+// box of a compound from its children, a point at the spacial while it has none
+static void collider_compound_refit(PsxCollider& c) {
+    if (bvh_local_refit(c.comp.tree, c.bounding_box)) return;
+
+    Vec2 pos = c.spacial != NO_INSTANCE ? spacial_get_pos(c.spacial) : Vec2{ 0, 0 };
+    c.bounding_box = { pos, pos };
+}
+
+// children joined or left, the leaf follows the new box
+static void collider_compound_changed(PsxCollider& c) {
+    collider_compound_refit(c);
+
+    if (c.bvh_leaf != NO_INSTANCE) {
+        bvh_move(c.bvh_leaf, c.bounding_box, { 0, 0 });
+    }
+}
+
+static void collider_track(PsxCollider& c) {
+    if (c.spacial == NO_INSTANCE) return;
+
+    // a new collider wakes the body it's put on
+    island_wake(c.spacial);
+
+    if (c.compound != NO_INSTANCE) {
+        // children are reached through the local tree of their compound
+        PsxCollider& parent = collider_get(c.compound);
+
+        bvh_local_add(parent.comp.tree, c.id);
+        collider_compound_changed(parent);
+    } else {
+        bool dynamic = !collider_get_flags(c, SPACIAL_FLAG_STATIC);
+        c.bvh_leaf = bvh_insert(c.id, c.bounding_box, dynamic);
+
+        if (dynamic) {
+            collider_moving_add(c);
+        }
+    }
+
+    PsxSpacialInfo& info = spacial_get_info(c.spacial);
+    c.next = info.collider;
+    info.collider = c.id;
+}
+
+static void collider_untrack(PsxCollider& c) {
+    if (c.bvh_leaf != NO_INSTANCE) {
+        bvh_remove(c.bvh_leaf);
+        c.bvh_leaf = NO_INSTANCE;
+    }
+
+    if (c.moving_index != NO_INSTANCE) {
+        collider_moving_remove(c);
+    }
+
+    if (c.compound != NO_INSTANCE) {
+        PsxCollider& parent = collider_get(c.compound);
+
+        bvh_local_remove(parent.comp.tree, c.id);
+        collider_compound_changed(parent);
+        c.compound = NO_INSTANCE;
+    }
+
+    if (!spacial_valid(c.spacial)) return;
+
+    // unlink from the colliders of the spacial
+    Inst* link = &spacial_get_info(c.spacial).collider;
+    while (*link != NO_INSTANCE && *link != c.id) {
+        link = &collider_get(*link).next;
+    }
+
+    if (*link == c.id) *link = c.next;
+    c.next = NO_INSTANCE;
+}
+
+void collider_set_sleeping(PsxCollider& c, bool sleeping) {
+    if (c.bvh_leaf == NO_INSTANCE) return;
+
+    if (sleeping && c.moving_index != NO_INSTANCE) {
+        collider_moving_remove(c);
+    }
+
+    if (!sleeping && c.moving_index == NO_INSTANCE) {
+        collider_moving_add(c);
+    }
+
+    bvh_set_dynamic(c.bvh_leaf, !sleeping);
+}
+
+void colliders_detach_spacial(Inst spacial) {
+    PsxSpacialInfo& info = spacial_get_info(spacial);
+
+    Inst next = info.collider;
+    while (next != NO_INSTANCE) {
+        PsxCollider& c = collider_get(next);
+        next = c.next;
+
+        // children stay in the local tree of their compound, it left the tree with them
+        if (c.bvh_leaf != NO_INSTANCE) {
+            bvh_remove(c.bvh_leaf);
+            c.bvh_leaf = NO_INSTANCE;
+        }
+
+        if (c.moving_index != NO_INSTANCE) {
+            collider_moving_remove(c);
+        }
+
+        manifolds_free_collider(c.id);
+
+        c.spacial = NO_INSTANCE;
+        c.next = NO_INSTANCE;
+    }
+
+    info.collider = NO_INSTANCE;
 }
 
 void collider_free(U32 index) {
-    PsxCollider& collider = collider_get(index);
+    PsxColliderState& state = collider_state();
+
+    if (!state.colliders.valid(index)) {
+        return;
+    }
+
+    PsxCollider& collider = state.colliders[index];
         
     if (collider.shape == SHAPE_NONE) {
         return;
     }
 
-    collider.shape = SHAPE_NONE;
-    collider.user_data = nullptr;
+    // children go with their compound, detached first so they don't rebuild its tree one by one
+    if (collider.shape == SHAPE_COMPOUND) {
+        std::vector<Inst> children = bvh_local_colliders(collider.comp.tree);
+
+        for (Inst child : children) {
+            collider_get(child).compound = NO_INSTANCE;
+            collider_free(child);
+        }
 
-    if (g_colliders_free_top >= CFG_MAX_COLLIDERS) {
-        THROW("Physics: no more free slots");
+        bvh_local_free(collider.comp.tree);
     }
 
-    if (collider.alloc_bytes > 0) {
-        free(collider.heap_buffer);
+    collider_untrack(collider);
+    manifolds_free_collider(collider.id);
+    state.live_count--;
+
+    if (collider.shape == SHAPE_POLY) {
+        arena_free_vertices(collider.poly.arena, COLLIDER_POLY_STREAMS * collider.poly.count);
     }
-    collider.alloc_bytes = 0;
 
-    g_collider_free[g_colliders_free_top++] = collider.id;
+    collider.shape = SHAPE_NONE;
+    collider.user_data = nullptr;
+
+    state.colliders.free(collider.id);
 }
 
 Inst collider_new_circle(F32 radius, PsxColliderConfig cfg) {
@@ -80,73 +329,144 @@ Inst collider_new_circle(F32 radius, PsxColliderConfig cfg) {
     // base collider
     collider.shape = SHAPE_CIRCLE;
     collider.circ.radius = radius;
-    collider.spacial = cfg.spacial;
-    collider.material = cfg.material;
-    collider.offset = cfg.offset;
-    collider.user_data = cfg.user_data;
+    collider_configure(collider, cfg);
 
     collider.bounding_box = {{ F32_MAX, F32_MAX }, { -F32_MAX, -F32_MAX }};
 
+    if (collider.spacial != NO_INSTANCE) {
+        Vec2 pos = collider_get_pos(collider);
+        collider.bounding_box.min = pos - radius;
+        collider.bounding_box.max = pos + radius;
+    }
+
+    collider_track(collider);
+
     return collider.id;
 }
 
 Inst collider_new_poly(GlxPolygon identity, F32 scale, PsxColliderConfig cfg) {
     PsxCollider& collider = collider_alloc();
+
+    // store the identity & transform matrix
+    collider_alloc_vertices(collider, identity.count);
     
     // base collider
     collider.shape = SHAPE_POLY;
-    collider.spacial = cfg.spacial;
-    collider.material = cfg.material;
-    collider.offset = cfg.offset;
-    collider.user_data = cfg.user_data;
-
-    collider.bounding_box = {{ F32_MAX, F32_MAX }, { -F32_MAX, -F32_MAX }};
-
-    // store the identity & transform matrix
-    collider_make_heap_buffer(collider, 2 * identity.bytes);
-
-    // collider_make_heap_buffer(collider, matrix_size + 1);
-
-    collider.poly.identity  = (Vec2*)  collider.heap_buffer;
-    collider.poly.transform = (Vec2*) (collider.heap_buffer + identity.bytes);
+    collider_configure(collider, cfg);
 
     memcpy(collider.poly.identity, identity.data, identity.count * sizeof(Vec2));
     
     collider.poly.scale = scale;
-    collider.poly.count = identity.count;
-    collider.poly.center = { 0, 0 };
+
+    // edge normals never change in identity space, the scaled vertices are the transform's scratch here
+    U32 count = collider.poly.count;
+    for (U32 i = 0; i < count; ++i) collider.poly.transform[i] = collider.poly.identity[i] * scale;
+
+    F32 winding = algo_poly_winding(collider.poly.transform, count);
+    for (U32 i = 0; i < count; ++i) {
+        collider.poly.local_normals[i] = algo_edge_normal(collider.poly.transform, count, i, winding);
+    }
 
     // initial transform
+    const PsxSpacialStreams& st = spacial_streams();
+    Vec2 rot = st.rot[spacial_get_info(collider.spacial).slot];
+
     glx_transform_poly_2d(
         collider_get_pos(collider.id), 
         collider.poly.transform, 
         collider.poly.identity, 
         collider.poly.count, 
         collider.poly.scale,
-        spacial_get_ang(collider.spacial),
-        &collider.bounding_box,
-        &collider.poly.center
+        rot,
+        collider.bounding_box,
+        collider.poly.center
     );
 
+    for (U32 i = 0; i < count; ++i) {
+        collider.poly.normals[i] = vec2_rotate_by(collider.poly.local_normals[i], rot);
+    }
+
+    collider_track(collider);
+
     return collider.id;
 }
 
+// world endpoints and box of a capsule whose collider sits at pos
+static void collider_place_capsule(PsxCollider& c, Vec2 pos, Vec2 rot) {
+    PsxCapsuleCollider& caps = c.caps;
+
+    caps.world[0] = pos + vec2_rotate_by(caps.local[0], rot);
+    caps.world[1] = pos + vec2_rotate_by(caps.local[1], rot);
+
+    c.bounding_box.min = Vec2{ fminf(caps.world[0].x, caps.world[1].x), fminf(caps.world[0].y, caps.world[1].y) } - caps.radius;
+    c.bounding_box.max = Vec2{ fmaxf(caps.world[0].x, caps.world[1].x), fmaxf(caps.world[0].y, caps.world[1].y) } + caps.radius;
+}
+
+static Inst collider_new_rounded(Shape shape, Vec2 a, Vec2 b, F32 radius, PsxColliderConfig cfg) {
+    PsxCollider& collider = collider_alloc();
+
+    // base collider
+    collider.shape = shape;
+    collider.caps.local[0] = a;
+    collider.caps.local[1] = b;
+    collider.caps.radius = radius;
+    collider_configure(collider, cfg);
+
+    collider.bounding_box = {{ F32_MAX, F32_MAX }, { -F32_MAX, -F32_MAX }};
+
+    if (collider.spacial != NO_INSTANCE) {
+        const PsxSpacialStreams& st = spacial_streams();
+        collider_place_capsule(collider, collider_get_pos(collider), st.rot[spacial_get_info(collider.spacial).slot]);
+    }
+
+    collider_track(collider);
+
+    return collider.id;
+}
+
+Inst collider_new_compound(PsxColliderConfig cfg) {
+    if (cfg.compound != NO_INSTANCE) {
+        THROW("Physics: compounds can't be nested");
+    }
+
+    PsxCollider& collider = collider_alloc();
+
+    // base collider
+    collider.shape = SHAPE_COMPOUND;
+    collider.comp.tree = bvh_local_new();
+    collider_configure(collider, cfg);
+
+    collider_compound_refit(collider);
+    collider_track(collider);
+
+    return collider.id;
+}
+
+Inst collider_new_capsule(Vec2 a, Vec2 b, F32 radius, PsxColliderConfig cfg) {
+    return collider_new_rounded(SHAPE_CAPSULE, a, b, radius, cfg);
+}
+
+Inst collider_new_segment(Vec2 a, Vec2 b, PsxColliderConfig cfg) {
+    return collider_new_rounded(SHAPE_SEGMENT, a, b, 0.f, cfg);
+}
+
 Inst collider_new_rect(Vec2 area, PsxColliderConfig cfg) {
-    GlxPolygon identity = GlxPolygon({
+    // keep the vertices alive until collider_new_poly has copied them
+    const Vec2 vertices[] = {
         {-area.w * 0.5f, -area.h * 0.5f},
         {-area.w * 0.5f,  area.h * 0.5f},
         { area.w * 0.5f,  area.h * 0.5f},
         { area.w * 0.5f, -area.h * 0.5f},
-    });
+    };
 
-    return collider_new_poly(identity, 1.f, cfg);
+    return collider_new_poly(GlxPolygon(vertices), 1.f, cfg);
 }
 
 Vec2 collider_get_pos(const PsxCollider& c) {
-    PsxSpacial& s = spacial_get(c.spacial);
-    Vec2 pos = (s.pos + c.offset);
-    if (s.ang == 0.f) { return pos; }
-    return vec2_rotate(pos, s.pos, s.ang);
+    const PsxSpacialStreams& st = spacial_streams();
+    U32 slot = spacial_get_info(c.spacial).slot;
+
+    return st.pos[slot] + vec2_rotate_by(c.offset, st.rot[slot]);
 }
 
 U32 collider_get_group(const PsxCollider& c) {
@@ -189,6 +509,8 @@ F32 collider_get_radius(Inst index) {
 
     if (collider.shape == SHAPE_CIRCLE) {
         return collider.circ.radius;
+    } else if (collider.shape == SHAPE_CAPSULE) {
+        return collider.caps.radius;
     } else {
         return 0.f;
     }
@@ -199,135 +521,96 @@ const AABB& collider_get_bounding_box(Inst collider) {
     return c.bounding_box;
 }
 
-void collider_draw(Inst collider) {
-    PsxCollider& c = collider_get(collider);
-    Vec2 pos = collider_get_pos(collider);
+void collider_add_phase(PsxCollider& c, U32 phase) {
 
-    Color prev_color = shape_get_color();
-    GLXDrawMode prev_draw_mode = shape_get_draw_mode();
-
-    if (c.phase & COLLIDER_PHASE_RESOLVE) { // blue when resoliving
-        shape_color({64, 64, 255, 128});
-    }
-    else if (c.phase & COLLIDER_PHASE_NARROW) { // red when checking
-        shape_color({255, 64, 64, 128});
-    } 
-    else { // green when not colliding
-        shape_color({64, 255, 64, 128});
+    // remember who to reset next step
+    if (!(c.phase & (COLLIDER_PHASE_NARROW | COLLIDER_PHASE_RESOLVE))) {
+        collider_state().phased.push_back(c.id);
     }
 
-    switch (c.shape) {
-        case (SHAPE_CIRCLE) : { 
-            shape_point(pos);
-            shape_circle(pos, c.circ.radius); 
-            break;
-        }
-        case (SHAPE_POLY) : { 
-            shape_point(c.poly.center);
-            shape_polygon(c.poly.transform, c.poly.count); 
-            break;
-        }
-        default : { break; }
-    }
-
-    #if CFG_RENDER_BOUNDING_BOX
-
-    shape_draw_lines();
+    c.phase |= phase;
+}
 
-    shape_bounding_box(c.bounding_box);
+void collider_filter_updated() {
+    PROFILE_SCOPE(PROFILE_ZONE_FILTER);
+    PsxColliderState& state = collider_state();
 
-    #endif
+    // reset colliders that were marked by the last step
+    for (Inst id : state.phased) {
+        state.colliders[id].phase = COLLIDER_PHASE_BROAD;
+    }
+    state.phased.clear();
 
-    shape_color(prev_color);
-    shape_draw_mode(prev_draw_mode);
-}
+    // only colliders on dynamic spacials can have moved
+    state.updated.clear();
+    for (U32 i = 0; i < (U32) state.moving.size(); ++i) {
+        Inst id = state.moving[i];
 
-//
+        // run sanity check on collider
+        PsxCollider& c = state.colliders[id];
+        if (c.shape == SHAPE_NONE) continue;
+        if (c.spacial == NO_INSTANCE) continue;
 
-void collider_draw_all() {
-    shape_draw_lines();
+        c.phase = COLLIDER_PHASE_BROAD;
 
-    /*
-        render test to visualize BVH
-    */
+        // colliders whose spacial kept its pose keep their transform and leaf
+        if (collider_update(id)) {
+            state.updated.push_back(id);
+        }
 
+    }
+}
 
+void collider_build_bvh() {
+    PROFILE_SCOPE(PROFILE_ZONE_BROADPHASE);
+    PsxColliderState& state = collider_state();
 
-    for (int i = 0; i < g_next_collider; ++i) {
-        PsxCollider& fc = collider_get(i);
+    const PsxSpacialStreams& st = spacial_streams();
 
-        #if CFG_FILL_ON_COLLIDE
+    // refit moved colliders, only the ones that left their fat box are reinserted
+    for (Inst id : state.updated) {
+        PsxCollider& c = state.colliders[id];
+        U32 slot = spacial_get_info(c.spacial).slot;
 
-        if (fc.phase & COLLIDER_PHASE_RESOLVE) {
-            shape_draw_fill();
-        } else {
-            shape_draw_lines();
+        if (bvh_move(c.bvh_leaf, c.bounding_box, st.pos[slot] - st.prev_pos[slot])) {
+            PROFILE_COUNT(PROFILE_COUNTER_BVH_MOVES, 1);
         }
-
-        #endif
-
-        collider_draw(i);
     }
 }
 
-void collider_filter_updated() {
-    g_updated_collider_count = 0;
-    for (int i = 0; i < g_next_collider; ++i) {
-
-        // run sanity check on collider
-        PsxCollider& c = collider_get(i);
-        if (c.shape == SHAPE_NONE) continue;
-        if (c.spacial == NO_INSTANCE) continue;
-        PsxSpacial& s = spacial_get(c.spacial);
-        if (!s.in_use) continue;
+void collider_rebuild_bvh(BvhBuildMode mode) {
+    PsxColliderState& state = collider_state();
 
-        c.phase = COLLIDER_PHASE_BROAD;
-        collider_update(i); // run update
+    thread_local std::vector<Inst> ids;
+    ids.clear();
 
-        g_updated_colliders[g_updated_collider_count++] = i;
+    for (U32 i = 0; i < state.colliders.count; ++i) {
+        PsxCollider& c = state.colliders[i];
+        if (c.bvh_leaf == NO_INSTANCE) continue;
 
+        ids.push_back(c.id);
     }
-}
 
-void collider_build_bvh() {
-    bvh_build(g_updated_colliders, g_updated_collider_count); // construct BVH
+    bvh_build(ids.data(), (U32) ids.size(), mode); // construct BVH
 }
 
-void collider_update(Inst collider) {
-    PsxCollider& c = collider_get(collider);
-    if (c.shape == SHAPE_NONE) return;
+void collider_rebuild_bvh() {
+    collider_rebuild_bvh(CFG_BVH_BUILD_MODE);
+}
 
-    PsxSpacial& s = spacial_get(c.spacial);
-    if (!s.in_use) return;
-    if (s.flags & SPACIAL_FLAG_STATIC) return;
+// transform and box of c with its spacial at body, children of a compound follow it
+static void collider_place(PsxCollider& c, Vec2 body, F32 ang, Vec2 rot) {
+    c.pose_pos = body;
+    c.pose_ang = ang;
 
-    Vec2 pos = collider_get_pos(collider);
+    Vec2 pos = body + vec2_rotate_by(c.offset, rot);
 
-    // recompute polygon
     if (c.shape == SHAPE_POLY) {
-        c.bounding_box = {
-            { F32_MAX, F32_MAX }, 
-            { -F32_MAX, -F32_MAX }
-        };
-
-        glx_transform_poly_2d(
-            pos, 
-            c.poly.transform, 
-            c.poly.identity, 
-            c.poly.count, 
-            c.poly.scale,
-            spacial_get_ang(c.spacial),
-            &c.bounding_box,
-            &c.poly.center
-        );
-
-        for (int i = 0; i < c.poly.count; ++i) {
-            const Vec2 p = c.poly.transform[i];
-
-            if (p.x < c.bounding_box.min.x) c.bounding_box.min.x = p.x;
-            if (p.y < c.bounding_box.min.y) c.bounding_box.min.y = p.y;
-            if (p.x > c.bounding_box.max.x) c.bounding_box.max.x = p.x;
-            if (p.y > c.bounding_box.max.y) c.bounding_box.max.y = p.y;
+        glx_transform_poly_2d(pos, c.poly.transform, c.poly.identity, c.poly.count, c.poly.scale, rot, c.bounding_box, c.poly.center);
+
+        // rotating a unit normal keeps it unit, no sqrt per edge
+        for (U32 i = 0; i < c.poly.count; ++i) {
+            c.poly.normals[i] = vec2_rotate_by(c.poly.local_normals[i], rot);
         }
     }
 
@@ -335,8 +618,56 @@ void collider_update(Inst collider) {
         c.bounding_box.min = pos - c.circ.radius;
         c.bounding_box.max = pos + c.circ.radius;
     }
+
+    if (c.shape == SHAPE_CAPSULE || c.shape == SHAPE_SEGMENT) {
+        collider_place_capsule(c, pos, rot);
+    }
+
+    // the local tree keeps its topology, only the boxes are refit
+    if (c.shape == SHAPE_COMPOUND) {
+        for (Inst child : bvh_local_colliders(c.comp.tree)) {
+            collider_place(collider_get(child), body, ang, rot);
+        }
+
+        collider_compound_refit(c);
+    }
+}
+
+bool collider_update(Inst collider) {
+    PsxCollider& c = collider_get(collider);
+    if (c.shape == SHAPE_NONE) return false;
+    if (c.moving_index == NO_INSTANCE) return false; // static, asleep or a compound child, the compound updates those
+
+    if (!spacial_valid(c.spacial)) return false;
+    const PsxSpacialInfo& info = spacial_get_info(c.spacial);
+
+    const PsxSpacialStreams& st = spacial_streams();
+    const U32 slot = info.slot;
+
+    if (st.flags[slot] & SPACIAL_FLAG_STATIC) return false;
+
+    // a resting body's colliders are where they were
+    Vec2 body = st.pos[slot];
+    F32 ang = st.ang[slot];
+    if (body.x == c.pose_pos.x && body.y == c.pose_pos.y && ang == c.pose_ang) return false;
+
+    // the rotation is computed once per spacial, not per collider
+    collider_place(c, body, ang, st.rot[slot]);
+
+    return true;
+}
+
+U32 count_collider_slots() {
+    return collider_state().colliders.count;
+}
+
+U64 collider_memory_bytes() {
+    PsxColliderState& state = collider_state();
+
+    return state.colliders.bytes() + arena_memory_bytes() +
+        (state.updated.capacity() + state.moving.capacity() + state.phased.capacity()) * sizeof(Inst);
 }
 
 U32 count_colliders() {
-    return g_updated_collider_count;
+    return collider_state().live_count;
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "psx_debug_draw.h"
+#include <vector>
+
+void collider_draw(Inst collider, F32 alpha) {
+    PsxCollider& c = collider_get(collider);
+    if (c.shape == SHAPE_NONE || c.spacial == NO_INSTANCE) return;
+
+    // pose between the last two steps, the transform still holds the pose the last step started from
+    Vec2 body = spacial_get_interpolated_pos(c.spacial, alpha);
+    F32 ang = spacial_get_interpolated_ang(c.spacial, alpha);
+
+    Vec2 pos = body + c.offset;
+    if (ang != 0.f) pos = vec2_rotate(pos, body, ang);
+
+    Color prev_color = shape_get_color();
+    GLXDrawMode prev_draw_mode = shape_get_draw_mode();
+
+    if (c.phase & COLLIDER_PHASE_RESOLVE) { // blue when resoliving
+        shape_color({64, 64, 255, 128});
+    }
+    else if (c.phase & COLLIDER_PHASE_NARROW) { // red when checking
+        shape_color({255, 64, 64, 128});
+    } 
+    else { // green when not colliding
+        shape_color({64, 255, 64, 128});
+    }
+
+    switch (c.shape) {
+        case (SHAPE_CIRCLE) : { 
+            shape_point(pos);
+            shape_circle(pos, c.circ.radius); 
+            break;
+        }
+        case (SHAPE_POLY) : { 
+            static std::vector<Vec2> vertices;
+            vertices.resize(c.poly.count);
+
+            Vec2 center;
+            glx_transform_poly_2d(pos, vertices.data(), c.poly.identity, c.poly.count, c.poly.scale, ang, nullptr, &center);
+
+            shape_point(center);
+            shape_polygon(vertices.data(), c.poly.count); 
+            break;
+        }
+        case (SHAPE_CAPSULE) :
+        case (SHAPE_SEGMENT) : {
+            Vec2 rot = vec2_rotation(ang);
+            Vec2 a = pos + vec2_rotate_by(c.caps.local[0], rot);
+            Vec2 b = pos + vec2_rotate_by(c.caps.local[1], rot);
+
+            F32 r = c.caps.radius;
+            if (r == 0.f) {
+                shape_line(a, b);
+                break;
+            }
+
+            // both sides and a circle at each end
+            Vec2 side = vec2_normal(vec2_perp(b - a)) * r;
+
+            shape_line(a + side, b + side);
+            shape_line(a - side, b - side);
+            shape_circle(a, r);
+            shape_circle(b, r);
+            break;
+        }
+        default : { break; }
+    }
+
+    #if CFG_RENDER_BOUNDING_BOX
+
+    shape_draw_lines();
+
+    shape_bounding_box(c.bounding_box);
+
+    #endif
+
+    shape_color(prev_color);
+    shape_draw_mode(prev_draw_mode);
+}
+
+//
+
+void collider_draw_all(F32 alpha) {
+    shape_draw_lines();
+
+    /*
+        render test to visualize BVH
+    */
+
+
+
+    for (U32 i = 0; i < count_collider_slots(); ++i) {
+        PsxCollider& fc = collider_get(collider_handle(i));
+
+        #if CFG_FILL_ON_COLLIDE
+
+        if (fc.phase & COLLIDER_PHASE_RESOLVE) {
+            shape_draw_fill();
+        } else {
+            shape_draw_lines();
+        }
+
+        #endif
+
+        collider_draw(collider_handle(i), alpha);
+    }
+}
+
+void manifolds_render() {
+    #if CFG_MANIFOLDS_RENDER
+
+    for (U32 i = 0; i < count_manifold_slots(); ++i) {
+        const PsxManifold& m = manifold_get(manifold_handle(i));
+        if (!m.in_use) continue;
+
+        // render contact points
+        for (U32 c = 0; c < m.contact_count; ++c) {
+            shape_point(m.contacts[c].point);
+        }
+
+        const PsxCollider& collider_a = collider_get(m.collider_a);
+        const PsxCollider& collider_b = collider_get(m.collider_b);
+
+        // render normals
+        Vec2 pos_a, pos_b;
+        if (collider_a.shape == SHAPE_POLY) {
+            pos_a = collider_a.poly.center;
+        } else {
+            pos_a = collider_get_pos(collider_a);
+        }
+
+        if (collider_b.shape == SHAPE_POLY) {
+            pos_b = collider_b.poly.center;
+        } else {
+            pos_b = collider_get_pos(collider_b);
+        }
+
+        shape_line(pos_a, pos_a + (m.normal * 5));
+        shape_line(pos_b, pos_b - (m.normal * 5));
+    }
+
+    #endif
+}
+
+static void bvh_render_node(U32 node_id) {
+    if (node_id == NO_INSTANCE) return;
+    const BvhNode& n = bvh_get_node(node_id);
+
+    shape_bounding_box(n.box);
+
+    if (bvh_is_leaf(n)) return;
+
+    if (n.child1 != NO_INSTANCE) bvh_render_node(n.child1);
+    if (n.child2 != NO_INSTANCE) bvh_render_node(n.child2);
+}
+
+void bvh_render() {
+    #if CFG_RENDER_BVH
+
+    if (bvh_get_root() != NO_INSTANCE) {
+        bvh_render_node(bvh_get_root());
+    }
+
+    #endif
+}
+
+void spacial_render() {
+
+    #if CFG_RENDER_FORCES
+
+    for (U32 i = 0; i < count_spacial_slots(); ++i) {
+        const PsxSpacial spacial = spacial_get(spacial_handle(i));
+        if (!spacial.in_use) continue;
+
+        shape_line(spacial.pos, spacial.pos + spacial.vel / 50.f);
+
+        // printf("%.4f %.4f %.4f %.4f\n", spacial.pos.x, spacial.pos.y, spacial.vel.x, spacial.vel.y);
+    }
+
+    #endif
+
+}
@@ -0,0 +1,680 @@
+#include "psx_island.h"
+#include "psx_spacial.h"
+#include "psx_collider.h"
+#include "psx_manifold.h"
+#include "psx_profile.h"
+#include "psx_pool.h"
+#include "psx_job.h"
+#include "psx_kernel.h"
+#include "psx_world.h"
+#include <vector>
+
+// bodies and manifolds of a sleeping island, handles so freed ones can be skipped on wake
+struct PsxIsland {
+    std::vector<Inst> spacials;
+    std::vector<Inst> manifolds;
+    bool in_use;
+};
+
+// storage of the kernel contact rows, one per colored manifold
+struct PsxIslandRows {
+    std::vector<U32> body_a, body_b, block;
+    std::vector<F32> normal_x, normal_y, tangent_x, tangent_y, friction;
+    std::vector<F32> inv_mass_a, inv_mass_b, inv_inertia_a, inv_inertia_b;
+    std::vector<F32> k11, k12, k22, inv_k11, inv_k12, inv_k22;
+
+    std::vector<F32> ra_x[2], ra_y[2], rb_x[2], rb_y[2];
+    std::vector<F32> normal_mass[2], tangent_mass[2], bias[2];
+    std::vector<F32> normal_impulse[2], tangent_impulse[2];
+};
+
+struct PsxIslandState {
+    PsxPool<PsxIsland> sleeping;
+    U32 sleeping_count = 0;
+
+    // union find over the awake slots
+    std::vector<U32> parent;
+
+    // awake islands, island_of maps an awake slot to its island
+    std::vector<U32> island_of;
+    std::vector<U32> body_start;
+    std::vector<U32> bodies;
+    std::vector<U32> manifold_start;
+    std::vector<Inst> manifolds;
+    U32 count = 0;
+
+    // scratch
+    std::vector<Inst> edges;      // awake manifolds
+    std::vector<U32> edge_slots;  // awake body of each edge
+    std::vector<Inst> wake;
+    std::vector<F32> min_time;
+    std::vector<Inst> manifolds_scratch;
+
+    // solver batches, batch i solves islands [batch_start[i], batch_start[i + 1])
+    std::vector<U32> batch_start;
+    F32 solve_inv_dt;
+    U32 solve_iterations;
+
+    /*
+        colored solver for islands of at least CFG_SOLVER_COLOR_MIN manifolds.
+        their manifolds are sorted by color, no two manifolds of a color share
+        a dynamic body. the last color holds the ones that ran out of colors
+    */
+    std::vector<Inst> colored;
+    std::vector<U32> colors;        // color of each manifold before the sort
+    std::vector<U32> color_start;   // color i is colored[color_start[i], color_start[i + 1])
+    std::vector<U64> body_colors;   // colors taken per awake slot
+    PsxIslandRows rows;
+    PsxKernelContacts kernel;
+};
+
+static PsxIslandState& island_state() {
+    return *world_current()->island;
+}
+
+PsxIslandState* island_state_new() {
+    return new PsxIslandState();
+}
+
+void island_state_free(PsxIslandState* state) {
+    state->sleeping.release();
+    delete state;
+}
+
+/*
+    sleeping islands
+*/
+
+static void island_wake_record(Inst island) {
+    PsxIslandState& state = island_state();
+
+    if (!state.sleeping.valid(island)) return;
+
+    PsxIsland& record = state.sleeping[island];
+    if (!record.in_use) return;
+
+    for (Inst h : record.manifolds) {
+        if (!manifold_valid(h)) continue;
+
+        PsxManifold& m = manifold_get(h);
+        if (m.in_use) m.sleeping = false;
+    }
+
+    for (Inst h : record.spacials) {
+        if (!spacial_valid(h)) continue;
+
+        // the slot may have been freed and handed out again while asleep
+        PsxSpacialInfo& info = spacial_get_info(h);
+        if (info.island != island) continue;
+
+        spacial_set_sleeping(h, NO_INSTANCE);
+
+        for (Inst c = info.collider; c != NO_INSTANCE; c = collider_get(c).next) {
+            collider_set_sleeping(collider_get(c), false);
+        }
+    }
+
+    record.spacials.clear();
+    record.manifolds.clear();
+    record.in_use = false;
+
+    state.sleeping.free(island);
+    state.sleeping_count--;
+}
+
+bool island_wake(Inst spacial) {
+    if (!spacial_valid(spacial)) return false;
+
+    PsxSpacialInfo& info = spacial_get_info(spacial);
+
+    if (info.island == NO_INSTANCE) {
+        spacial_streams().sleep_time[info.slot] = 0.f;
+        return false;
+    }
+
+    island_wake_record(info.island);
+    return true;
+}
+
+/*
+    awake islands
+*/
+
+static U32 island_find(std::vector<U32>& parent, U32 slot) {
+    while (parent[slot] != slot) {
+        parent[slot] = parent[parent[slot]];
+        slot = parent[slot];
+    }
+
+    return slot;
+}
+
+// the lower slot becomes the root so the numbering only depends on the slots
+static void island_union(std::vector<U32>& parent, U32 a, U32 b) {
+    a = island_find(parent, a);
+    b = island_find(parent, b);
+
+    if (a < b) parent[b] = a;
+    else       parent[a] = b;
+}
+
+void islands_build() {
+    PROFILE_SCOPE(PROFILE_ZONE_ISLANDS);
+    PsxIslandState& state = island_state();
+
+    U32 manifold_slots = count_manifold_slots();
+
+    // awake bodies touching sleeping ones wake their island
+    if (state.sleeping_count) {
+        state.wake.clear();
+
+        for (U32 i = 0; i < manifold_slots; ++i) {
+            const PsxManifold& m = manifold_get(manifold_handle(i));
+            if (!m.in_use || m.sleeping) continue;
+
+            Inst a = spacial_get_info(m.spacial_a).island;
+            Inst b = spacial_get_info(m.spacial_b).island;
+
+            if (a != NO_INSTANCE) state.wake.push_back(a);
+            if (b != NO_INSTANCE) state.wake.push_back(b);
+        }
+
+        for (Inst island : state.wake) {
+            island_wake_record(island);
+        }
+    }
+
+    const PsxSpacialStreams& st = spacial_streams();
+    U32 awake = st.awake_count;
+
+    state.parent.resize(awake);
+    for (U32 i = 0; i < awake; ++i) state.parent[i] = i;
+
+    // join the awake bodies of every awake manifold
+    state.edges.clear();
+    state.edge_slots.clear();
+
+    for (U32 i = 0; i < manifold_slots; ++i) {
+        const PsxManifold& m = manifold_get(manifold_handle(i));
+        if (!m.in_use || m.sleeping) continue;
+
+        const PsxSpacialInfo& a = spacial_get_info(m.spacial_a);
+        const PsxSpacialInfo& b = spacial_get_info(m.spacial_b);
+
+        if (a.awake && b.awake) {
+            island_union(state.parent, a.slot, b.slot);
+        }
+
+        if (a.awake || b.awake) {
+            state.edges.push_back(m.index);
+            state.edge_slots.push_back(a.awake ? a.slot : b.slot);
+        }
+    }
+
+    // number the islands in slot order
+    state.island_of.assign(awake, NO_INSTANCE);
+    state.count = 0;
+
+    for (U32 i = 0; i < awake; ++i) {
+        U32 root = island_find(state.parent, i);
+
+        if (state.island_of[root] == NO_INSTANCE) {
+            state.island_of[root] = state.count++;
+        }
+
+        state.island_of[i] = state.island_of[root];
+    }
+
+    // bucket bodies and manifolds per island, both keep their order inside an island
+    U32 edge_count = (U32) state.edges.size();
+
+    state.body_start.assign(state.count + 1, 0);
+    state.manifold_start.assign(state.count + 1, 0);
+    state.bodies.resize(awake);
+    state.manifolds.resize(edge_count);
+
+    for (U32 i = 0; i < awake; ++i)      state.body_start[state.island_of[i] + 1]++;
+    for (U32 e = 0; e < edge_count; ++e) state.manifold_start[state.island_of[state.edge_slots[e]] + 1]++;
+
+    for (U32 i = 0; i < state.count; ++i) {
+        state.body_start[i + 1] += state.body_start[i];
+        state.manifold_start[i + 1] += state.manifold_start[i];
+    }
+
+    // the starts are used as cursors and shifted back after
+    for (U32 i = 0; i < awake; ++i) {
+        state.bodies[state.body_start[state.island_of[i]]++] = i;
+    }
+
+    for (U32 e = 0; e < edge_count; ++e) {
+        state.manifolds[state.manifold_start[state.island_of[state.edge_slots[e]]]++] = state.edges[e];
+    }
+
+    for (U32 i = state.count; i > 0; --i) {
+        state.body_start[i] = state.body_start[i - 1];
+        state.manifold_start[i] = state.manifold_start[i - 1];
+    }
+
+    state.body_start[0] = 0;
+    state.manifold_start[0] = 0;
+}
+
+/*
+    island solver. a batch runs the same prestep pass and velocity
+    iterations as manifolds_solve over its own manifolds, in slot order.
+    no dynamic body is in two islands and static bodies are never written,
+    so batches can run on any thread in any order and every body ends up
+    with the same velocities manifolds_solve would give it
+*/
+
+static bool island_is_large(const PsxIslandState& state, U32 island) {
+    return state.manifold_start[island + 1] - state.manifold_start[island] >= CFG_SOLVER_COLOR_MIN;
+}
+
+static void island_solve_task(void* data, U32 index, U32 thread) {
+    PROFILE_SCOPE(PROFILE_ZONE_SOLVE_TASK);
+    const PsxIslandState& state = *(const PsxIslandState*) data;
+    (void) thread;
+
+    thread_local std::vector<PsxManifold*> manifolds;
+    manifolds.clear();
+
+    for (U32 island = state.batch_start[index]; island < state.batch_start[index + 1]; ++island) {
+        if (island_is_large(state, island)) continue;
+
+        for (U32 i = state.manifold_start[island]; i < state.manifold_start[island + 1]; ++i) {
+            PsxManifold& m = manifold_get(state.manifolds[i]);
+            manifold_prestep(m, state.solve_inv_dt);
+            manifolds.push_back(&m);
+        }
+    }
+
+    for (U32 it = 0; it < state.solve_iterations; ++it) {
+        for (PsxManifold* m : manifolds) {
+            manifold_solve(*m);
+        }
+    }
+}
+
+/*
+    graph colored solver. one pile is one island, so the island solver can't
+    share it between threads. its manifolds are colored greedily in slot
+    order, each color is prestepped and then solved a few rows per SIMD
+    lane group and a chunk of rows per task, the colors one after another.
+    the coloring doesn't depend on the thread count and chunks start on a
+    multiple of 8 rows, so the result doesn't either. the order differs from
+    manifolds_solve, the result is not the same as the serial solver's
+*/
+
+static void island_rows_resize(PsxIslandRows& r, U32 count) {
+    for (std::vector<U32>* v : { &r.body_a, &r.body_b, &r.block }) v->resize(count);
+
+    for (std::vector<F32>* v : {
+        &r.normal_x, &r.normal_y, &r.tangent_x, &r.tangent_y, &r.friction,
+        &r.inv_mass_a, &r.inv_mass_b, &r.inv_inertia_a, &r.inv_inertia_b,
+        &r.k11, &r.k12, &r.k22, &r.inv_k11, &r.inv_k12, &r.inv_k22 }) v->resize(count);
+
+    for (U32 p = 0; p < 2; ++p) {
+        for (std::vector<F32>* v : {
+            &r.ra_x[p], &r.ra_y[p], &r.rb_x[p], &r.rb_y[p],
+            &r.normal_mass[p], &r.tangent_mass[p], &r.bias[p],
+            &r.normal_impulse[p], &r.tangent_impulse[p] }) v->resize(count);
+    }
+}
+
+static PsxKernelContacts island_rows_kernel(PsxIslandRows& r) {
+    PsxSpacialStreams& st = spacial_streams();
+
+    PsxKernelContacts c = {};
+
+    c.vel = st.vel;
+    c.ang_vel = st.ang_vel;
+
+    c.body_a = r.body_a.data();
+    c.body_b = r.body_b.data();
+
+    c.normal_x = r.normal_x.data();
+    c.normal_y = r.normal_y.data();
+    c.tangent_x = r.tangent_x.data();
+    c.tangent_y = r.tangent_y.data();
+    c.friction = r.friction.data();
+
+    c.inv_mass_a = r.inv_mass_a.data();
+    c.inv_mass_b = r.inv_mass_b.data();
+    c.inv_inertia_a = r.inv_inertia_a.data();
+    c.inv_inertia_b = r.inv_inertia_b.data();
+
+    c.block = r.block.data();
+    c.k11 = r.k11.data();
+    c.k12 = r.k12.data();
+    c.k22 = r.k22.data();
+    c.inv_k11 = r.inv_k11.data();
+    c.inv_k12 = r.inv_k12.data();
+    c.inv_k22 = r.inv_k22.data();
+
+    for (U32 p = 0; p < 2; ++p) {
+        c.ra_x[p] = r.ra_x[p].data();
+        c.ra_y[p] = r.ra_y[p].data();
+        c.rb_x[p] = r.rb_x[p].data();
+        c.rb_y[p] = r.rb_y[p].data();
+        c.normal_mass[p] = r.normal_mass[p].data();
+        c.tangent_mass[p] = r.tangent_mass[p].data();
+        c.bias[p] = r.bias[p].data();
+        c.normal_impulse[p] = r.normal_impulse[p].data();
+        c.tangent_impulse[p] = r.tangent_impulse[p].data();
+    }
+
+    return c;
+}
+
+// prestep the manifold of row j and copy it into the row, inactive manifolds get a row that changes nothing
+static void island_pack_row(PsxIslandState& state, U32 j) {
+    PsxManifold& m = manifold_get(state.colored[j]);
+    PsxIslandRows& r = state.rows;
+
+    manifold_prestep(m, state.solve_inv_dt);
+
+    r.body_a[j] = spacial_get_info(m.spacial_a).slot;
+    r.body_b[j] = spacial_get_info(m.spacial_b).slot;
+
+    bool active = m.active;
+    U32 count = active ? m.contact_count : 0;
+
+    r.normal_x[j] = m.normal.x;
+    r.normal_y[j] = m.normal.y;
+    r.tangent_x[j] = m.tangent.x;
+    r.tangent_y[j] = m.tangent.y;
+    r.friction[j] = active ? m.friction : 0.f;
+
+    r.inv_mass_a[j] = active ? m.inv_mass_a : 0.f;
+    r.inv_mass_b[j] = active ? m.inv_mass_b : 0.f;
+    r.inv_inertia_a[j] = active ? m.inv_inertia_a : 0.f;
+    r.inv_inertia_b[j] = active ? m.inv_inertia_b : 0.f;
+
+    r.block[j] = active && m.block;
+    r.k11[j] = r.block[j] ? m.k11 : 0.f;
+    r.k12[j] = r.block[j] ? m.k12 : 0.f;
+    r.k22[j] = r.block[j] ? m.k22 : 0.f;
+    r.inv_k11[j] = r.block[j] ? m.inv_k11 : 0.f;
+    r.inv_k12[j] = r.block[j] ? m.inv_k12 : 0.f;
+    r.inv_k22[j] = r.block[j] ? m.inv_k22 : 0.f;
+
+    for (U32 p = 0; p < 2; ++p) {
+        const PsxContact* c = p < count ? &m.contacts[p] : nullptr;
+
+        r.ra_x[p][j] = c ? c->ra.x : 0.f;
+        r.ra_y[p][j] = c ? c->ra.y : 0.f;
+        r.rb_x[p][j] = c ? c->rb.x : 0.f;
+        r.rb_y[p][j] = c ? c->rb.y : 0.f;
+        r.normal_mass[p][j] = c ? c->normal_mass : 0.f;
+        r.tangent_mass[p][j] = c ? c->tangent_mass : 0.f;
+        r.bias[p][j] = c ? c->bias : 0.f;
+        r.normal_impulse[p][j] = c ? c->normal_impulse : 0.f;
+        r.tangent_impulse[p][j] = c ? c->tangent_impulse : 0.f;
+    }
+}
+
+// color the manifolds of the large islands, returns false if there are none
+static bool island_color(PsxIslandState& state) {
+    state.colored.clear();
+    state.colors.clear();
+    state.body_colors.resize(state.island_of.size());
+
+    for (U32 island = 0; island < state.count; ++island) {
+        if (!island_is_large(state, island)) continue;
+
+        for (U32 b = state.body_start[island]; b < state.body_start[island + 1]; ++b) {
+            state.body_colors[state.bodies[b]] = 0;
+        }
+
+        for (U32 i = state.manifold_start[island]; i < state.manifold_start[island + 1]; ++i) {
+            const PsxManifold& m = manifold_get(state.manifolds[i]);
+            const PsxSpacialInfo& a = spacial_get_info(m.spacial_a);
+            const PsxSpacialInfo& b = spacial_get_info(m.spacial_b);
+
+            // static bodies are never written, they don't take colors
+            U64 taken = (a.awake ? state.body_colors[a.slot] : 0) | (b.awake ? state.body_colors[b.slot] : 0);
+
+            U32 color = 0;
+            while (color < 64 && (taken & (1ull << color))) color++;
+
+            if (color < 64) {
+                if (a.awake) state.body_colors[a.slot] |= 1ull << color;
+                if (b.awake) state.body_colors[b.slot] |= 1ull << color;
+            }
+
+            state.colored.push_back(state.manifolds[i]);
+            state.colors.push_back(color);
+        }
+    }
+
+    U32 count = (U32) state.colored.size();
+    if (count == 0) return false;
+
+    // sort by color, manifolds keep their slot order inside a color
+    state.color_start.assign(66, 0);
+    for (U32 color : state.colors) state.color_start[color + 1]++;
+    for (U32 c = 0; c < 65; ++c) state.color_start[c + 1] += state.color_start[c];
+
+    state.batch_start.assign(state.color_start.begin(), state.color_start.end() - 1);
+    state.manifolds_scratch.resize(count);
+
+    for (U32 i = 0; i < count; ++i) {
+        state.manifolds_scratch[state.batch_start[state.colors[i]]++] = state.colored[i];
+    }
+
+    state.colored.swap(state.manifolds_scratch);
+    return true;
+}
+
+struct IslandColorTask {
+    PsxIslandState* state;
+    U32 begin;
+    U32 end;
+    U32 chunk;
+    bool prestep;
+};
+
+static void island_color_task(void* data, U32 index, U32 thread) {
+    PROFILE_SCOPE(PROFILE_ZONE_SOLVE_TASK);
+    const IslandColorTask& task = *(const IslandColorTask*) data;
+    PsxIslandState& state = *task.state;
+    (void) thread;
+
+    U32 begin = task.begin + index * task.chunk;
+    U32 end = (begin + task.chunk < task.end) ? begin + task.chunk : task.end;
+
+    if (task.prestep) {
+        for (U32 j = begin; j < end; ++j) island_pack_row(state, j);
+    } else {
+        kernel_solve_contacts(state.kernel, begin, end);
+    }
+}
+
+// one pass over every color, prestep or a velocity iteration
+static void island_color_pass(PsxIslandState& state, bool prestep) {
+    U32 threads = job_thread_count();
+
+    for (U32 color = 0; color < 64; ++color) {
+        U32 begin = state.color_start[color];
+        U32 end = state.color_start[color + 1];
+        if (begin == end) continue;
+
+        // chunks are whole groups of 8 rows so the lane groups don't move with the thread count
+        U32 rows = end - begin;
+        U32 tasks = (rows + CFG_SOLVER_COLOR_CHUNK - 1) / CFG_SOLVER_COLOR_CHUNK;
+        if (tasks > threads) tasks = threads;
+
+        U32 chunk = (rows + tasks - 1) / tasks;
+        chunk = (chunk + 7) & ~7u;
+        tasks = (rows + chunk - 1) / chunk;
+
+        IslandColorTask task = { &state, begin, end, chunk, prestep };
+        job_parallel_for(tasks, island_color_task, &task);
+    }
+
+    // manifolds that ran out of colors may share bodies, one at a time
+    for (U32 j = state.color_start[64]; j < state.color_start[65]; ++j) {
+        if (prestep) island_pack_row(state, j);
+        else         kernel_solve_contacts(state.kernel, j, j + 1);
+    }
+}
+
+static void island_solve_colored(PsxIslandState& state) {
+    if (!island_color(state)) return;
+
+    island_rows_resize(state.rows, (U32) state.colored.size());
+    state.kernel = island_rows_kernel(state.rows);
+
+    island_color_pass(state, true);
+
+    for (U32 it = 0; it < state.solve_iterations; ++it) {
+        island_color_pass(state, false);
+    }
+
+    // hand the impulses back to the manifolds to warm start the next step
+    for (U32 j = 0; j < (U32) state.colored.size(); ++j) {
+        PsxManifold& m = manifold_get(state.colored[j]);
+        if (!m.active) continue;
+
+        for (U32 p = 0; p < m.contact_count; ++p) {
+            m.contacts[p].normal_impulse = state.rows.normal_impulse[p][j];
+            m.contacts[p].tangent_impulse = state.rows.tangent_impulse[p][j];
+        }
+    }
+}
+
+void islands_solve(F32 dt, U32 iterations) {
+    PROFILE_SCOPE(PROFILE_ZONE_SOLVE);
+    PsxIslandState& state = island_state();
+
+    if (state.count == 0) return;
+
+    state.solve_inv_dt = dt > 0.f ? 1.f / dt : 0.f;
+    state.solve_iterations = iterations;
+
+    // cut the islands into batches of about the same number of manifolds
+    U32 total = state.manifold_start[state.count];
+    U32 target = total / (job_thread_count() * CFG_ISLAND_TASKS_PER_THREAD);
+    if (target == 0) target = 1;
+
+    state.batch_start.clear();
+    state.batch_start.push_back(0);
+
+    U32 cost = 0;
+    for (U32 i = 0; i < state.count; ++i) {
+        if (!island_is_large(state, i)) cost += state.manifold_start[i + 1] - state.manifold_start[i];
+
+        if (cost >= target) {
+            state.batch_start.push_back(i + 1);
+            cost = 0;
+        }
+    }
+
+    if (state.batch_start.back() != state.count) {
+        state.batch_start.push_back(state.count);
+    }
+
+    job_parallel_for((U32) state.batch_start.size() - 1, island_solve_task, &state);
+
+    island_solve_colored(state);
+}
+
+void islands_solve(F32 dt) {
+    islands_solve(dt, CFG_SOLVER_ITERATIONS);
+}
+
+void islands_sleep(F32 dt) {
+    PROFILE_SCOPE(PROFILE_ZONE_ISLANDS);
+    PsxIslandState& state = island_state();
+
+    if (!CFG_SLEEP) return;
+
+    PsxSpacialStreams& st = spacial_streams();
+    U32 awake = (U32) state.island_of.size();
+
+    // islands_build ran this step, the awake range has not changed since
+    if (awake != st.awake_count) return;
+
+    const F32 linear_sq  = CFG_SLEEP_LINEAR * CFG_SLEEP_LINEAR;
+    const F32 angular_sq = CFG_SLEEP_ANGULAR * CFG_SLEEP_ANGULAR;
+
+    state.min_time.assign(state.count, F32_MAX);
+
+    for (U32 i = 0; i < awake; ++i) {
+        bool resting = !(st.flags[i] & SPACIAL_FLAG_NO_SLEEP) &&
+            vec2_length_sq(st.vel[i]) < linear_sq &&
+            st.ang_vel[i] * st.ang_vel[i] < angular_sq;
+
+        st.sleep_time[i] = resting ? st.sleep_time[i] + dt : 0.f;
+
+        F32& min_time = state.min_time[state.island_of[i]];
+        if (st.sleep_time[i] < min_time) min_time = st.sleep_time[i];
+    }
+
+    // record every resting island first, putting bodies to sleep moves slots
+    state.wake.clear();
+
+    for (U32 island = 0; island < state.count; ++island) {
+        if (state.min_time[island] < CFG_SLEEP_TIME) continue;
+
+        U32 slot = state.sleeping.alloc();
+        Inst handle = state.sleeping.handle(slot);
+        PsxIsland& record = state.sleeping[slot];
+
+        record.in_use = true;
+        record.spacials.clear();
+        record.manifolds.clear();
+
+        for (U32 b = state.body_start[island]; b < state.body_start[island + 1]; ++b) {
+            record.spacials.push_back(st.owner[state.bodies[b]]);
+        }
+
+        for (U32 m = state.manifold_start[island]; m < state.manifold_start[island + 1]; ++m) {
+            record.manifolds.push_back(state.manifolds[m]);
+        }
+
+        state.wake.push_back(handle);
+        state.sleeping_count++;
+    }
+
+    for (Inst island : state.wake) {
+        PsxIsland& record = state.sleeping[island];
+
+        for (Inst h : record.manifolds) {
+            manifold_get(h).sleeping = true;
+        }
+
+        for (Inst h : record.spacials) {
+            const PsxSpacialInfo& info = spacial_get_info(h);
+
+            for (Inst c = info.collider; c != NO_INSTANCE; c = collider_get(c).next) {
+                collider_set_sleeping(collider_get(c), true);
+            }
+
+            spacial_set_sleeping(h, island);
+        }
+    }
+
+    // slots moved, the awake islands are rebuilt next step
+    if (!state.wake.empty()) {
+        state.count = 0;
+        state.island_of.clear();
+    }
+}
+
+PsxIslandList island_list() {
+    PsxIslandState& state = island_state();
+
+    return {
+        .body_start = state.body_start.data(),
+        .bodies = state.bodies.data(),
+        .manifold_start = state.manifold_start.data(),
+        .manifolds = state.manifolds.data(),
+        .count = state.count,
+    };
+}
+
+U32 count_sleeping_islands() {
+    return island_state().sleeping_count;
+}
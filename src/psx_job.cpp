@@ -0,0 +1,194 @@
+#include "psx_job.h"
+#include "psx_world.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+
+struct JobQueue {
+    std::mutex lock;
+    std::vector<U32> tasks;
+    U32 head = 0; // tasks before head have been stolen
+};
+
+static std::vector<std::thread> g_job_workers;
+static JobQueue* g_job_queues = nullptr;
+static std::atomic<U32> g_job_thread_count { 0 };
+
+// the pool starts lazily from whichever world's thread steps first
+static std::mutex g_job_init_lock;
+
+// current batch
+static PsxJobFn g_job_fn = nullptr;
+static void* g_job_data = nullptr;
+static PsxWorld* g_job_world = nullptr; // world of the caller, workers run on it
+static std::atomic<U32> g_job_remaining { 0 };
+
+// worker wake up
+static std::mutex g_job_lock;
+static std::condition_variable g_job_wake;
+static U32 g_job_generation = 0;
+static bool g_job_quit = false;
+
+// one batch at a time, other callers run inline
+static std::mutex g_job_batch_lock;
+
+static bool job_pop(U32 thread, U32& task) {
+    JobQueue& own = g_job_queues[thread];
+
+    // own queue from the back
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.tasks.size() > own.head) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // steal from the front of the others
+    U32 thread_count = g_job_thread_count.load(std::memory_order_acquire);
+    for (U32 i = 1; i < thread_count; ++i) {
+        JobQueue& other = g_job_queues[(thread + i) % thread_count];
+
+        std::lock_guard<std::mutex> guard(other.lock);
+        if (other.tasks.size() > other.head) {
+            task = other.tasks[other.head++];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void job_drain(U32 thread) {
+    U32 task;
+
+    while (job_pop(thread, task)) {
+        if (thread) world_bind(g_job_world);
+        g_job_fn(g_job_data, task, thread);
+        g_job_remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+static void job_worker(U32 thread) {
+    U32 seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(g_job_lock);
+            g_job_wake.wait(guard, [&]() { return g_job_quit || g_job_generation != seen; });
+
+            if (g_job_quit) return;
+            seen = g_job_generation;
+        }
+
+        job_drain(thread);
+    }
+}
+
+void job_init(U32 thread_count) {
+    std::lock_guard<std::mutex> init(g_job_init_lock);
+    if (g_job_thread_count.load(std::memory_order_acquire)) return;
+
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+
+    if (thread_count == 0) thread_count = 1;
+
+    g_job_queues = new JobQueue[thread_count];
+    g_job_quit = false;
+
+    // published last, the queues are in place before anyone sees the count
+    g_job_thread_count.store(thread_count, std::memory_order_release);
+
+    // thread 0 is whoever calls job_parallel_for
+    for (U32 i = 1; i < thread_count; ++i) {
+        g_job_workers.emplace_back(job_worker, i);
+    }
+
+    // workers have to be joined before the statics they wait on are destroyed
+    static bool registered = false;
+    if (!registered) {
+        atexit(job_shutdown);
+        registered = true;
+    }
+}
+
+void job_shutdown() {
+    std::lock_guard<std::mutex> init(g_job_init_lock);
+    if (!g_job_thread_count.load(std::memory_order_acquire)) return;
+
+    {
+        std::lock_guard<std::mutex> guard(g_job_lock);
+        g_job_quit = true;
+    }
+    g_job_wake.notify_all();
+
+    for (std::thread& worker : g_job_workers) {
+        worker.join();
+    }
+
+    g_job_workers.clear();
+    delete[] g_job_queues;
+    g_job_queues = nullptr;
+    g_job_thread_count.store(0, std::memory_order_release);
+}
+
+U32 job_thread_count() {
+    U32 thread_count = g_job_thread_count.load(std::memory_order_acquire);
+    if (thread_count) return thread_count;
+
+    job_init();
+    return g_job_thread_count.load(std::memory_order_acquire);
+}
+
+void job_parallel_for(U32 count, PsxJobFn fn, void* data) {
+    if (count == 0) return;
+    U32 thread_count = job_thread_count();
+
+    // nothing to share or the pool is busy with another caller
+    std::unique_lock<std::mutex> batch(g_job_batch_lock, std::try_to_lock);
+    if (thread_count == 1 || count == 1 || !batch.owns_lock()) {
+        for (U32 i = 0; i < count; ++i) {
+            fn(data, i, 0);
+        }
+        return;
+    }
+
+    g_job_fn = fn;
+    g_job_data = data;
+    g_job_world = world_current();
+    g_job_remaining.store(count, std::memory_order_release);
+
+    // contiguous ranges per thread, popped from the back and stolen from the front
+    for (U32 t = 0; t < thread_count; ++t) {
+        JobQueue& q = g_job_queues[t];
+        U32 begin = (U32) (((uint64_t) count * t) / thread_count);
+        U32 end   = (U32) (((uint64_t) count * (t + 1)) / thread_count);
+
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.tasks.clear();
+        q.head = 0;
+
+        for (U32 i = end; i > begin; --i) {
+            q.tasks.push_back(i - 1);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(g_job_lock);
+        g_job_generation++;
+    }
+    g_job_wake.notify_all();
+
+    job_drain(0);
+
+    // wait for tasks other threads are still running
+    while (g_job_remaining.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,902 @@
+#include "psx_kernel.h"
+#include "psx_spacial.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PSX_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define PSX_KERNEL_X86 0
+#endif
+
+// avx2 kernels are compiled for avx2 without raising the baseline for the whole build
+#if defined(__GNUC__)
+#define PSX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PSX_TARGET_AVX2
+#endif
+
+static PsxKernelIsa g_kernel_isa = kernel_detect_isa();
+
+PsxKernelStep kernel_make_step(F32 dt, F32 gravity) {
+    return {
+        .dt = dt,
+        .gravity = gravity,
+        .drag = expf(-CFG_DRAG_COEFFICIENT * dt),
+        .ang_drag = expf(-CFG_ANG_DRAG_COEFFICIENT * dt),
+    };
+}
+
+/*
+    scalar kernels, also used for the tail of the vector kernels
+*/
+
+static void integrate_velocities_scalar(const PsxKernelBodies& b, const PsxKernelStep& step, U32 begin) {
+    for (U32 i = begin; i < b.count; ++i) {
+        const bool dynamic = !(b.flags[i] & SPACIAL_FLAG_STATIC) && b.inv_mass[i] > 0.f;
+        const F32  grav    =  (b.flags[i] & SPACIAL_FLAG_NO_GRAV) ? 0.f : step.gravity;
+
+        if (dynamic) {
+            Vec2 acc = (b.force[i] * b.inv_mass[i]) + Vec2{ 0.f, grav };
+
+            b.vel[i]     = (b.vel[i] + acc * step.dt) * step.drag;
+            b.ang_vel[i] = (b.ang_vel[i] + b.torque[i] * step.dt) * step.ang_drag;
+        }
+
+        // Clear accumulated forces/torques
+        b.force[i]  = { 0, 0 };
+        b.torque[i] = 0.f;
+    }
+}
+
+static void integrate_positions_scalar(const PsxKernelBodies& b, F32 dt, U32 begin) {
+    for (U32 i = begin; i < b.count; ++i) {
+        const bool dynamic = !(b.flags[i] & SPACIAL_FLAG_STATIC) && b.inv_mass[i] > 0.f;
+
+        b.prev_pos[i] = b.pos[i];
+        b.prev_ang[i] = b.ang[i];
+
+        if (dynamic) {
+            b.pos[i] += b.vel[i] * dt;
+            b.ang[i] += b.ang_vel[i] * dt;
+        }
+    }
+}
+
+/*
+    scalar contact kernel, also used for the tail of the vector kernels. the
+    vector kernels do the same operations in the same order, a row gets the
+    same result whichever kernel solves it
+*/
+
+struct ContactVel {
+    F32 vax, vay, wa;
+    F32 vbx, vby, wb;
+};
+
+// velocity of b relative to a at point p, along d
+static inline F32 contact_rel_scalar(const PsxKernelContacts& c, U32 i, U32 p, const ContactVel& v, F32 dx, F32 dy) {
+    const F32 rvx = (v.vbx + -v.wb * c.rb_y[p][i]) - (v.vax + -v.wa * c.ra_y[p][i]);
+    const F32 rvy = (v.vby +  v.wb * c.rb_x[p][i]) - (v.vay +  v.wa * c.ra_x[p][i]);
+    return rvx * dx + rvy * dy;
+}
+
+static inline void contact_apply_scalar(const PsxKernelContacts& c, U32 i, U32 p, ContactVel& v, F32 px, F32 py) {
+    v.vax -= px * c.inv_mass_a[i];
+    v.vay -= py * c.inv_mass_a[i];
+    v.wa  -= (c.ra_x[p][i] * py - px * c.ra_y[p][i]) * c.inv_inertia_a[i];
+    v.vbx += px * c.inv_mass_b[i];
+    v.vby += py * c.inv_mass_b[i];
+    v.wb  += (c.rb_x[p][i] * py - px * c.rb_y[p][i]) * c.inv_inertia_b[i];
+}
+
+static inline void contact_block_scalar(const PsxKernelContacts& c, U32 i, ContactVel& v) {
+    const F32 nx = c.normal_x[i];
+    const F32 ny = c.normal_y[i];
+
+    const F32 a1 = c.normal_impulse[0][i];
+    const F32 a2 = c.normal_impulse[1][i];
+
+    const F32 vn1 = contact_rel_scalar(c, i, 0, v, nx, ny);
+    const F32 vn2 = contact_rel_scalar(c, i, 1, v, nx, ny);
+
+    const F32 b1 = (vn1 - c.bias[0][i]) - (c.k11[i] * a1 + c.k12[i] * a2);
+    const F32 b2 = (vn2 - c.bias[1][i]) - (c.k12[i] * a1 + c.k22[i] * a2);
+
+    F32 x1, x2;
+
+    do {
+        // both pushing
+        x1 = -(c.inv_k11[i] * b1 + c.inv_k12[i] * b2);
+        x2 = -(c.inv_k12[i] * b1 + c.inv_k22[i] * b2);
+        if (x1 >= 0.f && x2 >= 0.f) break;
+
+        // first only
+        x1 = -c.normal_mass[0][i] * b1;
+        x2 = 0.f;
+        if (x1 >= 0.f && c.k12[i] * x1 + b2 >= 0.f) break;
+
+        // second only
+        x1 = 0.f;
+        x2 = -c.normal_mass[1][i] * b2;
+        if (x2 >= 0.f && c.k12[i] * x2 + b1 >= 0.f) break;
+
+        // neither
+        x1 = 0.f;
+        x2 = 0.f;
+        if (b1 >= 0.f && b2 >= 0.f) break;
+
+        // no solution, keep the impulses from the last iteration
+        x1 = a1;
+        x2 = a2;
+    } while (0);
+
+    const F32 d1 = x1 - a1;
+    const F32 d2 = x2 - a2;
+    contact_apply_scalar(c, i, 0, v, nx * d1, ny * d1);
+    contact_apply_scalar(c, i, 1, v, nx * d2, ny * d2);
+
+    c.normal_impulse[0][i] = x1;
+    c.normal_impulse[1][i] = x2;
+}
+
+static void solve_contacts_scalar(const PsxKernelContacts& c, U32 begin, U32 end) {
+    for (U32 i = begin; i < end; ++i) {
+        const U32 a = c.body_a[i];
+        const U32 b = c.body_b[i];
+
+        ContactVel v = {
+            c.vel[a].x, c.vel[a].y, c.ang_vel[a],
+            c.vel[b].x, c.vel[b].y, c.ang_vel[b],
+        };
+
+        const F32 nx = c.normal_x[i];
+        const F32 ny = c.normal_y[i];
+        const F32 tx = c.tangent_x[i];
+        const F32 ty = c.tangent_y[i];
+
+        // friction first, bounded by the normal impulse of the last iteration
+        for (U32 p = 0; p < 2; ++p) {
+            const F32 vt = contact_rel_scalar(c, i, p, v, tx, ty);
+            const F32 lambda = -c.tangent_mass[p][i] * vt;
+            const F32 max_friction = c.friction[i] * c.normal_impulse[p][i];
+
+            const F32 old = c.tangent_impulse[p][i];
+            F32 next = old + lambda;
+            next = (next < -max_friction) ? -max_friction : (next > max_friction) ? max_friction : next;
+            c.tangent_impulse[p][i] = next;
+
+            const F32 d = next - old;
+            contact_apply_scalar(c, i, p, v, tx * d, ty * d);
+        }
+
+        if (c.block[i]) {
+            contact_block_scalar(c, i, v);
+        } else {
+            for (U32 p = 0; p < 2; ++p) {
+                const F32 vn = contact_rel_scalar(c, i, p, v, nx, ny);
+                const F32 lambda = c.normal_mass[p][i] * (c.bias[p][i] - vn);
+
+                const F32 old = c.normal_impulse[p][i];
+                F32 next = old + lambda;
+                next = (next > 0.f) ? next : 0.f;
+                c.normal_impulse[p][i] = next;
+
+                const F32 d = next - old;
+                contact_apply_scalar(c, i, p, v, nx * d, ny * d);
+            }
+        }
+
+        if (c.inv_mass_a[i] > 0.f) {
+            c.vel[a] = { v.vax, v.vay };
+            c.ang_vel[a] = v.wa;
+        }
+
+        if (c.inv_mass_b[i] > 0.f) {
+            c.vel[b] = { v.vbx, v.vby };
+            c.ang_vel[b] = v.wb;
+        }
+    }
+}
+
+static void collide_circles_scalar(const PsxKernelCircles& c, U32 begin) {
+    for (U32 i = begin; i < c.count; ++i) {
+        F32 dx = c.bx[i] - c.ax[i];
+        F32 dy = c.by[i] - c.ay[i];
+        F32 d2 = dx * dx + dy * dy;
+
+        c.dist_sq[i] = d2;
+        c.hit[i] = d2 < c.radius[i] * c.radius[i] ? ~0u : 0u;
+    }
+}
+
+#if PSX_KERNEL_X86
+
+/*
+    SSE kernels, 4 bodies per iteration. vec2 streams are interleaved so each
+    register holds 2 bodies and per body values are duplicated into lane pairs
+*/
+
+static inline __m128 sse_select(__m128 a, __m128 b, __m128 mask) {
+    return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+}
+
+// all lanes set where the body is dynamic
+static inline __m128 sse_dynamic_mask(const PsxKernelBodies& b, U32 i) {
+    const __m128i flags  = _mm_loadu_si128((const __m128i*) (b.flags + i));
+    const __m128i is_not_static = _mm_cmpeq_epi32(
+        _mm_and_si128(flags, _mm_set1_epi32(SPACIAL_FLAG_STATIC)), 
+        _mm_setzero_si128()
+    );
+
+    return _mm_and_ps(
+        _mm_castsi128_ps(is_not_static), 
+        _mm_cmpgt_ps(_mm_loadu_ps(b.inv_mass + i), _mm_setzero_ps())
+    );
+}
+
+static inline void sse_velocity_pair(
+    F32* vel, F32* force, __m128 inv_mass, __m128 dynamic, __m128 grav, 
+    __m128 dt, __m128 drag
+) {
+    const __m128 v = _mm_loadu_ps(vel);
+    const __m128 acc = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(force), inv_mass), grav);
+    const __m128 next = _mm_mul_ps(_mm_add_ps(v, _mm_mul_ps(acc, dt)), drag);
+
+    _mm_storeu_ps(vel, sse_select(v, next, dynamic));
+    _mm_storeu_ps(force, _mm_setzero_ps());
+}
+
+static void integrate_velocities_sse(const PsxKernelBodies& b, const PsxKernelStep& step) {
+    const __m128 dt       = _mm_set1_ps(step.dt);
+    const __m128 drag     = _mm_set1_ps(step.drag);
+    const __m128 ang_drag = _mm_set1_ps(step.ang_drag);
+    const __m128 grav     = _mm_setr_ps(0.f, step.gravity, 0.f, step.gravity);
+    const __m128i no_grav = _mm_set1_epi32(SPACIAL_FLAG_NO_GRAV);
+
+    U32 i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        const __m128 dynamic  = sse_dynamic_mask(b, i);
+        const __m128 inv_mass = _mm_loadu_ps(b.inv_mass + i);
+        const __m128 has_grav = _mm_castsi128_ps(_mm_cmpeq_epi32(
+            _mm_and_si128(_mm_loadu_si128((const __m128i*) (b.flags + i)), no_grav),
+            _mm_setzero_si128()
+        ));
+
+        // angular, one body per lane
+        const __m128 w = _mm_loadu_ps(b.ang_vel + i);
+        const __m128 w_next = _mm_mul_ps(_mm_add_ps(w, _mm_mul_ps(_mm_loadu_ps(b.torque + i), dt)), ang_drag);
+        _mm_storeu_ps(b.ang_vel + i, sse_select(w, w_next, dynamic));
+        _mm_storeu_ps(b.torque + i, _mm_setzero_ps());
+
+        // linear, bodies 0-1 then 2-3
+        sse_velocity_pair(
+            (F32*) (b.vel + i), (F32*) (b.force + i),
+            _mm_unpacklo_ps(inv_mass, inv_mass),
+            _mm_unpacklo_ps(dynamic, dynamic),
+            _mm_and_ps(grav, _mm_unpacklo_ps(has_grav, has_grav)),
+            dt, drag
+        );
+
+        sse_velocity_pair(
+            (F32*) (b.vel + i + 2), (F32*) (b.force + i + 2),
+            _mm_unpackhi_ps(inv_mass, inv_mass),
+            _mm_unpackhi_ps(dynamic, dynamic),
+            _mm_and_ps(grav, _mm_unpackhi_ps(has_grav, has_grav)),
+            dt, drag
+        );
+    }
+
+    integrate_velocities_scalar(b, step, i);
+}
+
+static inline void sse_position_pair(F32* pos, F32* prev_pos, const F32* vel, __m128 dynamic, __m128 dt) {
+    const __m128 p = _mm_loadu_ps(pos);
+    _mm_storeu_ps(prev_pos, p);
+    _mm_storeu_ps(pos, _mm_add_ps(p, _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(vel), dt), dynamic)));
+}
+
+static void integrate_positions_sse(const PsxKernelBodies& b, F32 step_dt) {
+    const __m128 dt = _mm_set1_ps(step_dt);
+
+    U32 i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        const __m128 dynamic = sse_dynamic_mask(b, i);
+
+        const __m128 a = _mm_loadu_ps(b.ang + i);
+        _mm_storeu_ps(b.prev_ang + i, a);
+        _mm_storeu_ps(b.ang + i, _mm_add_ps(a, _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(b.ang_vel + i), dt), dynamic)));
+
+        sse_position_pair((F32*) (b.pos + i),     (F32*) (b.prev_pos + i),     (const F32*) (b.vel + i),     _mm_unpacklo_ps(dynamic, dynamic), dt);
+        sse_position_pair((F32*) (b.pos + i + 2), (F32*) (b.prev_pos + i + 2), (const F32*) (b.vel + i + 2), _mm_unpackhi_ps(dynamic, dynamic), dt);
+    }
+
+    integrate_positions_scalar(b, step_dt, i);
+}
+
+/*
+    SSE contact kernel, 4 rows per iteration. velocities are gathered into
+    lanes by slot and scattered back one row at a time
+*/
+
+struct SseContactVel {
+    __m128 vax, vay, wa;
+    __m128 vbx, vby, wb;
+};
+
+static inline __m128 sse_neg(__m128 a) {
+    return _mm_xor_ps(a, _mm_set1_ps(-0.f));
+}
+
+static inline __m128 sse_contact_rel(const PsxKernelContacts& c, U32 i, U32 p, const SseContactVel& v, __m128 dx, __m128 dy) {
+    const __m128 rax = _mm_loadu_ps(c.ra_x[p] + i);
+    const __m128 ray = _mm_loadu_ps(c.ra_y[p] + i);
+    const __m128 rbx = _mm_loadu_ps(c.rb_x[p] + i);
+    const __m128 rby = _mm_loadu_ps(c.rb_y[p] + i);
+
+    const __m128 rvx = _mm_sub_ps(_mm_add_ps(v.vbx, _mm_mul_ps(sse_neg(v.wb), rby)), _mm_add_ps(v.vax, _mm_mul_ps(sse_neg(v.wa), ray)));
+    const __m128 rvy = _mm_sub_ps(_mm_add_ps(v.vby, _mm_mul_ps(v.wb, rbx)), _mm_add_ps(v.vay, _mm_mul_ps(v.wa, rax)));
+    return _mm_add_ps(_mm_mul_ps(rvx, dx), _mm_mul_ps(rvy, dy));
+}
+
+static inline void sse_contact_apply(const PsxKernelContacts& c, U32 i, U32 p, SseContactVel& v, __m128 px, __m128 py) {
+    const __m128 ima = _mm_loadu_ps(c.inv_mass_a + i);
+    const __m128 imb = _mm_loadu_ps(c.inv_mass_b + i);
+    const __m128 rax = _mm_loadu_ps(c.ra_x[p] + i);
+    const __m128 ray = _mm_loadu_ps(c.ra_y[p] + i);
+    const __m128 rbx = _mm_loadu_ps(c.rb_x[p] + i);
+    const __m128 rby = _mm_loadu_ps(c.rb_y[p] + i);
+
+    v.vax = _mm_sub_ps(v.vax, _mm_mul_ps(px, ima));
+    v.vay = _mm_sub_ps(v.vay, _mm_mul_ps(py, ima));
+    v.wa  = _mm_sub_ps(v.wa, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(rax, py), _mm_mul_ps(px, ray)), _mm_loadu_ps(c.inv_inertia_a + i)));
+    v.vbx = _mm_add_ps(v.vbx, _mm_mul_ps(px, imb));
+    v.vby = _mm_add_ps(v.vby, _mm_mul_ps(py, imb));
+    v.wb  = _mm_add_ps(v.wb, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(rbx, py), _mm_mul_ps(px, rby)), _mm_loadu_ps(c.inv_inertia_b + i)));
+}
+
+static inline SseContactVel sse_contact_select(const SseContactVel& a, const SseContactVel& b, __m128 mask) {
+    return {
+        sse_select(a.vax, b.vax, mask), sse_select(a.vay, b.vay, mask), sse_select(a.wa, b.wa, mask),
+        sse_select(a.vbx, b.vbx, mask), sse_select(a.vby, b.vby, mask), sse_select(a.wb, b.wb, mask),
+    };
+}
+
+static void solve_contacts_sse(const PsxKernelContacts& c, U32 begin, U32 end) {
+    const __m128 zero = _mm_setzero_ps();
+
+    alignas(16) F32 lanes[6][4];
+
+    U32 i = begin;
+    for (; i + 4 <= end; i += 4) {
+        for (U32 l = 0; l < 4; ++l) {
+            const U32 a = c.body_a[i + l];
+            const U32 b = c.body_b[i + l];
+
+            lanes[0][l] = c.vel[a].x;
+            lanes[1][l] = c.vel[a].y;
+            lanes[2][l] = c.ang_vel[a];
+            lanes[3][l] = c.vel[b].x;
+            lanes[4][l] = c.vel[b].y;
+            lanes[5][l] = c.ang_vel[b];
+        }
+
+        SseContactVel v = {
+            _mm_load_ps(lanes[0]), _mm_load_ps(lanes[1]), _mm_load_ps(lanes[2]),
+            _mm_load_ps(lanes[3]), _mm_load_ps(lanes[4]), _mm_load_ps(lanes[5]),
+        };
+
+        const __m128 nx = _mm_loadu_ps(c.normal_x + i);
+        const __m128 ny = _mm_loadu_ps(c.normal_y + i);
+        const __m128 tx = _mm_loadu_ps(c.tangent_x + i);
+        const __m128 ty = _mm_loadu_ps(c.tangent_y + i);
+
+        // friction
+        for (U32 p = 0; p < 2; ++p) {
+            const __m128 vt = sse_contact_rel(c, i, p, v, tx, ty);
+            const __m128 lambda = _mm_mul_ps(sse_neg(_mm_loadu_ps(c.tangent_mass[p] + i)), vt);
+            const __m128 max_friction = _mm_mul_ps(_mm_loadu_ps(c.friction + i), _mm_loadu_ps(c.normal_impulse[p] + i));
+            const __m128 min_friction = sse_neg(max_friction);
+
+            const __m128 old = _mm_loadu_ps(c.tangent_impulse[p] + i);
+            const __m128 sum = _mm_add_ps(old, lambda);
+            __m128 next = sse_select(sum, max_friction, _mm_cmpgt_ps(sum, max_friction));
+            next = sse_select(next, min_friction, _mm_cmplt_ps(sum, min_friction));
+            _mm_storeu_ps(c.tangent_impulse[p] + i, next);
+
+            const __m128 d = _mm_sub_ps(next, old);
+            sse_contact_apply(c, i, p, v, _mm_mul_ps(tx, d), _mm_mul_ps(ty, d));
+        }
+
+        // normal, one point at a time
+        SseContactVel vs = v;
+        __m128 single[2];
+
+        for (U32 p = 0; p < 2; ++p) {
+            const __m128 vn = sse_contact_rel(c, i, p, vs, nx, ny);
+            const __m128 lambda = _mm_mul_ps(_mm_loadu_ps(c.normal_mass[p] + i), _mm_sub_ps(_mm_loadu_ps(c.bias[p] + i), vn));
+
+            const __m128 old = _mm_loadu_ps(c.normal_impulse[p] + i);
+            const __m128 sum = _mm_add_ps(old, lambda);
+            single[p] = _mm_and_ps(sum, _mm_cmpgt_ps(sum, zero));
+
+            const __m128 d = _mm_sub_ps(single[p], old);
+            sse_contact_apply(c, i, p, vs, _mm_mul_ps(nx, d), _mm_mul_ps(ny, d));
+        }
+
+        // normal, both points as a block, the first case that holds wins
+        const __m128 a1 = _mm_loadu_ps(c.normal_impulse[0] + i);
+        const __m128 a2 = _mm_loadu_ps(c.normal_impulse[1] + i);
+        const __m128 k12 = _mm_loadu_ps(c.k12 + i);
+
+        const __m128 vn1 = sse_contact_rel(c, i, 0, v, nx, ny);
+        const __m128 vn2 = sse_contact_rel(c, i, 1, v, nx, ny);
+
+        const __m128 b1 = _mm_sub_ps(_mm_sub_ps(vn1, _mm_loadu_ps(c.bias[0] + i)), _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c.k11 + i), a1), _mm_mul_ps(k12, a2)));
+        const __m128 b2 = _mm_sub_ps(_mm_sub_ps(vn2, _mm_loadu_ps(c.bias[1] + i)), _mm_add_ps(_mm_mul_ps(k12, a1), _mm_mul_ps(_mm_loadu_ps(c.k22 + i), a2)));
+
+        const __m128 both1 = sse_neg(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c.inv_k11 + i), b1), _mm_mul_ps(_mm_loadu_ps(c.inv_k12 + i), b2)));
+        const __m128 both2 = sse_neg(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c.inv_k12 + i), b1), _mm_mul_ps(_mm_loadu_ps(c.inv_k22 + i), b2)));
+        const __m128 both_ok = _mm_and_ps(_mm_cmpge_ps(both1, zero), _mm_cmpge_ps(both2, zero));
+
+        const __m128 first = _mm_mul_ps(sse_neg(_mm_loadu_ps(c.normal_mass[0] + i)), b1);
+        const __m128 first_ok = _mm_and_ps(_mm_cmpge_ps(first, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(k12, first), b2), zero));
+
+        const __m128 second = _mm_mul_ps(sse_neg(_mm_loadu_ps(c.normal_mass[1] + i)), b2);
+        const __m128 second_ok = _mm_and_ps(_mm_cmpge_ps(second, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(k12, second), b1), zero));
+
+        const __m128 neither_ok = _mm_and_ps(_mm_cmpge_ps(b1, zero), _mm_cmpge_ps(b2, zero));
+
+        __m128 x1 = a1;
+        __m128 x2 = a2;
+        x1 = sse_select(x1, zero,   neither_ok); x2 = sse_select(x2, zero,   neither_ok);
+        x1 = sse_select(x1, zero,   second_ok);  x2 = sse_select(x2, second, second_ok);
+        x1 = sse_select(x1, first,  first_ok);   x2 = sse_select(x2, zero,   first_ok);
+        x1 = sse_select(x1, both1,  both_ok);    x2 = sse_select(x2, both2,  both_ok);
+
+        const __m128 d1 = _mm_sub_ps(x1, a1);
+        const __m128 d2 = _mm_sub_ps(x2, a2);
+        sse_contact_apply(c, i, 0, v, _mm_mul_ps(nx, d1), _mm_mul_ps(ny, d1));
+        sse_contact_apply(c, i, 1, v, _mm_mul_ps(nx, d2), _mm_mul_ps(ny, d2));
+
+        const __m128 block = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*) (c.block + i)), _mm_setzero_si128()));
+        v = sse_contact_select(vs, v, block);
+        _mm_storeu_ps(c.normal_impulse[0] + i, sse_select(single[0], x1, block));
+        _mm_storeu_ps(c.normal_impulse[1] + i, sse_select(single[1], x2, block));
+
+        _mm_store_ps(lanes[0], v.vax);
+        _mm_store_ps(lanes[1], v.vay);
+        _mm_store_ps(lanes[2], v.wa);
+        _mm_store_ps(lanes[3], v.vbx);
+        _mm_store_ps(lanes[4], v.vby);
+        _mm_store_ps(lanes[5], v.wb);
+
+        for (U32 l = 0; l < 4; ++l) {
+            if (c.inv_mass_a[i + l] > 0.f) {
+                c.vel[c.body_a[i + l]] = { lanes[0][l], lanes[1][l] };
+                c.ang_vel[c.body_a[i + l]] = lanes[2][l];
+            }
+
+            if (c.inv_mass_b[i + l] > 0.f) {
+                c.vel[c.body_b[i + l]] = { lanes[3][l], lanes[4][l] };
+                c.ang_vel[c.body_b[i + l]] = lanes[5][l];
+            }
+        }
+    }
+
+    solve_contacts_scalar(c, i, end);
+}
+
+/*
+    AVX2 kernels, 8 bodies per iteration. same layout as the SSE kernels with
+    4 bodies per vec2 register
+*/
+
+PSX_TARGET_AVX2 static inline __m256 avx2_dynamic_mask(const PsxKernelBodies& b, U32 i) {
+    const __m256i flags = _mm256_loadu_si256((const __m256i*) (b.flags + i));
+    const __m256i is_not_static = _mm256_cmpeq_epi32(
+        _mm256_and_si256(flags, _mm256_set1_epi32(SPACIAL_FLAG_STATIC)),
+        _mm256_setzero_si256()
+    );
+
+    return _mm256_and_ps(
+        _mm256_castsi256_ps(is_not_static),
+        _mm256_cmp_ps(_mm256_loadu_ps(b.inv_mass + i), _mm256_setzero_ps(), _CMP_GT_OQ)
+    );
+}
+
+PSX_TARGET_AVX2 static inline void avx2_velocity_quad(
+    F32* vel, F32* force, __m256 inv_mass, __m256 dynamic, __m256 grav, 
+    __m256 dt, __m256 drag
+) {
+    const __m256 v = _mm256_loadu_ps(vel);
+    const __m256 acc = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(force), inv_mass), grav);
+    const __m256 next = _mm256_mul_ps(_mm256_add_ps(v, _mm256_mul_ps(acc, dt)), drag);
+
+    _mm256_storeu_ps(vel, _mm256_blendv_ps(v, next, dynamic));
+    _mm256_storeu_ps(force, _mm256_setzero_ps());
+}
+
+PSX_TARGET_AVX2 static void integrate_velocities_avx2(const PsxKernelBodies& b, const PsxKernelStep& step) {
+    const __m256 dt       = _mm256_set1_ps(step.dt);
+    const __m256 drag     = _mm256_set1_ps(step.drag);
+    const __m256 ang_drag = _mm256_set1_ps(step.ang_drag);
+    const __m256 grav     = _mm256_setr_ps(0.f, step.gravity, 0.f, step.gravity, 0.f, step.gravity, 0.f, step.gravity);
+    const __m256i no_grav = _mm256_set1_epi32(SPACIAL_FLAG_NO_GRAV);
+
+    // duplicate bodies 0-3 / 4-7 into lane pairs
+    const __m256i lo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i hi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    U32 i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        const __m256 dynamic  = avx2_dynamic_mask(b, i);
+        const __m256 inv_mass = _mm256_loadu_ps(b.inv_mass + i);
+        const __m256 has_grav = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+            _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (b.flags + i)), no_grav),
+            _mm256_setzero_si256()
+        ));
+
+        // angular, one body per lane
+        const __m256 w = _mm256_loadu_ps(b.ang_vel + i);
+        const __m256 w_next = _mm256_mul_ps(_mm256_add_ps(w, _mm256_mul_ps(_mm256_loadu_ps(b.torque + i), dt)), ang_drag);
+        _mm256_storeu_ps(b.ang_vel + i, _mm256_blendv_ps(w, w_next, dynamic));
+        _mm256_storeu_ps(b.torque + i, _mm256_setzero_ps());
+
+        // linear, bodies 0-3 then 4-7
+        avx2_velocity_quad(
+            (F32*) (b.vel + i), (F32*) (b.force + i),
+            _mm256_permutevar8x32_ps(inv_mass, lo),
+            _mm256_permutevar8x32_ps(dynamic, lo),
+            _mm256_and_ps(grav, _mm256_permutevar8x32_ps(has_grav, lo)),
+            dt, drag
+        );
+
+        avx2_velocity_quad(
+            (F32*) (b.vel + i + 4), (F32*) (b.force + i + 4),
+            _mm256_permutevar8x32_ps(inv_mass, hi),
+            _mm256_permutevar8x32_ps(dynamic, hi),
+            _mm256_and_ps(grav, _mm256_permutevar8x32_ps(has_grav, hi)),
+            dt, drag
+        );
+    }
+
+    integrate_velocities_scalar(b, step, i);
+}
+
+PSX_TARGET_AVX2 static inline void avx2_position_quad(F32* pos, F32* prev_pos, const F32* vel, __m256 dynamic, __m256 dt) {
+    const __m256 p = _mm256_loadu_ps(pos);
+    _mm256_storeu_ps(prev_pos, p);
+    _mm256_storeu_ps(pos, _mm256_add_ps(p, _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(vel), dt), dynamic)));
+}
+
+PSX_TARGET_AVX2 static void integrate_positions_avx2(const PsxKernelBodies& b, F32 step_dt) {
+    const __m256 dt = _mm256_set1_ps(step_dt);
+    const __m256i lo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i hi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    U32 i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        const __m256 dynamic = avx2_dynamic_mask(b, i);
+
+        const __m256 a = _mm256_loadu_ps(b.ang + i);
+        _mm256_storeu_ps(b.prev_ang + i, a);
+        _mm256_storeu_ps(b.ang + i, _mm256_add_ps(a, _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(b.ang_vel + i), dt), dynamic)));
+
+        avx2_position_quad((F32*) (b.pos + i),     (F32*) (b.prev_pos + i),     (const F32*) (b.vel + i),     _mm256_permutevar8x32_ps(dynamic, lo), dt);
+        avx2_position_quad((F32*) (b.pos + i + 4), (F32*) (b.prev_pos + i + 4), (const F32*) (b.vel + i + 4), _mm256_permutevar8x32_ps(dynamic, hi), dt);
+    }
+
+    integrate_positions_scalar(b, step_dt, i);
+}
+
+// 4 circle pairs per iteration
+static void collide_circles_sse(const PsxKernelCircles& c) {
+    U32 i = 0;
+    for (; i + 4 <= c.count; i += 4) {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(c.bx + i), _mm_loadu_ps(c.ax + i));
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(c.by + i), _mm_loadu_ps(c.ay + i));
+        const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const __m128 r = _mm_loadu_ps(c.radius + i);
+
+        _mm_storeu_ps(c.dist_sq + i, d2);
+        _mm_storeu_si128((__m128i*) (c.hit + i), _mm_castps_si128(_mm_cmplt_ps(d2, _mm_mul_ps(r, r))));
+    }
+
+    collide_circles_scalar(c, i);
+}
+
+/*
+    AVX2 contact kernel, 8 rows per iteration. same steps as the SSE kernel
+*/
+
+struct Avx2ContactVel {
+    __m256 vax, vay, wa;
+    __m256 vbx, vby, wb;
+};
+
+PSX_TARGET_AVX2 static inline __m256 avx2_neg(__m256 a) {
+    return _mm256_xor_ps(a, _mm256_set1_ps(-0.f));
+}
+
+PSX_TARGET_AVX2 static inline __m256 avx2_gt(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+PSX_TARGET_AVX2 static inline __m256 avx2_ge(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+PSX_TARGET_AVX2 static inline __m256 avx2_lt(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+
+PSX_TARGET_AVX2 static inline __m256 avx2_contact_rel(const PsxKernelContacts& c, U32 i, U32 p, const Avx2ContactVel& v, __m256 dx, __m256 dy) {
+    const __m256 rax = _mm256_loadu_ps(c.ra_x[p] + i);
+    const __m256 ray = _mm256_loadu_ps(c.ra_y[p] + i);
+    const __m256 rbx = _mm256_loadu_ps(c.rb_x[p] + i);
+    const __m256 rby = _mm256_loadu_ps(c.rb_y[p] + i);
+
+    const __m256 rvx = _mm256_sub_ps(_mm256_add_ps(v.vbx, _mm256_mul_ps(avx2_neg(v.wb), rby)), _mm256_add_ps(v.vax, _mm256_mul_ps(avx2_neg(v.wa), ray)));
+    const __m256 rvy = _mm256_sub_ps(_mm256_add_ps(v.vby, _mm256_mul_ps(v.wb, rbx)), _mm256_add_ps(v.vay, _mm256_mul_ps(v.wa, rax)));
+    return _mm256_add_ps(_mm256_mul_ps(rvx, dx), _mm256_mul_ps(rvy, dy));
+}
+
+PSX_TARGET_AVX2 static inline void avx2_contact_apply(const PsxKernelContacts& c, U32 i, U32 p, Avx2ContactVel& v, __m256 px, __m256 py) {
+    const __m256 ima = _mm256_loadu_ps(c.inv_mass_a + i);
+    const __m256 imb = _mm256_loadu_ps(c.inv_mass_b + i);
+    const __m256 rax = _mm256_loadu_ps(c.ra_x[p] + i);
+    const __m256 ray = _mm256_loadu_ps(c.ra_y[p] + i);
+    const __m256 rbx = _mm256_loadu_ps(c.rb_x[p] + i);
+    const __m256 rby = _mm256_loadu_ps(c.rb_y[p] + i);
+
+    v.vax = _mm256_sub_ps(v.vax, _mm256_mul_ps(px, ima));
+    v.vay = _mm256_sub_ps(v.vay, _mm256_mul_ps(py, ima));
+    v.wa  = _mm256_sub_ps(v.wa, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(rax, py), _mm256_mul_ps(px, ray)), _mm256_loadu_ps(c.inv_inertia_a + i)));
+    v.vbx = _mm256_add_ps(v.vbx, _mm256_mul_ps(px, imb));
+    v.vby = _mm256_add_ps(v.vby, _mm256_mul_ps(py, imb));
+    v.wb  = _mm256_add_ps(v.wb, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(rbx, py), _mm256_mul_ps(px, rby)), _mm256_loadu_ps(c.inv_inertia_b + i)));
+}
+
+PSX_TARGET_AVX2 static inline Avx2ContactVel avx2_contact_select(const Avx2ContactVel& a, const Avx2ContactVel& b, __m256 mask) {
+    return {
+        _mm256_blendv_ps(a.vax, b.vax, mask), _mm256_blendv_ps(a.vay, b.vay, mask), _mm256_blendv_ps(a.wa, b.wa, mask),
+        _mm256_blendv_ps(a.vbx, b.vbx, mask), _mm256_blendv_ps(a.vby, b.vby, mask), _mm256_blendv_ps(a.wb, b.wb, mask),
+    };
+}
+
+PSX_TARGET_AVX2 static void solve_contacts_avx2(const PsxKernelContacts& c, U32 begin, U32 end) {
+    const __m256 zero = _mm256_setzero_ps();
+
+    alignas(32) F32 lanes[6][8];
+
+    U32 i = begin;
+    for (; i + 8 <= end; i += 8) {
+        for (U32 l = 0; l < 8; ++l) {
+            const U32 a = c.body_a[i + l];
+            const U32 b = c.body_b[i + l];
+
+            lanes[0][l] = c.vel[a].x;
+            lanes[1][l] = c.vel[a].y;
+            lanes[2][l] = c.ang_vel[a];
+            lanes[3][l] = c.vel[b].x;
+            lanes[4][l] = c.vel[b].y;
+            lanes[5][l] = c.ang_vel[b];
+        }
+
+        Avx2ContactVel v = {
+            _mm256_load_ps(lanes[0]), _mm256_load_ps(lanes[1]), _mm256_load_ps(lanes[2]),
+            _mm256_load_ps(lanes[3]), _mm256_load_ps(lanes[4]), _mm256_load_ps(lanes[5]),
+        };
+
+        const __m256 nx = _mm256_loadu_ps(c.normal_x + i);
+        const __m256 ny = _mm256_loadu_ps(c.normal_y + i);
+        const __m256 tx = _mm256_loadu_ps(c.tangent_x + i);
+        const __m256 ty = _mm256_loadu_ps(c.tangent_y + i);
+
+        // friction
+        for (U32 p = 0; p < 2; ++p) {
+            const __m256 vt = avx2_contact_rel(c, i, p, v, tx, ty);
+            const __m256 lambda = _mm256_mul_ps(avx2_neg(_mm256_loadu_ps(c.tangent_mass[p] + i)), vt);
+            const __m256 max_friction = _mm256_mul_ps(_mm256_loadu_ps(c.friction + i), _mm256_loadu_ps(c.normal_impulse[p] + i));
+            const __m256 min_friction = avx2_neg(max_friction);
+
+            const __m256 old = _mm256_loadu_ps(c.tangent_impulse[p] + i);
+            const __m256 sum = _mm256_add_ps(old, lambda);
+            __m256 next = _mm256_blendv_ps(sum, max_friction, avx2_gt(sum, max_friction));
+            next = _mm256_blendv_ps(next, min_friction, avx2_lt(sum, min_friction));
+            _mm256_storeu_ps(c.tangent_impulse[p] + i, next);
+
+            const __m256 d = _mm256_sub_ps(next, old);
+            avx2_contact_apply(c, i, p, v, _mm256_mul_ps(tx, d), _mm256_mul_ps(ty, d));
+        }
+
+        // normal, one point at a time
+        Avx2ContactVel vs = v;
+        __m256 single[2];
+
+        for (U32 p = 0; p < 2; ++p) {
+            const __m256 vn = avx2_contact_rel(c, i, p, vs, nx, ny);
+            const __m256 lambda = _mm256_mul_ps(_mm256_loadu_ps(c.normal_mass[p] + i), _mm256_sub_ps(_mm256_loadu_ps(c.bias[p] + i), vn));
+
+            const __m256 old = _mm256_loadu_ps(c.normal_impulse[p] + i);
+            const __m256 sum = _mm256_add_ps(old, lambda);
+            single[p] = _mm256_and_ps(sum, avx2_gt(sum, zero));
+
+            const __m256 d = _mm256_sub_ps(single[p], old);
+            avx2_contact_apply(c, i, p, vs, _mm256_mul_ps(nx, d), _mm256_mul_ps(ny, d));
+        }
+
+        // normal, both points as a block, the first case that holds wins
+        const __m256 a1 = _mm256_loadu_ps(c.normal_impulse[0] + i);
+        const __m256 a2 = _mm256_loadu_ps(c.normal_impulse[1] + i);
+        const __m256 k12 = _mm256_loadu_ps(c.k12 + i);
+
+        const __m256 vn1 = avx2_contact_rel(c, i, 0, v, nx, ny);
+        const __m256 vn2 = avx2_contact_rel(c, i, 1, v, nx, ny);
+
+        const __m256 b1 = _mm256_sub_ps(_mm256_sub_ps(vn1, _mm256_loadu_ps(c.bias[0] + i)), _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(c.k11 + i), a1), _mm256_mul_ps(k12, a2)));
+        const __m256 b2 = _mm256_sub_ps(_mm256_sub_ps(vn2, _mm256_loadu_ps(c.bias[1] + i)), _mm256_add_ps(_mm256_mul_ps(k12, a1), _mm256_mul_ps(_mm256_loadu_ps(c.k22 + i), a2)));
+
+        const __m256 both1 = avx2_neg(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(c.inv_k11 + i), b1), _mm256_mul_ps(_mm256_loadu_ps(c.inv_k12 + i), b2)));
+        const __m256 both2 = avx2_neg(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(c.inv_k12 + i), b1), _mm256_mul_ps(_mm256_loadu_ps(c.inv_k22 + i), b2)));
+        const __m256 both_ok = _mm256_and_ps(avx2_ge(both1, zero), avx2_ge(both2, zero));
+
+        const __m256 first = _mm256_mul_ps(avx2_neg(_mm256_loadu_ps(c.normal_mass[0] + i)), b1);
+        const __m256 first_ok = _mm256_and_ps(avx2_ge(first, zero), avx2_ge(_mm256_add_ps(_mm256_mul_ps(k12, first), b2), zero));
+
+        const __m256 second = _mm256_mul_ps(avx2_neg(_mm256_loadu_ps(c.normal_mass[1] + i)), b2);
+        const __m256 second_ok = _mm256_and_ps(avx2_ge(second, zero), avx2_ge(_mm256_add_ps(_mm256_mul_ps(k12, second), b1), zero));
+
+        const __m256 neither_ok = _mm256_and_ps(avx2_ge(b1, zero), avx2_ge(b2, zero));
+
+        __m256 x1 = a1;
+        __m256 x2 = a2;
+        x1 = _mm256_blendv_ps(x1, zero,   neither_ok); x2 = _mm256_blendv_ps(x2, zero,   neither_ok);
+        x1 = _mm256_blendv_ps(x1, zero,   second_ok);  x2 = _mm256_blendv_ps(x2, second, second_ok);
+        x1 = _mm256_blendv_ps(x1, first,  first_ok);   x2 = _mm256_blendv_ps(x2, zero,   first_ok);
+        x1 = _mm256_blendv_ps(x1, both1,  both_ok);    x2 = _mm256_blendv_ps(x2, both2,  both_ok);
+
+        const __m256 d1 = _mm256_sub_ps(x1, a1);
+        const __m256 d2 = _mm256_sub_ps(x2, a2);
+        avx2_contact_apply(c, i, 0, v, _mm256_mul_ps(nx, d1), _mm256_mul_ps(ny, d1));
+        avx2_contact_apply(c, i, 1, v, _mm256_mul_ps(nx, d2), _mm256_mul_ps(ny, d2));
+
+        const __m256 block = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*) (c.block + i)), _mm256_setzero_si256()));
+        v = avx2_contact_select(vs, v, block);
+        _mm256_storeu_ps(c.normal_impulse[0] + i, _mm256_blendv_ps(single[0], x1, block));
+        _mm256_storeu_ps(c.normal_impulse[1] + i, _mm256_blendv_ps(single[1], x2, block));
+
+        _mm256_store_ps(lanes[0], v.vax);
+        _mm256_store_ps(lanes[1], v.vay);
+        _mm256_store_ps(lanes[2], v.wa);
+        _mm256_store_ps(lanes[3], v.vbx);
+        _mm256_store_ps(lanes[4], v.vby);
+        _mm256_store_ps(lanes[5], v.wb);
+
+        for (U32 l = 0; l < 8; ++l) {
+            if (c.inv_mass_a[i + l] > 0.f) {
+                c.vel[c.body_a[i + l]] = { lanes[0][l], lanes[1][l] };
+                c.ang_vel[c.body_a[i + l]] = lanes[2][l];
+            }
+
+            if (c.inv_mass_b[i + l] > 0.f) {
+                c.vel[c.body_b[i + l]] = { lanes[3][l], lanes[4][l] };
+                c.ang_vel[c.body_b[i + l]] = lanes[5][l];
+            }
+        }
+    }
+
+    solve_contacts_scalar(c, i, end);
+}
+
+// 8 circle pairs per iteration
+PSX_TARGET_AVX2 static void collide_circles_avx2(const PsxKernelCircles& c) {
+    U32 i = 0;
+    for (; i + 8 <= c.count; i += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(c.bx + i), _mm256_loadu_ps(c.ax + i));
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(c.by + i), _mm256_loadu_ps(c.ay + i));
+        const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const __m256 r = _mm256_loadu_ps(c.radius + i);
+
+        _mm256_storeu_ps(c.dist_sq + i, d2);
+        _mm256_storeu_si256((__m256i*) (c.hit + i), _mm256_castps_si256(avx2_lt(d2, _mm256_mul_ps(r, r))));
+    }
+
+    collide_circles_scalar(c, i);
+}
+
+#endif
+
+/*
+    dispatch
+*/
+
+void kernel_integrate_velocities(const PsxKernelBodies& b, const PsxKernelStep& step) {
+    switch (g_kernel_isa) {
+        #if PSX_KERNEL_X86
+        case KERNEL_ISA_AVX2 : { integrate_velocities_avx2(b, step); break; }
+        case KERNEL_ISA_SSE  : { integrate_velocities_sse(b, step); break; }
+        #endif
+        default : { integrate_velocities_scalar(b, step, 0); break; }
+    }
+}
+
+void kernel_integrate_positions(const PsxKernelBodies& b, F32 dt) {
+    switch (g_kernel_isa) {
+        #if PSX_KERNEL_X86
+        case KERNEL_ISA_AVX2 : { integrate_positions_avx2(b, dt); break; }
+        case KERNEL_ISA_SSE  : { integrate_positions_sse(b, dt); break; }
+        #endif
+        default : { integrate_positions_scalar(b, dt, 0); break; }
+    }
+}
+
+void kernel_solve_contacts(const PsxKernelContacts& c, U32 begin, U32 end) {
+    switch (g_kernel_isa) {
+        #if PSX_KERNEL_X86
+        case KERNEL_ISA_AVX2 : { solve_contacts_avx2(c, begin, end); break; }
+        case KERNEL_ISA_SSE  : { solve_contacts_sse(c, begin, end); break; }
+        #endif
+        default : { solve_contacts_scalar(c, begin, end); break; }
+    }
+}
+
+void kernel_collide_circles(const PsxKernelCircles& c) {
+    switch (g_kernel_isa) {
+        #if PSX_KERNEL_X86
+        case KERNEL_ISA_AVX2 : { collide_circles_avx2(c); break; }
+        case KERNEL_ISA_SSE  : { collide_circles_sse(c); break; }
+        #endif
+        default : { collide_circles_scalar(c, 0); break; }
+    }
+}
+
+U32 kernel_contact_width() {
+    switch (g_kernel_isa) {
+        case KERNEL_ISA_AVX2 : return 8;
+        case KERNEL_ISA_SSE  : return 4;
+        default              : return 1;
+    }
+}
+
+PsxKernelIsa kernel_detect_isa() {
+    #if PSX_KERNEL_X86 && defined(__GNUC__)
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return KERNEL_ISA_AVX2;
+    if (__builtin_cpu_supports("sse2")) return KERNEL_ISA_SSE;
+
+    #elif PSX_KERNEL_X86 && defined(_MSC_VER)
+
+    int info[4];
+    __cpuid(info, 1);
+
+    // avx needs os support for the ymm registers as well
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx     = info[2] & (1 << 28);
+    const bool sse2    = info[3] & (1 << 26);
+
+    if (osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return KERNEL_ISA_AVX2;
+    }
+
+    if (sse2) return KERNEL_ISA_SSE;
+
+    #endif
+
+    return KERNEL_ISA_SCALAR;
+}
+
+PsxKernelIsa kernel_get_isa() {
+    return g_kernel_isa;
+}
+
+PsxKernelIsa kernel_set_isa(PsxKernelIsa isa) {
+    PsxKernelIsa supported = kernel_detect_isa();
+    g_kernel_isa = (isa > supported) ? supported : isa;
+    return g_kernel_isa;
+}
+
+const char* kernel_isa_name(PsxKernelIsa isa) {
+    switch (isa) {
+        case KERNEL_ISA_AVX2 : return "avx2";
+        case KERNEL_ISA_SSE  : return "sse";
+        default              : return "scalar";
+    }
+}
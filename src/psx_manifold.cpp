@@ -1,248 +1,541 @@
 #include "psx_manifold.h"
+#include "psx_profile.h"
+#include "psx_pool.h"
+#include "psx_world.h"
+#include "psx_kernel.h"
+#include "psx_island.h"
+#include <vector>
+
+static_assert((CFG_MANIFOLD_TABLE_MIN & (CFG_MANIFOLD_TABLE_MIN - 1)) == 0, "manifold table size must be a power of two");
+
+struct PsxSatEntry {
+    U64 key;  // pair key, 0 is empty, a collider is never paired with itself
+    U32 axis;
+};
+
+// axes of the second collider are tagged, the rest is the edge index
+static const U32 SAT_AXIS_B = 1u << 31;
+
+// gjk pairs keep their closest support pair instead, 15 bits per vertex index. an arena chunk holds smaller polygons
+static const U32 SAT_AXIS_GJK = 1u << 30;
+static_assert(CFG_VERTEX_ARENA_CHUNK / 4 <= (1 << 15), "gjk seeds need 15 bit vertex indices");
+
+struct PsxManifoldState {
+    PsxPool<PsxManifold> manifolds;
+    U32 total;
+    U32 created;
+
+    /*
+        pair cache, open addressing over the collider pair key. slots hold the
+        manifold handle + 1 so a zeroed table is empty. the table doubles
+        before it gets more than half full
+    */
+    U32* table;
+    U32 table_size;
+
+    // step the cached manifolds were last touched in
+    U32 step;
+
+    // separating axes of the last pass and the one being filled, same open addressing as the pair cache
+    std::vector<PsxSatEntry> sat;
+    std::vector<PsxSatEntry> sat_next;
+    U32 sat_next_count;
+
+    U32 gjk_min_vertices = CFG_GJK_MIN_VERTICES;
+};
+
+static PsxManifoldState& manifold_state() {
+    return *world_current()->manifold;
+}
 
-static PsxManifold g_manifolds[CFG_MAX_MANIFOLDS] = { };
-static U32 g_manifold_free[CFG_MAX_MANIFOLDS] = { };
-static U32 g_manifolds_free_top = 0;
-static U32 g_next_manifold = 0;
-static U32 total_manifolds = 0;
+PsxManifoldState* manifold_state_new() {
+    return new PsxManifoldState();
+}
 
-PsxManifold& manifold_get(Inst manifold) {
-    if (manifold >= g_next_manifold) {
-        THROW("Manifold: attempt to get invalid manifold");
+void manifold_state_free(PsxManifoldState* state) {
+    free(state->table);
+    state->manifolds.release();
+    delete state;
+}
+
+U64 manifold_pair_key(Inst collider_a, Inst collider_b) {
+    if (collider_a > collider_b) vswap(collider_a, collider_b);
+    return ((U64) collider_a << 32) | collider_b;
+}
+
+static U32 manifold_table_home(U64 key, U32 mask) {
+    return (U32) ((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static U64 manifold_key(const PsxManifold& m) {
+    return manifold_pair_key(m.collider_a, m.collider_b);
+}
+
+// slot holding key or the empty slot it would go in
+static U32 manifold_table_find(U64 key) {
+    PsxManifoldState& state = manifold_state();
+
+    U32 slot = manifold_table_home(key, state.table_size - 1);
+
+    while (state.table[slot] && manifold_key(state.manifolds[state.table[slot] - 1]) != key) {
+        slot = (slot + 1) & (state.table_size - 1);
     }
 
-    return g_manifolds[manifold];
+    return slot;
 }
 
-PsxManifold& manifold_alloc() {
-    Inst manifold;
+// make room for one more pair, every cached manifold is rehashed when the table doubles
+static void manifold_table_reserve() {
+    PsxManifoldState& state = manifold_state();
+
+    if ((state.total + 1) * 2 <= state.table_size) return;
+
+    U32 size = state.table_size ? state.table_size * 2 : CFG_MANIFOLD_TABLE_MIN;
+
+    free(state.table);
+    state.table = (U32*) calloc(size, sizeof(U32));
+    state.table_size = size;
+
+    if (!state.table) THROW("Physics: out of memory for the manifold table");
+
+    for (U32 i = 0; i < state.manifolds.count; ++i) {
+        const PsxManifold& m = state.manifolds[i];
+        if (!m.in_use) continue;
 
-    if (g_manifolds_free_top > 0) {
-        g_manifolds_free_top--;
-        manifold = g_manifold_free[g_manifolds_free_top];
+        state.table[manifold_table_find(manifold_key(m))] = m.index + 1;
     }
+}
+
+static void manifold_table_remove(U64 key) {
+    PsxManifoldState& state = manifold_state();
+
+    const U32 mask = state.table_size - 1;
+
+    U32 hole = manifold_table_find(key);
+    if (!state.table[hole]) return;
+
+    // shift the rest of the probe run back so lookups never stop early
+    U32 next = hole;
+    while (true) {
+        next = (next + 1) & mask;
+        if (!state.table[next]) break;
 
-    else {
-        if (g_next_manifold >= CFG_MAX_MANIFOLDS) {
-            THROW("Physics: no more manifolds");
+        U32 home = manifold_table_home(manifold_key(state.manifolds[state.table[next] - 1]), mask);
+
+        // entry can move if its home is not inside (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            state.table[hole] = state.table[next];
+            hole = next;
         }
+    }
+
+    state.table[hole] = 0;
+}
+
+PsxManifold& manifold_get(Inst manifold) {
+    PsxManifoldState& state = manifold_state();
 
-        manifold = g_next_manifold++;
+    if (!state.manifolds.valid(manifold)) {
+        THROW("Manifold: attempt to get invalid or stale manifold %u", manifold);
     }
 
+    return state.manifolds[manifold];
+}
+
+bool manifold_valid(Inst manifold) {
+    return manifold_state().manifolds.valid(manifold);
+}
+
+Inst manifold_handle(U32 slot) {
+    return manifold_state().manifolds.handle(slot);
+}
+
+Inst manifold_find(Inst collider_a, Inst collider_b) {
+    PsxManifoldState& state = manifold_state();
+
+    if (!state.table_size) return NO_INSTANCE;
+
+    U32 slot = manifold_table_find(manifold_pair_key(collider_a, collider_b));
+    return state.table[slot] ? state.table[slot] - 1 : NO_INSTANCE;
+}
+
+PsxManifold& manifold_alloc() {
+    PsxManifoldState& state = manifold_state();
+
+    U32 manifold = state.manifolds.alloc();
 
     // instance new manifold at index
-    PsxManifold& m = g_manifolds[manifold];
+    PsxManifold& m = state.manifolds[manifold];
 
     if (m.in_use) {
         THROW("Physics: got manifold in use @ index=%i", manifold);
     }
 
-    m.index = manifold;
+    m.index = state.manifolds.handle(manifold);
     m.in_use = true;
     m.user_data = nullptr;
-    total_manifolds++;
+    m.contact_count = 0;
+    m.sleeping = false;
+    state.total++;
+    state.created++;
+    PROFILE_COUNT(PROFILE_COUNTER_MANIFOLDS_CREATED, 1);
 
     return m;
 }
 
 void manifold_free(Inst manifold) {
-    PsxManifold& m = manifold_get(manifold);
+    PsxManifoldState& state = manifold_state();
+
+    if (!state.manifolds.valid(manifold)) {
+        return;
+    }
+
+    PsxManifold& m = state.manifolds[manifold];
         
     if (!m.in_use) {
         return;
     }
 
+    if (manifold_find(m.collider_a, m.collider_b) == manifold) {
+        manifold_table_remove(manifold_key(m));
+    }
+
     m.in_use = false;
     m.user_data = nullptr;
 
-    if (g_manifolds_free_top >= CFG_MAX_MANIFOLDS) {
-        THROW("Physics: no more free slots");
+    state.total--;
+    state.manifolds.free(m.index);
+}
+
+void manifolds_free_collider(Inst collider) {
+    PsxManifoldState& state = manifold_state();
+
+    for (U32 i = 0; i < state.manifolds.count; ++i) {
+        PsxManifold& m = state.manifolds[i];
+        if (!m.in_use) continue;
+
+        if (m.collider_a == collider || m.collider_b == collider) {
+            // whatever rested on the collider has to fall, asleep or not
+            island_wake(m.spacial_a);
+            island_wake(m.spacial_b);
+
+            manifold_free(m.index);
+        }
     }
+}
 
-    total_manifolds--;
-    g_manifold_free[g_manifolds_free_top++] = m.index;
+void manifold_set_gjk_min_vertices(U32 vertices) {
+    manifold_state().gjk_min_vertices = vertices;
 }
 
-Inst manifold_new(
-    Inst collider_a, 
-    Inst collider_b, 
-    bool colliding,
-    Vec2 normal,
-    Vec2 tangent,
-    Vec2 contact,
-    F32  depth
-) {
-    PsxManifold& manifold = manifold_alloc();
+U32 manifold_get_gjk_min_vertices() {
+    return manifold_state().gjk_min_vertices;
+}
 
-    manifold.collider_a = collider_a;
-    manifold.collider_b = collider_b;
-    manifold.colliding = colliding;
-    manifold.normal = normal;
-    manifold.tangent = tangent;
-    manifold.depth = depth;
-    manifold.contact = contact;
+/*
+    separating axis cache
+*/
+
+static U32 manifold_sat_find(const std::vector<PsxSatEntry>& table, U64 key) {
+    const U32 mask = (U32) table.size() - 1;
+    U32 slot = manifold_table_home(key, mask);
 
-    return manifold.index;
+    while (table[slot].key && table[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
 }
 
-void manifold_solve(const PsxManifold& m, F32 dt) {
-    if (!m.colliding) return;
+U32 manifold_sat_axis(Inst collider_a, Inst collider_b) {
+    const std::vector<PsxSatEntry>& table = manifold_state().sat;
+    if (table.empty()) return NO_INSTANCE;
 
-    PsxCollider& colA = collider_get(m.collider_a);
-    PsxCollider& colB = collider_get(m.collider_b);
-    PsxSpacial&  A    = spacial_get(colA.spacial);
-    PsxSpacial&  B    = spacial_get(colB.spacial);
+    const PsxSatEntry& e = table[manifold_sat_find(table, manifold_pair_key(collider_a, collider_b))];
+    return e.key ? e.axis : NO_INSTANCE;
+}
 
-    if (!colA.shape || !colB.shape) return;
-    if (!A.in_use || !B.in_use) return;
+void manifold_sat_store(Inst collider_a, Inst collider_b, U32 axis) {
+    PsxManifoldState& state = manifold_state();
+    std::vector<PsxSatEntry>& table = state.sat_next;
 
-    // response logic
-    bool a_static = (A.flags & SPACIAL_FLAG_STATIC);
-    bool b_static = (B.flags & SPACIAL_FLAG_STATIC);
-    if (a_static && b_static) return;
-
-    // mass
-    F32 inv_mass_a = a_static ? 0.f : A.inv_mass;
-    F32 inv_mass_b = b_static ? 0.f : B.inv_mass;
-
-    // interia
-    F32 inv_i_a    = a_static ? 0.f : A.inv_inertia;
-    F32 inv_i_b    = b_static ? 0.f : B.inv_inertia;
-
-    F32 inv_mass_sum = inv_mass_a + inv_mass_b;
-    if (inv_mass_sum <= 0.f) return;
-
-    // material properties
-    F32 restitution = f32_clamp(
-        fmaxf(
-            material_get_restitution(colA.material), 
-            material_get_restitution(colB.material)
-        ), 
-        0.f, 1.f);
-
-    F32 friction = sqrtf(
-        material_get_friction(colA.material) *  
-        material_get_friction(colB.material)
-    );
+    // double before the table gets more than half full
+    if ((state.sat_next_count + 1) * 2 > table.size()) {
+        std::vector<PsxSatEntry> old;
+        old.swap(table);
+        table.assign(old.empty() ? CFG_MANIFOLD_TABLE_MIN : old.size() * 2, {});
+
+        for (const PsxSatEntry& e : old) {
+            if (e.key) table[manifold_sat_find(table, e.key)] = e;
+        }
+    }
+
+    U64 key = manifold_pair_key(collider_a, collider_b);
+    PsxSatEntry& e = table[manifold_sat_find(table, key)];
+
+    if (!e.key) state.sat_next_count++;
+    e = { key, axis };
+}
+
+/*
+    a narrowphase pass stamps every pair it stores, pairs that were not
+    stamped stopped touching and are dropped at the end of the pass.
+    sleeping pairs are not tested and stay until their island wakes
+*/
 
-    Vec2 normal = m.normal;   // unit collision normal
-    Vec2 contact = m.contact; // contact point
+void manifolds_begin_update() {
+    manifold_state().step++;
+}
 
-    // --- Positional correction (light, just to avoid sinking)
-    {
-        const F32 slop = 0.02f;
-        const F32 percent = 0.2f;
+void manifolds_end_update() {
+    PsxManifoldState& state = manifold_state();
 
-        F32 depth = m.depth - slop;
-        if (depth < 0.f) depth = 0.f;
+    // the axes stored this pass are the ones the next pass reads
+    state.sat.swap(state.sat_next);
+    std::fill(state.sat_next.begin(), state.sat_next.end(), PsxSatEntry{});
+    state.sat_next_count = 0;
 
-        Vec2 corr = normal * (depth * percent / inv_mass_sum);
+    for (U32 i = 0; i < state.manifolds.count; ++i) {
+        PsxManifold& m = state.manifolds[i];
+        if (!m.in_use || m.sleeping) continue;
 
-        if (!a_static) A.pos -= corr * inv_mass_a;
-        if (!b_static) B.pos += corr * inv_mass_b;
+        if (m.step != state.step) {
+            manifold_free(m.index);
+        }
     }
+}
 
-    // compute contact velocities
-    Vec2 ra = contact - A.pos;
-    Vec2 rb = contact - B.pos;
+/*
+    sequential impulse solver. contacts keep their accumulated impulses
+    between steps, the solver starts from them and refines them over a
+    fixed number of velocity iterations
+*/
 
-    Vec2 vel_a = A.vel + vec2_cross(A.ang_vel, ra);
-    Vec2 vel_b = B.vel + vec2_cross(B.ang_vel, rb);
-    Vec2 rv = vel_b - vel_a; // relative velocity
+// static bodies are shared by islands solved on other threads, they are never written
+static void manifold_apply_impulse(PsxManifold& m, PsxSpacial& A, PsxSpacial& B, const PsxContact& c, Vec2 impulse) {
+    if (m.inv_mass_a > 0.f) {
+        A.vel     -= impulse * m.inv_mass_a;
+        A.ang_vel -= vec2_cross(c.ra, impulse) * m.inv_inertia_a;
+    }
 
-    // normal impulse
-    F32 max_friction;
-    do {
-        F32 vel_norm = vec2_dot(rv, normal);
-        if (vel_norm > 0.f) continue; // separating
+    if (m.inv_mass_b > 0.f) {
+        B.vel     += impulse * m.inv_mass_b;
+        B.ang_vel += vec2_cross(c.rb, impulse) * m.inv_inertia_b;
+    }
+}
 
-        F32 rn_a = vec2_cross(ra, normal);
-        F32 rn_b = vec2_cross(rb, normal);
+static Vec2 manifold_relative_vel(const PsxSpacial& A, const PsxSpacial& B, const PsxContact& c) {
+    Vec2 vel_a = A.vel + vec2_cross(A.ang_vel, c.ra);
+    Vec2 vel_b = B.vel + vec2_cross(B.ang_vel, c.rb);
+    return vel_b - vel_a;
+}
 
-        F32 denom_norm = inv_mass_a + inv_mass_b + rn_a * rn_a * inv_i_a + rn_b * rn_b * inv_i_b;
-        if (denom_norm < 0.0005) continue; // will yeet shit into andromeda without this
-        
-        F32 j = -(1.f + restitution) * vel_norm / denom_norm;
-        max_friction = j * friction; // max friction is relative to normal
-        Vec2 impulse_norm = normal * j;
+// effective inverse mass of a body, 0 for static bodies and no rotation for non rigid ones
+static void manifold_body_mass(const PsxSpacial& s, F32& inv_mass, F32& inv_inertia) {
+    bool is_static = (s.flags & SPACIAL_FLAG_STATIC);
 
-        printf("bounce %.4f %.4f\n", vel_norm, denom_norm);
-        if (!a_static) spacial_impulse(A, -impulse_norm, contact);
-        if (!b_static) spacial_impulse(B,  impulse_norm, contact);
-    } while(0);
+    inv_mass    = is_static ? 0.f : s.inv_mass;
+    inv_inertia = (is_static || !(s.flags & SPACIAL_FLAG_RIGID)) ? 0.f : s.inv_inertia;
+}
 
+void manifold_prestep(PsxManifold& m, F32 inv_dt) {
+    m.active = false;
+    if (!m.colliding) return;
 
-    // friction impulse
-    do {
-        Vec2 tangent = rv - normal * vec2_dot(rv, normal);
-        F32 tlen = vec2_length(tangent);
-        if (tlen < 0.0005) continue;;
-        tangent /= tlen;
+    const PsxCollider& colA = collider_get(m.collider_a);
+    const PsxCollider& colB = collider_get(m.collider_b);
+    if (!colA.shape || !colB.shape) return;
 
-        F32 vel_tan = vec2_dot(rv, tangent);
-        F32 rt_a = vec2_cross(ra, tangent);
-        F32 rt_b = vec2_cross(rb, tangent);
+    PsxSpacial A = spacial_get(colA.spacial);
+    PsxSpacial B = spacial_get(colB.spacial);
+    if (!A.in_use || !B.in_use) return;
 
-        F32 denom_tan = inv_mass_a + inv_mass_b + rt_a * rt_a * inv_i_a + rt_b * rt_b * inv_i_b;
-        if (denom_tan < 0.0005) continue;; // will yeet shit onto kepler-B without this
+    manifold_body_mass(A, m.inv_mass_a, m.inv_inertia_a);
+    manifold_body_mass(B, m.inv_mass_b, m.inv_inertia_b);
 
-        F32 jt = -vel_tan / denom_tan;
-        jt = f32_clamp(jt, -max_friction, +max_friction);
+    if (m.inv_mass_a + m.inv_mass_b <= 0.f) return;
+    m.active = true;
 
-        Vec2 impulse_tan = tangent * jt;
+    for (U32 i = 0; i < m.contact_count; ++i) {
+        PsxContact& c = m.contacts[i];
 
-        if (!a_static) spacial_impulse(A, -impulse_tan, contact);
-        if (!b_static) spacial_impulse(B,  impulse_tan, contact);
-    } while(0);
-}
+        c.ra = c.point - A.pos;
+        c.rb = c.point - B.pos;
 
-void manifolds_solve(F32 dt) {
-    for (Inst i = 0; i < g_next_manifold; ++i) {
-        PsxManifold& m = g_manifolds[i];
-        if (!m.in_use) continue;
+        F32 rn_a = vec2_cross(c.ra, m.normal);
+        F32 rn_b = vec2_cross(c.rb, m.normal);
+        F32 k_normal = m.inv_mass_a + m.inv_mass_b + rn_a * rn_a * m.inv_inertia_a + rn_b * rn_b * m.inv_inertia_b;
+        c.normal_mass = k_normal > 0.f ? 1.f / k_normal : 0.f;
+
+        F32 rt_a = vec2_cross(c.ra, m.tangent);
+        F32 rt_b = vec2_cross(c.rb, m.tangent);
+        F32 k_tangent = m.inv_mass_a + m.inv_mass_b + rt_a * rt_a * m.inv_inertia_a + rt_b * rt_b * m.inv_inertia_b;
+        c.tangent_mass = k_tangent > 0.f ? 1.f / k_tangent : 0.f;
 
-        manifold_solve(m, dt);
+        // push out whatever is past the slop over a few steps
+        c.bias = CFG_SOLVER_BAUMGARTE * inv_dt * fmaxf(0.f, c.depth - CFG_SOLVER_SLOP);
 
-        #if !(CFG_MANIFOLDS_RENDER) // need to free manifolds after render pass
-        manifold_free(i);
+        // bounce only on contacts that close fast enough
+        F32 vel_norm = vec2_dot(manifold_relative_vel(A, B, c), m.normal);
+        if (vel_norm < -CFG_SOLVER_RESTITUTION_THRESHOLD) {
+            c.bias = fmaxf(c.bias, -m.restitution * vel_norm);
+        }
+
+        #if CFG_SOLVER_WARM_START
+        manifold_apply_impulse(m, A, B, c, m.normal * c.normal_impulse + m.tangent * c.tangent_impulse);
+        #else
+        c.normal_impulse = 0.f;
+        c.tangent_impulse = 0.f;
         #endif
     }
+
+    // two points are solved together so a resting face settles in one step
+    m.block = false;
+
+    #if CFG_SOLVER_BLOCK
+    if (m.contact_count == 2) {
+        const PsxContact& c1 = m.contacts[0];
+        const PsxContact& c2 = m.contacts[1];
+
+        F32 rn1_a = vec2_cross(c1.ra, m.normal);
+        F32 rn1_b = vec2_cross(c1.rb, m.normal);
+        F32 rn2_a = vec2_cross(c2.ra, m.normal);
+        F32 rn2_b = vec2_cross(c2.rb, m.normal);
+        F32 inv_mass = m.inv_mass_a + m.inv_mass_b;
+
+        F32 k11 = inv_mass + m.inv_inertia_a * rn1_a * rn1_a + m.inv_inertia_b * rn1_b * rn1_b;
+        F32 k22 = inv_mass + m.inv_inertia_a * rn2_a * rn2_a + m.inv_inertia_b * rn2_b * rn2_b;
+        F32 k12 = inv_mass + m.inv_inertia_a * rn1_a * rn2_a + m.inv_inertia_b * rn1_b * rn2_b;
+        F32 det = k11 * k22 - k12 * k12;
+
+        if (k11 * k11 < CFG_SOLVER_MAX_CONDITION * det) {
+            F32 inv_det = 1.f / det;
+
+            m.block = true;
+            m.k11 = k11;
+            m.k12 = k12;
+            m.k22 = k22;
+            m.inv_k11 =  k22 * inv_det;
+            m.inv_k12 = -k12 * inv_det;
+            m.inv_k22 =  k11 * inv_det;
+        }
+    }
+    #endif
 }
 
-void manifolds_render() {
-    #if CFG_MANIFOLDS_RENDER
+/*
+    both normal impulses at once, the 2x2 lcp is solved by trying which
+    points are pushing: both, only the first, only the second or neither
+*/
+static void manifold_solve_block(PsxManifold& m, PsxSpacial& A, PsxSpacial& B) {
+    PsxContact& c1 = m.contacts[0];
+    PsxContact& c2 = m.contacts[1];
 
-    for (Inst i = 0; i < g_next_manifold; ++i) {
-        PsxManifold& m = g_manifolds[i];
-        if (!m.in_use) continue;
+    F32 a1 = c1.normal_impulse;
+    F32 a2 = c2.normal_impulse;
 
-        shape_point(m.contact); // render contact point
+    F32 vn1 = vec2_dot(manifold_relative_vel(A, B, c1), m.normal);
+    F32 vn2 = vec2_dot(manifold_relative_vel(A, B, c2), m.normal);
 
-        const PsxCollider& collider_a = collider_get(m.collider_a);
-        const PsxCollider& collider_b = collider_get(m.collider_b);
+    // b = vn - bias - K * a
+    F32 b1 = vn1 - c1.bias - (m.k11 * a1 + m.k12 * a2);
+    F32 b2 = vn2 - c2.bias - (m.k12 * a1 + m.k22 * a2);
 
-        // render normals
-        Vec2 pos_a, pos_b;
-        if (collider_a.shape == SHAPE_POLY) {
-            pos_a = collider_a.poly.center;
-        } else {
-            pos_a = collider_get_pos(collider_a);
-        }
+    F32 x1, x2;
 
-        if (collider_b.shape == SHAPE_POLY) {
-            pos_b = collider_b.poly.center;
-        } else {
-            pos_b = collider_get_pos(collider_b);
-        }
+    do {
+        // both pushing
+        x1 = -(m.inv_k11 * b1 + m.inv_k12 * b2);
+        x2 = -(m.inv_k12 * b1 + m.inv_k22 * b2);
+        if (x1 >= 0.f && x2 >= 0.f) break;
+
+        // first only
+        x1 = -c1.normal_mass * b1;
+        x2 = 0.f;
+        if (x1 >= 0.f && m.k12 * x1 + b2 >= 0.f) break;
+
+        // second only
+        x1 = 0.f;
+        x2 = -c2.normal_mass * b2;
+        if (x2 >= 0.f && m.k12 * x2 + b1 >= 0.f) break;
+
+        // neither
+        x1 = 0.f;
+        x2 = 0.f;
+        if (b1 >= 0.f && b2 >= 0.f) break;
+
+        return; // no solution, keep the impulses from the last iteration
+    } while (0);
+
+    manifold_apply_impulse(m, A, B, c1, m.normal * (x1 - a1));
+    manifold_apply_impulse(m, A, B, c2, m.normal * (x2 - a2));
+
+    c1.normal_impulse = x1;
+    c2.normal_impulse = x2;
+}
+
+void manifold_solve(PsxManifold& m) {
+    if (!m.active) return;
+
+    PsxSpacial A = spacial_get(m.spacial_a);
+    PsxSpacial B = spacial_get(m.spacial_b);
 
-        shape_line(pos_a, pos_a + (m.normal * 5));
-        shape_line(pos_b, pos_b - (m.normal * 5));
+    // friction first, bounded by the normal impulse of the last iteration
+    for (U32 i = 0; i < m.contact_count; ++i) {
+        PsxContact& c = m.contacts[i];
 
-        manifold_free(i);
+        F32 vel_tan = vec2_dot(manifold_relative_vel(A, B, c), m.tangent);
+        F32 impulse_tan = -c.tangent_mass * vel_tan;
+
+        F32 max_friction = m.friction * c.normal_impulse;
+        F32 old_tan = c.tangent_impulse;
+        c.tangent_impulse = f32_clamp(old_tan + impulse_tan, -max_friction, max_friction);
+        manifold_apply_impulse(m, A, B, c, m.tangent * (c.tangent_impulse - old_tan));
     }
 
-    #endif
+    if (m.block) {
+        manifold_solve_block(m, A, B);
+        return;
+    }
+
+    // normal impulse per point, the accumulated impulse may only push
+    for (U32 i = 0; i < m.contact_count; ++i) {
+        PsxContact& c = m.contacts[i];
+
+        F32 vel_norm = vec2_dot(manifold_relative_vel(A, B, c), m.normal);
+        F32 impulse_norm = c.normal_mass * (c.bias - vel_norm);
+
+        F32 old_norm = c.normal_impulse;
+        c.normal_impulse = fmaxf(old_norm + impulse_norm, 0.f);
+        manifold_apply_impulse(m, A, B, c, m.normal * (c.normal_impulse - old_norm));
+    }
+}
+
+void manifolds_solve(F32 dt, U32 iterations) {
+    PROFILE_SCOPE(PROFILE_ZONE_SOLVE);
+    PsxManifoldState& state = manifold_state();
+
+    F32 inv_dt = dt > 0.f ? 1.f / dt : 0.f;
+
+    for (U32 i = 0; i < state.manifolds.count; ++i) {
+        PsxManifold& m = state.manifolds[i];
+        if (!m.in_use || m.sleeping) continue;
+
+        manifold_prestep(m, inv_dt);
+    }
+
+    for (U32 it = 0; it < iterations; ++it) {
+        for (U32 i = 0; i < state.manifolds.count; ++i) {
+            PsxManifold& m = state.manifolds[i];
+            if (!m.in_use || m.sleeping) continue;
+
+            manifold_solve(m);
+        }
+    }
+}
+
+void manifolds_solve(F32 dt) {
+    manifolds_solve(dt, CFG_SOLVER_ITERATIONS);
 }
 
 bool manifold_get_colliding(Inst manifold) {
@@ -253,15 +546,72 @@ bool manifold_get_colliding(Inst manifold) {
     manifold cases
 */
 
-static Inst manifold_get_poly_poly(const PsxCollider& R1, const PsxCollider& R2) {
-    if (R1.shape != SHAPE_POLY || R2.shape != SHAPE_POLY) {
-        return NO_INSTANCE;
+static bool manifold_fill(
+    PsxManifold& out,
+    Inst collider_a, 
+    Inst collider_b, 
+    bool colliding,
+    Vec2 normal,
+    Vec2 tangent,
+    Vec2 contact,
+    F32  depth
+) {
+    out.user_data = nullptr;
+    out.collider_a = collider_a;
+    out.collider_b = collider_b;
+    out.colliding = colliding;
+    out.normal = normal;
+    out.tangent = tangent;
+    out.index = NO_INSTANCE;
+    out.in_use = false;
+
+    out.contact_count = 1;
+    out.contacts[0] = { };
+    out.contacts[0].point = contact;
+    out.contacts[0].depth = depth;
+    out.contacts[0].id = 0;
+
+    return true;
+}
+
+// clip the contacts of two overlapping polygons, normal points from R1 to R2
+static bool manifold_poly_contacts(const PsxCollider& R1, const PsxCollider& R2, Vec2 normal, PsxManifold& out) {
+    Vec2 points[MM_MAX_CONTACT_PTS];
+    F32  depths[MM_MAX_CONTACT_PTS];
+    U32  ids[MM_MAX_CONTACT_PTS];
+
+    U32 count = algo_clip_contacts(
+        R1.poly.transform, R1.poly.normals, R1.poly.count,
+        R2.poly.transform, R2.poly.normals, R2.poly.count,
+        normal,
+        points, depths, ids
+    );
+
+    if (count == 0) {
+        return false;
     }
 
-    if (R1.poly.count < 2 || R2.poly.count < 2) {
-        return NO_INSTANCE;
+    manifold_fill(out,
+        R1.id, R2.id, 
+        true, 
+        normal, 
+        vec2_perp(normal), 
+        points[0], 
+        depths[0]
+    );
+
+    out.contact_count = count;
+    for (U32 i = 0; i < count; ++i) {
+        out.contacts[i] = { };
+        out.contacts[i].point = points[i];
+        out.contacts[i].depth = depths[i];
+        out.contacts[i].id = ids[i];
     }
 
+    return true;
+}
+
+static bool manifold_get_poly_poly_sat(const PsxCollider& R1, const PsxCollider& R2, PsxManifold& out, U32& axis) {
     Vec2 normal = {0, 0};
     F32 depth = FLT_MAX;
 
@@ -271,61 +621,117 @@ static Inst manifold_get_poly_poly(const PsxCollider& R1, const PsxCollider& R2)
     const Vec2* poly_b       = R2.poly.transform;
     U32         poly_b_count = R2.poly.count;
 
-    if (!algo_separate_axis(poly_a, poly_a_count, poly_b, poly_b_count, normal, depth)) { return NO_INSTANCE; }
-    if (!algo_separate_axis(poly_b, poly_b_count, poly_a, poly_a_count, normal, depth)) { return NO_INSTANCE; }
+    // last step's separating axis first, the handle may have been reused so the edge is range checked
+    if (axis != NO_INSTANCE) {
+        const PsxPolyCollider& P = (axis & SAT_AXIS_B) ? R2.poly : R1.poly;
+        U32 edge = axis & ~SAT_AXIS_B;
+
+        if (edge < P.count && algo_axis_separates(poly_a, poly_a_count, poly_b, poly_b_count, P.normals[edge])) {
+            return false;
+        }
+    }
+
+    U32 edge;
+    if (!algo_separate_axis(poly_a, R1.poly.normals, poly_a_count, poly_b, poly_b_count, normal, depth, edge)) {
+        axis = edge;
+        return false;
+    }
+
+    if (!algo_separate_axis(poly_b, R2.poly.normals, poly_b_count, poly_a, poly_a_count, normal, depth, edge)) {
+        axis = edge | SAT_AXIS_B;
+        return false;
+    }
+
+    axis = NO_INSTANCE;
 
-    bool colliding = true;
     Vec2 dir = R2.poly.center - R1.poly.center;
     if (vec2_dot(normal, dir) < 0.f) normal = -normal;
-    Vec2 tangent = vec2_perp(normal);
-    Vec2 contact{};
 
-    if (collider_get_flags(R1, SPACIAL_FLAG_RIGID) || 
-        collider_get_flags(R2, SPACIAL_FLAG_RIGID)
-    ) {
-        contact = algo_get_contact_point(
-            poly_a, poly_a_count, 
-            poly_b, poly_b_count, 
-            normal
-        );
+    return manifold_poly_contacts(R1, R2, normal, out);
+}
+
+static bool manifold_get_poly_poly_gjk(const PsxCollider& R1, const PsxCollider& R2, PsxManifold& out, U32& axis) {
+    const Vec2* poly_a       = R1.poly.transform;
+    U32         poly_a_count = R1.poly.count;
+    const Vec2* poly_b       = R2.poly.transform;
+    U32         poly_b_count = R2.poly.count;
+
+    // seeded with last step's closest support pair, gjk range checks it
+    PsxSimplex simplex;
+    simplex.count = 0;
+
+    if (axis != NO_INSTANCE && (axis & SAT_AXIS_GJK) && !(axis & SAT_AXIS_B)) {
+        simplex.v[0].ia = (axis >> 15) & 0x7fff;
+        simplex.v[0].ib = axis & 0x7fff;
+        simplex.count = 1;
     }
 
-    return manifold_new(
-        R1.id, R2.id, 
-        colliding, 
-        normal, 
-        tangent, 
-        contact, 
-        depth
-    );
+    if (!algo_gjk(poly_a, poly_a_count, poly_b, poly_b_count, simplex)) {
+        axis = SAT_AXIS_GJK | (simplex.v[0].ia << 15) | simplex.v[0].ib;
+        return false;
+    }
+
+    axis = NO_INSTANCE;
+
+    // only touching, there is no triangle to expand
+    Vec2 normal;
+    F32 depth;
+    if (!algo_epa(poly_a, R1.poly.normals, poly_a_count, poly_b, R2.poly.normals, poly_b_count, simplex, normal, depth)) {
+        return manifold_get_poly_poly_sat(R1, R2, out, axis);
+    }
+
+    // clipping found no reference face, sat tests every axis
+    if (!manifold_poly_contacts(R1, R2, normal, out)) {
+        return manifold_get_poly_poly_sat(R1, R2, out, axis);
+    }
+
+    return true;
 }
 
-static Inst manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C) {
-    if (R.shape != SHAPE_POLY || C.shape != SHAPE_CIRCLE) {
-        return NO_INSTANCE;
+static bool manifold_get_poly_poly(const PsxCollider& R1, const PsxCollider& R2, PsxManifold& out, U32& axis) {
+    if (R1.poly.count < 2 || R2.poly.count < 2) {
+        return false;
+    }
+
+    // sat tests every vertex against every edge, gjk only climbs to the support vertices
+    if (R1.poly.count + R2.poly.count >= manifold_state().gjk_min_vertices) {
+        return manifold_get_poly_poly_gjk(R1, R2, out, axis);
+    }
+
+    return manifold_get_poly_poly_sat(R1, R2, out, axis);
+}
+
+static bool manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C, PsxManifold& out, U32& sat_axis) {
+    const Vec2* poly    = R.poly.transform;
+    const Vec2* normals = R.poly.normals;
+    const U32   count   = R.poly.count;
+    const Vec2  C_pos   = collider_get_pos(C);
+    const Vec2  R_pos   = collider_get_pos(R);
+
+    // last step's separating edge first
+    if (sat_axis < count) {
+        F32 minP, maxP;
+        algo_project_1d(poly, count, normals[sat_axis], minP, maxP);
+
+        F32 cproj = vec2_dot(C_pos, normals[sat_axis]);
+        if (!algo_overlap_1d(minP, maxP, cproj - C.circ.radius, cproj + C.circ.radius)) {
+            return false;
+        }
     }
 
-    const Vec2* poly  = R.poly.transform;
-    const U32   count = R.poly.count;
-    const Vec2  C_pos = collider_get_pos(C);
-    const Vec2  R_pos = collider_get_pos(R);
+    sat_axis = NO_INSTANCE;
 
     F32 best_overlap = FLT_MAX;
     Vec2 best_axis   = { 0.f, 0.f };
     Vec2 axis;
 
     for (U32 i = 0; i < count; ++i) {
-        U32 j = (i + 1) % count;
-
-        Vec2 edge = poly[j] - poly[i];
-        axis = vec2_perp(edge);
+        axis = normals[i];
 
         if (axis.x == 0.f && axis.y == 0.f) {
             continue;
         }
 
-        axis = vec2_normal(axis);
-
         F32 minP, maxP;
         algo_project_1d(poly, count, axis, minP, maxP);
 
@@ -335,7 +741,8 @@ static Inst manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C)
 
         // no overlap on this axis -> separating axis -> no collision
         if (!algo_overlap_1d(minP, maxP, minC, maxC)) {
-            return NO_INSTANCE;
+            sat_axis = i;
+            return false;
         }
 
         // compute overlap on this axis
@@ -369,7 +776,7 @@ static Inst manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C)
         F32 maxC  = cproj + C.circ.radius;
 
         if (!algo_overlap_1d(minP, maxP, minC, maxC)) {
-            return NO_INSTANCE;
+            return false;
         }
 
         F32 overlap = fminf(maxP, maxC) - fmaxf(minP, minC);
@@ -397,7 +804,7 @@ static Inst manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C)
     Vec2 contact = (-normal * C.circ.radius) + C_pos;
 
     bool colliding = true;
-    return manifold_new(
+    return manifold_fill(out,
         R.id, C.id, 
         colliding, 
         normal, 
@@ -407,32 +814,20 @@ static Inst manifold_get_poly_circle(const PsxCollider& R, const PsxCollider& C)
     );
 }
 
-static Inst manifold_get_circ_circ(const PsxCollider& CA, const PsxCollider& CB) {
-    if (CA.shape != SHAPE_CIRCLE || CB.shape != SHAPE_CIRCLE) {
-        return NO_INSTANCE;
-    }
-    
-    Vec2 p1 = collider_get_pos(CA);
-    Vec2 p2 = collider_get_pos(CB);
-
-    Vec2 diff = p2 - p1;
+// overlapping circles, p1 and p2 are the centers and dist_sq their squared distance
+static bool manifold_circ_circ_fill(const PsxCollider& CA, const PsxCollider& CB, Vec2 p1, Vec2 p2, F32 dist_sq, PsxManifold& out) {
     F32 tot_rad = CA.circ.radius + CB.circ.radius;
-    F32 tot_rad_sq = tot_rad * tot_rad;
-    F32 tot_dis_sq = vec2_length_sq(diff);
-
-    bool colliding = tot_dis_sq < tot_rad_sq;
-    if (!colliding) { return NO_INSTANCE; }
 
     // manifold data
-    F32 dist = sqrtf(tot_dis_sq);
-    Vec2 normal = vec2_normal(diff, dist, { 1, 0 });
+    F32 dist = sqrtf(dist_sq);
+    Vec2 normal = vec2_normal(p2 - p1, dist, { 1, 0 });
     Vec2 tangent = vec2_perp(normal);
     F32 depth = tot_rad - dist;
     Vec2 contact = p1 + normal * CA.circ.radius;
 
-    return manifold_new( 
+    return manifold_fill(out,
         CA.id, CB.id, 
-        colliding, 
+        true, 
         normal, 
         tangent, 
         contact, 
@@ -440,35 +835,503 @@ static Inst manifold_get_circ_circ(const PsxCollider& CA, const PsxCollider& CB)
     );
 }
 
+static bool manifold_get_circ_circ(const PsxCollider& CA, const PsxCollider& CB, PsxManifold& out, U32& axis) {
+    axis = NO_INSTANCE;
+
+    Vec2 p1 = collider_get_pos(CA);
+    Vec2 p2 = collider_get_pos(CB);
+
+    Vec2 diff = p2 - p1;
+    F32 tot_rad = CA.circ.radius + CB.circ.radius;
+    F32 tot_dis_sq = diff.x * diff.x + diff.y * diff.y;
+
+    if (!(tot_dis_sq < tot_rad * tot_rad)) { return false; }
+
+    return manifold_circ_circ_fill(CA, CB, p1, p2, tot_dis_sq, out);
+}
+
+// poly routine with the shapes the other way around, the manifold still goes from the polygon to the circle
+static bool manifold_get_circle_poly(const PsxCollider& C, const PsxCollider& R, PsxManifold& out, U32& axis) {
+    return manifold_get_poly_circle(R, C, out, axis);
+}
+
+/*
+    capsules and segments, a segment is a capsule of radius 0. every
+    routine works on the core segments and adds the radii afterwards
+*/
+
+// two capsules, contacts are on the surface of CA and the normal points from CA to CB
+static bool manifold_get_caps_caps(const PsxCollider& CA, const PsxCollider& CB, PsxManifold& out, U32& axis) {
+    axis = NO_INSTANCE;
+
+    const PsxCapsuleCollider& A = CA.caps;
+    const PsxCapsuleCollider& B = CB.caps;
+    F32 radius = A.radius + B.radius;
+
+    Vec2 pa, pb;
+    F32 dist_sq = algo_segments_closest(A.world[0], A.world[1], B.world[0], B.world[1], pa, pb);
+    if (!(dist_sq < radius * radius)) return false;
+
+    Vec2 da = A.world[1] - A.world[0];
+    Vec2 db = B.world[1] - B.world[0];
+    F32 len_a = vec2_length(da);
+    F32 len_b = vec2_length(db);
+
+    F32 dist = sqrtf(dist_sq);
+
+    // crossing cores, push b out along the side of a its center is on
+    if (dist == 0.f) {
+        Vec2 side = vec2_normal(vec2_perp(da), len_a, { 0, 1 });
+        Vec2 mid = (B.world[0] + B.world[1]) * 0.5f - A.world[0];
+        if (vec2_dot(side, mid) < 0.f) side = -side;
+
+        F32 below = fminf(vec2_dot(side, B.world[0] - A.world[0]), vec2_dot(side, B.world[1] - A.world[0]));
+        return manifold_fill(out, CA.id, CB.id, true, side, vec2_perp(side), pa, radius - below);
+    }
+
+    Vec2 normal = (pb - pa) / dist;
+
+    // lying on each other, clip b's core to the extent of a's for two contacts
+    if (len_a > 0.f && len_b > 0.f && fabsf(vec2_cross(da, db)) < CFG_CAPSULE_PARALLEL * len_a * len_b) {
+        Vec2 ua = da / len_a;
+        Vec2 side = vec2_perp(ua);
+        if (vec2_dot(side, normal) < 0.f) side = -side;
+
+        // side by side, end to end the caps touch in one point
+        if (vec2_dot(side, normal) > 1.f - CFG_CAPSULE_PARALLEL) {
+            const U32 ids[2] = { 0, 1 };
+            Vec2 clip1[2], clip2[2];
+            U32 clip1_ids[2], clip2_ids[2];
+
+            if (algo_clip_segment(B.world, ids, clip1, clip1_ids, -ua, -vec2_dot(ua, A.world[0]), 2) == 2 &&
+                algo_clip_segment(clip1, clip1_ids, clip2, clip2_ids, ua, vec2_dot(ua, A.world[1]), 3) == 2) {
+
+                manifold_fill(out, CA.id, CB.id, true, side, vec2_perp(side), pa, 0.f);
+                out.contact_count = 0;
+
+                for (U32 i = 0; i < 2; ++i) {
+                    F32 separation = vec2_dot(side, clip2[i] - A.world[0]);
+                    if (separation >= radius) continue;
+
+                    PsxContact& c = out.contacts[out.contact_count++];
+                    c = { };
+                    c.point = clip2[i] - side * (separation - A.radius);
+                    c.depth = radius - separation;
+                    c.id = clip2_ids[i];
+                }
+
+                if (out.contact_count > 0) return true;
+            }
+        }
+    }
+
+    return manifold_fill(out, CA.id, CB.id, true, normal, vec2_perp(normal), pa + normal * A.radius, radius - dist);
+}
+
+// capsule and circle, the normal points from the capsule to the circle
+static bool manifold_get_caps_circle(const PsxCollider& K, const PsxCollider& C, PsxManifold& out, U32& axis) {
+    axis = NO_INSTANCE;
+
+    const PsxCapsuleCollider& caps = K.caps;
+    Vec2 center = collider_get_pos(C);
+    F32 radius = caps.radius + C.circ.radius;
+
+    F32 t;
+    Vec2 q = algo_closest_on_segment(caps.world[0], caps.world[1], center, t);
+
+    Vec2 d = center - q;
+    F32 dist_sq = vec2_length_sq(d);
+    if (!(dist_sq < radius * radius)) return false;
+
+    F32 dist = sqrtf(dist_sq);
+    Vec2 normal = vec2_normal(d, dist, vec2_normal(vec2_perp(caps.world[1] - caps.world[0]), { 0, 1 }));
+
+    return manifold_fill(out, K.id, C.id, true, normal, vec2_perp(normal), q + normal * caps.radius, radius - dist);
+}
+
+static bool manifold_get_circle_caps(const PsxCollider& C, const PsxCollider& K, PsxManifold& out, U32& axis) {
+    return manifold_get_caps_circle(K, C, out, axis);
+}
+
+/*
+    polygon and capsule, sat over the polygon's edge normals and both sides
+    of the core. a gap smaller than the radius is checked against the
+    closest features since a rounded end reaches less far into a corner
+    than the face planes say. the normal points from the polygon to the
+    capsule, axes are cached like polygon pairs with the core's sides as b
+*/
+static bool manifold_get_poly_caps(const PsxCollider& R, const PsxCollider& K, PsxManifold& out, U32& axis) {
+    const Vec2* poly    = R.poly.transform;
+    const Vec2* normals = R.poly.normals;
+    const U32   count   = R.poly.count;
+    const Vec2* core    = K.caps.world;
+    const F32   radius  = K.caps.radius;
+
+    if (count < 2) return false;
+
+    Vec2 side = vec2_normal(vec2_perp(core[1] - core[0]));
+    const Vec2 core_normals[2] = { side, -side };
+
+    // core is a point, the capsule is a circle
+    if (side.x == 0.f && side.y == 0.f) {
+        axis = NO_INSTANCE;
+
+        Vec2 normal;
+        F32 dist = algo_point_poly_distance(poly, count, core[0], normal);
+        if (!(dist < radius)) return false;
+
+        return manifold_fill(out, R.id, K.id, true, normal, vec2_perp(normal), core[0] - normal * radius, radius - dist);
+    }
+
+    // last step's separating axis first
+    if (axis != NO_INSTANCE) {
+        F32 gap = -FLT_MAX;
+
+        if (axis & SAT_AXIS_B) {
+            Vec2 n = core_normals[axis & 1];
+
+            gap = FLT_MAX;
+            for (U32 i = 0; i < count; ++i) gap = fminf(gap, vec2_dot(n, poly[i] - core[0]));
+        } else if (axis < count) {
+            gap = fminf(vec2_dot(normals[axis], core[0] - poly[axis]), vec2_dot(normals[axis], core[1] - poly[axis]));
+        }
+
+        if (gap > radius) return false;
+    }
+
+    F32 best = -FLT_MAX;
+    Vec2 best_normal = { 0, 0 };
+
+    for (U32 i = 0; i < count; ++i) {
+        Vec2 n = normals[i];
+        if (n.x == 0.f && n.y == 0.f) continue;
+
+        F32 gap = fminf(vec2_dot(n, core[0] - poly[i]), vec2_dot(n, core[1] - poly[i]));
+        if (gap > radius) {
+            axis = i;
+            return false;
+        }
+
+        if (gap > best) {
+            best = gap;
+            best_normal = n;
+        }
+    }
+
+    for (U32 s = 0; s < 2; ++s) {
+        Vec2 n = core_normals[s];
+
+        F32 gap = FLT_MAX;
+        for (U32 i = 0; i < count; ++i) gap = fminf(gap, vec2_dot(n, poly[i] - core[0]));
+
+        if (gap > radius) {
+            axis = SAT_AXIS_B | s;
+            return false;
+        }
+
+        if (gap > best) {
+            best = gap;
+            best_normal = -n;
+        }
+    }
+
+    axis = NO_INSTANCE;
+
+    // the cores are apart, find the closest features
+    Vec2 p = core[0], q = core[0];
+    F32 dist = 0.f;
+
+    if (best > 0.f) {
+        F32 dist_sq = FLT_MAX;
+
+        for (U32 i = 0; i < count; ++i) {
+            Vec2 pi, qi;
+            F32 d = algo_segments_closest(poly[i], poly[(i + 1) % count], core[0], core[1], pi, qi);
+
+            if (d < dist_sq) {
+                dist_sq = d;
+                p = pi;
+                q = qi;
+            }
+        }
+
+        if (!(dist_sq < radius * radius)) return false;
+
+        // a corner against a rounded end, one contact along the closest features
+        dist = sqrtf(dist_sq);
+        if (dist - best > CFG_CAPSULE_FACE_SLOP) {
+            Vec2 normal = vec2_normal(q - p, dist, best_normal);
+            return manifold_fill(out, R.id, K.id, true, normal, vec2_perp(normal), p, radius - dist);
+        }
+    }
+
+    // resting on a face, clip the core as a 2 vertex polygon
+    Vec2 points[MM_MAX_CONTACT_PTS];
+    F32  depths[MM_MAX_CONTACT_PTS];
+    U32  ids[MM_MAX_CONTACT_PTS];
+
+    Vec2 normal = best_normal;
+    U32 contacts = algo_clip_contacts(
+        poly, normals, count,
+        core, core_normals, 2,
+        normal,
+        points, depths, ids,
+        radius
+    );
+
+    // the core hangs past the side planes of the face
+    if (contacts == 0) {
+        if (!(best > 0.f)) return false;
+
+        normal = vec2_normal(q - p, dist, best_normal);
+        return manifold_fill(out, R.id, K.id, true, normal, vec2_perp(normal), p, radius - dist);
+    }
+
+    manifold_fill(out, R.id, K.id, true, normal, vec2_perp(normal), points[0], depths[0]);
+
+    out.contact_count = contacts;
+    for (U32 i = 0; i < contacts; ++i) {
+        out.contacts[i] = { };
+        out.contacts[i].point = points[i];
+        out.contacts[i].depth = depths[i];
+        out.contacts[i].id = ids[i];
+    }
+
+    return true;
+}
+
+static bool manifold_get_caps_poly(const PsxCollider& K, const PsxCollider& R, PsxManifold& out, U32& axis) {
+    return manifold_get_poly_caps(R, K, out, axis);
+}
+
+/*
+    dispatch. every shape pair has its own routine and batch, the
+    broadphase buckets candidate pairs by kind so each batch runs one
+    routine over pairs of the same shapes
+*/
+
+typedef bool (*PsxCollideFn)(const PsxCollider& a, const PsxCollider& b, PsxManifold& out, U32& axis);
+
+// one routine per pair of shapes, rows are the first collider's shape
+static const PsxCollideFn g_manifold_collide[MM_SHAPE_KINDS][MM_SHAPE_KINDS] = {
+    /*            none     circle                    poly                      capsule                  */
+    /* none    */ { nullptr, nullptr,                  nullptr,                  nullptr                  },
+    /* circle  */ { nullptr, manifold_get_circ_circ,   manifold_get_circle_poly, manifold_get_circle_caps },
+    /* poly    */ { nullptr, manifold_get_poly_circle, manifold_get_poly_poly,   manifold_get_poly_caps   },
+    /* capsule */ { nullptr, manifold_get_caps_circle, manifold_get_caps_poly,   manifold_get_caps_caps   },
+};
+
+U32 manifold_shape_kind(U32 shape) {
+    switch (shape) {
+        case SHAPE_CIRCLE  : return 1;
+        case SHAPE_POLY    : return 2;
+        case SHAPE_CAPSULE : return 3;
+        case SHAPE_SEGMENT : return 3;
+        default            : return 0;
+    }
+}
+
+U32 manifold_pair_kind(U32 shape_a, U32 shape_b) {
+    return manifold_shape_kind(shape_a) * MM_SHAPE_KINDS + manifold_shape_kind(shape_b);
+}
+
+// pairs of one kind through its routine, separating axes are cached for them
+template <PsxCollideFn fn>
+static void manifold_batch(PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts) {
+    PsxManifold m;
+
+    for (U32 i = 0; i < count; ++i) {
+        PsxCollidePair& p = pairs[i];
+        p.axis = manifold_sat_axis(p.a, p.b);
+
+        if (fn(collider_get(p.a), collider_get(p.b), m, p.axis)) {
+            contacts.push_back(m);
+        }
+    }
+}
+
+// circles are tested in SIMD rows, only the overlapping ones build a manifold
+static void manifold_batch_circ_circ(PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts) {
+    thread_local std::vector<F32> rows;
+    thread_local std::vector<U32> hit;
+
+    rows.resize(count * 6);
+    hit.resize(count);
+
+    PsxKernelCircles c = {
+        .ax = rows.data(),
+        .ay = rows.data() + count,
+        .bx = rows.data() + count * 2,
+        .by = rows.data() + count * 3,
+        .radius = rows.data() + count * 4,
+        .dist_sq = rows.data() + count * 5,
+        .hit = hit.data(),
+        .count = count,
+    };
+
+    for (U32 i = 0; i < count; ++i) {
+        const PsxCollider& ca = collider_get(pairs[i].a);
+        const PsxCollider& cb = collider_get(pairs[i].b);
+
+        Vec2 pa = collider_get_pos(ca);
+        Vec2 pb = collider_get_pos(cb);
+
+        rows[i]             = pa.x;
+        rows[count + i]     = pa.y;
+        rows[count * 2 + i] = pb.x;
+        rows[count * 3 + i] = pb.y;
+        rows[count * 4 + i] = ca.circ.radius + cb.circ.radius;
+
+        pairs[i].axis = NO_INSTANCE;
+    }
+
+    kernel_collide_circles(c);
+
+    PsxManifold m;
+    for (U32 i = 0; i < count; ++i) {
+        if (!hit[i]) continue;
+
+        Vec2 pa = { c.ax[i], c.ay[i] };
+        Vec2 pb = { c.bx[i], c.by[i] };
+
+        manifold_circ_circ_fill(collider_get(pairs[i].a), collider_get(pairs[i].b), pa, pb, c.dist_sq[i], m);
+        contacts.push_back(m);
+    }
+}
+
+// pairs without a routine never touch
+static void manifold_batch_none(PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts) {
+    (void) contacts;
+    for (U32 i = 0; i < count; ++i) pairs[i].axis = NO_INSTANCE;
+}
+
+static const PsxCollideBatchFn g_manifold_batch[MM_PAIR_KINDS] = {
+    manifold_batch_none, manifold_batch_none,                          manifold_batch_none,                          manifold_batch_none,
+    manifold_batch_none, manifold_batch_circ_circ,                     manifold_batch<manifold_get_circle_poly>,     manifold_batch<manifold_get_circle_caps>,
+    manifold_batch_none, manifold_batch<manifold_get_poly_circle>,     manifold_batch<manifold_get_poly_poly>,       manifold_batch<manifold_get_poly_caps>,
+    manifold_batch_none, manifold_batch<manifold_get_caps_circle>,     manifold_batch<manifold_get_caps_poly>,       manifold_batch<manifold_get_caps_caps>,
+};
+
+void manifold_collide_batch(U32 kind, PsxCollidePair* pairs, U32 count, std::vector<PsxManifold>& contacts) {
+    g_manifold_batch[kind](pairs, count, contacts);
+}
+
 /*
     get a manifold
 */
 
-Inst manifold_generate(U32 collider_a, U32 collider_b) {
-    PsxCollider& ca = collider_get(collider_a);
+bool manifold_collide(U32 collider_a, U32 collider_b, PsxManifold& out, U32& axis) {
+    const PsxCollider& ca = collider_get(collider_a);
     const PsxCollider& cb = collider_get(collider_b);
-    Inst manifold = NO_INSTANCE;
 
-    if ((ca.shape == SHAPE_POLY && cb.shape == SHAPE_CIRCLE)) {
-        manifold = manifold_get_poly_circle(ca, cb);
+    PsxCollideFn fn = g_manifold_collide[manifold_shape_kind(ca.shape)][manifold_shape_kind(cb.shape)];
+
+    if (!fn) {
+        axis = NO_INSTANCE;
+        return false;
     }
 
-    else if ((ca.shape == SHAPE_CIRCLE && cb.shape == SHAPE_POLY)) {
-        manifold = manifold_get_poly_circle(cb, ca);
+    return fn(ca, cb, out, axis);
+}
+
+bool manifold_collide(U32 collider_a, U32 collider_b, PsxManifold& out) {
+    U32 axis = NO_INSTANCE;
+    return manifold_collide(collider_a, collider_b, out, axis);
+}
+
+Inst manifold_store(const PsxManifold& m) {
+    PsxManifoldState& state = manifold_state();
+
+    manifold_table_reserve();
+
+    U32 slot = manifold_table_find(manifold_key(m));
+    bool cached = state.table[slot] != 0;
+
+    PsxManifold& dst = cached ? state.manifolds[state.table[slot] - 1] : manifold_alloc();
+
+    if (!cached) {
+        state.table[slot] = dst.index + 1;
+
+        const PsxCollider& colA = collider_get(m.collider_a);
+        const PsxCollider& colB = collider_get(m.collider_b);
+
+        dst.friction = material_mix_friction(colA.material, colB.material);
+        dst.restitution = material_mix_restitution(colA.material, colB.material);
     }
 
-    else if ((ca.shape | cb.shape) == SHAPE_CIRCLE) {
-        manifold = manifold_get_circ_circ(ca, cb);
+    // carry accumulated impulses over to contacts with the same feature
+    PsxContact old[MM_MAX_CONTACT_PTS];
+    U32 old_count = dst.contact_count;
+    for (U32 i = 0; i < old_count; ++i) old[i] = dst.contacts[i];
+
+    dst.collider_a = m.collider_a;
+    dst.collider_b = m.collider_b;
+    dst.spacial_a = collider_get(m.collider_a).spacial;
+    dst.spacial_b = collider_get(m.collider_b).spacial;
+    dst.colliding = m.colliding;
+    dst.normal = m.normal;
+    dst.tangent = m.tangent;
+    dst.contact_count = m.contact_count;
+    dst.step = state.step;
+    dst.sleeping = false; // touched by an awake body, islands_build wakes the rest
+
+    for (U32 i = 0; i < m.contact_count; ++i) {
+        PsxContact& c = dst.contacts[i];
+        c = m.contacts[i];
+        c.normal_impulse = 0.f;
+        c.tangent_impulse = 0.f;
+
+        for (U32 j = 0; j < old_count; ++j) {
+            if (old[j].id == c.id) {
+                c.normal_impulse = old[j].normal_impulse;
+                c.tangent_impulse = old[j].tangent_impulse;
+                break;
+            }
+        }
     }
 
-    else if ((ca.shape | cb.shape) == SHAPE_POLY) {
-        manifold = manifold_get_poly_poly(ca, cb);
+    return dst.index;
+}
+
+Inst manifold_new(
+    Inst collider_a, 
+    Inst collider_b, 
+    bool colliding,
+    Vec2 normal,
+    Vec2 tangent,
+    Vec2 contact,
+    F32  depth
+) {
+    PsxManifold m;
+    manifold_fill(m, collider_a, collider_b, colliding, normal, tangent, contact, depth);
+    return manifold_store(m);
+}
+
+Inst manifold_generate(U32 collider_a, U32 collider_b) {
+    PsxManifold m;
+
+    if (!manifold_collide(collider_a, collider_b, m)) {
+        return NO_INSTANCE;
     }
 
+    return manifold_store(m);
+}
+
+U32 count_manifold_slots() {
+    return manifold_state().manifolds.count;
+}
+
+U64 manifold_memory_bytes() {
+    PsxManifoldState& state = manifold_state();
 
-    return manifold;
+    return state.manifolds.bytes() + (U64) state.table_size * sizeof(U32)
+        + (state.sat.capacity() + state.sat_next.capacity()) * sizeof(PsxSatEntry);
 }
 
 U32 count_manifolds() {
-    return total_manifolds;
-}
\ No newline at end of file
+    return manifold_state().total;
+}
+
+U32 count_manifolds_created() {
+    return manifold_state().created;
+}
@@ -1,9 +1,24 @@
 #include "psx_material.h"
+#include "vector.h"
+#include "psx_pool.h"
+#include "psx_world.h"
 
-static PsxMaterial g_materials[CFG_MAX_MATERIALS] = { };
-static U32 g_materials_free[CFG_MAX_MATERIALS] = { };
-static U32 g_materials_free_top = 0;
-static U32 g_next_material = 0;
+struct PsxMaterialState {
+    PsxPool<PsxMaterial> materials;
+};
+
+static PsxMaterialState& material_state() {
+    return *world_current()->material;
+}
+
+PsxMaterialState* material_state_new() {
+    return new PsxMaterialState();
+}
+
+void material_state_free(PsxMaterialState* state) {
+    state->materials.release();
+    delete state;
+}
 
 PsxMaterial g_default_material = {
     .friction = 0.f,
@@ -15,38 +30,32 @@ PsxMaterial g_default_material = {
 };
 
 PsxMaterial& material_get(Inst material) {
-    if (material >= g_next_material) {
+    PsxMaterialState& state = material_state();
+
+    if (!state.materials.valid(material)) {
         THROW("Manifold: attempt to get invalid material");
     }
 
-    return g_materials[material];
+    return state.materials[material];
 }
 
-PsxMaterial& material_alloc() {
-    Inst material;
-
-    if (g_materials_free_top > 0) {
-        g_materials_free_top--;
-        material = g_materials_free[g_materials_free_top];
-    }
-
-    else {
-        if (g_next_material >= CFG_MAX_MANIFOLDS) {
-            THROW("Physics: no more materials");
-        }
+bool material_valid(Inst material) {
+    return material_state().materials.valid(material);
+}
 
-        material = g_next_material++;
-    }
+PsxMaterial& material_alloc() {
+    PsxMaterialState& state = material_state();
 
+    U32 slot = state.materials.alloc();
 
     // instance new material at index
-    PsxMaterial& m = g_materials[material];
+    PsxMaterial& m = state.materials[slot];
 
     if (m.in_use) {
-        THROW("Physics: got material in use @ index=%i", material);
+        THROW("Physics: got material in use @ index=%i", slot);
     }
 
-    m.id = material;
+    m.id = state.materials.handle(slot);
     m.in_use = true;
     m.user_data = nullptr;
 
@@ -54,7 +63,13 @@ PsxMaterial& material_alloc() {
 }
 
 void material_free(Inst material) {
-    PsxMaterial& m = material_get(material);
+    PsxMaterialState& state = material_state();
+
+    if (!state.materials.valid(material)) {
+        return;
+    }
+
+    PsxMaterial& m = state.materials[material];
         
     if (!m.in_use) {
         return;
@@ -63,11 +78,7 @@ void material_free(Inst material) {
     m.in_use = false;
     m.user_data = nullptr;
 
-    if (g_materials_free_top >= CFG_MAX_MANIFOLDS) {
-        THROW("Physics: no more free slots");
-    }
-
-    g_materials_free[g_materials_free_top++] = m.id;
+    state.materials.free(material);
 }
 
 Inst material_new(PsxMaterialConfig config) {
@@ -85,4 +96,16 @@ F32 material_get_friction(Inst material) {
 
 F32 material_get_restitution(Inst material) {
     return (material == NO_INSTANCE) ? g_default_material.restitution : material_get(material).restitution;
+}
+
+F32 material_mix_friction(Inst a, Inst b) {
+    return sqrtf(material_get_friction(a) * material_get_friction(b));
+}
+
+F32 material_mix_restitution(Inst a, Inst b) {
+    return f32_clamp(fmaxf(material_get_restitution(a), material_get_restitution(b)), 0.f, 1.f);
+}
+
+U64 material_memory_bytes() {
+    return material_state().materials.bytes();
 }
\ No newline at end of file
@@ -1,33 +1,106 @@
 #include "psx_partition.h"
-#include "analytics.h"
+#include "psx_job.h"
+#include "psx_profile.h"
+#include "psx_pool.h"
+#include "psx_world.h"
+#include <vector>
+#include <algorithm>
+
+struct BvhNodePair { U32 a; U32 b; };
+struct BvhThreadBuffer {
+    std::vector<BvhNodePair> stack;
+    std::vector<BvhNodePair> local_stack; // compound against compound
+    std::vector<PsxCollidePair> buckets[MM_PAIR_KINDS]; // pairs of the running task by shape pair
+    std::vector<PsxCollidePair> candidates;
+    std::vector<PsxManifold> contacts;
+    U32 overlaps = 0; // leaf pairs whose boxes touched, for the profiler
+};
+
+// nodes are stored parent first, so walking them backwards refits the tree
+struct BvhLocalTree {
+    std::vector<BvhNode> nodes;
+    std::vector<Inst> colliders;
+};
+
+struct PsxBvhState {
+    // nodes are recycled through the parent link, the pool only grows
+    PsxPool<BvhNode> nodes;
+    PsxPool<BvhLocalTree> locals;
+    U32 root = NO_INSTANCE;
+    U32 free_head = NO_INSTANCE;
+
+    // pair traversal
+    std::vector<BvhNodePair> tasks;
+    std::vector<BvhNodePair> task_scratch;
+    std::vector<BvhThreadBuffer> buffers;
+    std::vector<PsxManifold> contacts;
+    U32 pairs_tested = 0;
+};
+
+static PsxBvhState& bvh_state() {
+    return *world_current()->bvh;
+}
+
+PsxBvhState* bvh_state_new() {
+    return new PsxBvhState();
+}
 
-static BvhNode g_bvh_nodes[CFG_MAX_COLLIDERS * 2];
-static U32 g_bvh_root = NO_INSTANCE;
-static U32 g_bvh_free_head = NO_INSTANCE;
-static U32 g_bvh_node_count = 0;
+void bvh_state_free(PsxBvhState* state) {
+    state->nodes.release();
+    state->locals.release();
+    delete state;
+}
 
 bool bvh_is_leaf(const BvhNode& node) { 
     return  node.child1 == NO_INSTANCE; 
 };
 
 Inst bvh_new_node() {
-    Inst id = g_bvh_node_count++;
+    PsxBvhState& state = bvh_state();
+
+    Inst id;
 
-    BvhNode& node = g_bvh_nodes[id];
+    if (state.free_head != NO_INSTANCE) {
+        id = state.free_head;
+        state.free_head = state.nodes[id].parent;
+    }
+
+    else {
+        id = state.nodes.alloc();
+    }
+
+    BvhNode& node = state.nodes[id];
     node.parent   = NO_INSTANCE;
     node.child1   = NO_INSTANCE;
     node.child2   = NO_INSTANCE;
     node.collider = NO_INSTANCE;
+    node.height   = 0;
+    node.dynamic  = false;
 
     return id;
 }
 
+void bvh_free_node(Inst id) {
+    PsxBvhState& state = bvh_state();
+
+    BvhNode& node = bvh_get_node(id);
+    node.parent = state.free_head;
+    node.height = -1;
+    state.free_head = id;
+}
+
 BvhNode& bvh_get_node(Inst id) {
-    if (id > g_bvh_node_count) {
+    PsxBvhState& state = bvh_state();
+
+    if (id >= state.nodes.count) {
         THROW("attempt to get invalid node in BVH");
     }
 
-    return g_bvh_nodes[id];
+    return state.nodes[id];
+}
+
+Inst bvh_get_root() {
+    return bvh_state().root;
 }
 
 void bvh_set_node_parent(Inst id, Inst parent) {
@@ -38,6 +111,284 @@ const AABB& bvh_get_node_box(Inst id) {
     return bvh_get_node(id).box;
 }
 
+/*
+    incremental updates
+*/
+
+// refresh an internal node from its children
+static void bvh_refit_node(BvhNode& node) {
+    PsxBvhState& state = bvh_state();
+
+    const BvhNode& c1 = state.nodes[node.child1];
+    const BvhNode& c2 = state.nodes[node.child2];
+
+    node.box = glx_aabb_merge(c1.box, c2.box);
+    node.height = 1 + ((c1.height > c2.height) ? c1.height : c2.height);
+    node.dynamic = c1.dynamic || c2.dynamic;
+}
+
+// rotate the subtree at a if it is imbalanced, returns the new subtree root
+static Inst bvh_balance(Inst a) {
+    PsxBvhState& state = bvh_state();
+
+    BvhNode& A = state.nodes[a];
+    if (bvh_is_leaf(A) || A.height < 2) {
+        return a;
+    }
+
+    Inst b = A.child1;
+    Inst c = A.child2;
+    BvhNode& B = state.nodes[b];
+    BvhNode& C = state.nodes[c];
+
+    S32 balance = C.height - B.height;
+
+    // rotate c up
+    if (balance > 1) {
+        Inst f = C.child1;
+        Inst g = C.child2;
+        BvhNode& F = state.nodes[f];
+        BvhNode& G = state.nodes[g];
+
+        // swap a and c
+        C.child1 = a;
+        C.parent = A.parent;
+        A.parent = c;
+
+        if (C.parent != NO_INSTANCE) {
+            BvhNode& P = state.nodes[C.parent];
+            if (P.child1 == a) P.child1 = c;
+            else               P.child2 = c;
+        } else {
+            state.root = c;
+        }
+
+        // keep the taller grandchild under c
+        if (F.height > G.height) {
+            C.child2 = f;
+            A.child2 = g;
+            G.parent = a;
+        } else {
+            C.child2 = g;
+            A.child2 = f;
+            F.parent = a;
+        }
+
+        bvh_refit_node(A);
+        bvh_refit_node(C);
+        return c;
+    }
+
+    // rotate b up
+    if (balance < -1) {
+        Inst d = B.child1;
+        Inst e = B.child2;
+        BvhNode& D = state.nodes[d];
+        BvhNode& E = state.nodes[e];
+
+        // swap a and b
+        B.child1 = a;
+        B.parent = A.parent;
+        A.parent = b;
+
+        if (B.parent != NO_INSTANCE) {
+            BvhNode& P = state.nodes[B.parent];
+            if (P.child1 == a) P.child1 = b;
+            else               P.child2 = b;
+        } else {
+            state.root = b;
+        }
+
+        // keep the taller grandchild under b
+        if (D.height > E.height) {
+            B.child2 = d;
+            A.child1 = e;
+            E.parent = a;
+        } else {
+            B.child2 = e;
+            A.child1 = d;
+            D.parent = a;
+        }
+
+        bvh_refit_node(A);
+        bvh_refit_node(B);
+        return b;
+    }
+
+    return a;
+}
+
+// walk from a node to the root fixing boxes and balance
+static void bvh_refit_upwards(Inst id) {
+    while (id != NO_INSTANCE) {
+        id = bvh_balance(id);
+
+        BvhNode& node = bvh_state().nodes[id];
+        bvh_refit_node(node);
+
+        id = node.parent;
+    }
+}
+
+static void bvh_insert_leaf(Inst leaf) {
+    PsxBvhState& state = bvh_state();
+
+    if (state.root == NO_INSTANCE) {
+        state.root = leaf;
+        state.nodes[leaf].parent = NO_INSTANCE;
+        return;
+    }
+
+    // find the cheapest sibling using the perimeter as surface area
+    const AABB leaf_box = state.nodes[leaf].box;
+    Inst index = state.root;
+
+    while (!bvh_is_leaf(state.nodes[index])) {
+        const BvhNode& node = state.nodes[index];
+
+        F32 area = glx_aabb_perimeter(node.box);
+        F32 combined_area = glx_aabb_perimeter(glx_aabb_merge(node.box, leaf_box));
+
+        // cost of making a new parent for this node and the leaf
+        F32 cost = 2.f * combined_area;
+
+        // minimum cost of pushing the leaf further down
+        F32 inheritance_cost = 2.f * (combined_area - area);
+
+        F32 child_cost[2];
+        Inst children[2] = { node.child1, node.child2 };
+
+        for (U32 i = 0; i < 2; ++i) {
+            const BvhNode& child = state.nodes[children[i]];
+            F32 merged = glx_aabb_perimeter(glx_aabb_merge(leaf_box, child.box));
+
+            child_cost[i] = bvh_is_leaf(child)
+                ? merged + inheritance_cost
+                : (merged - glx_aabb_perimeter(child.box)) + inheritance_cost;
+        }
+
+        if (cost < child_cost[0] && cost < child_cost[1]) {
+            break;
+        }
+
+        index = (child_cost[0] < child_cost[1]) ? children[0] : children[1];
+    }
+
+    // create a new parent for the sibling and the leaf
+    Inst sibling = index;
+    Inst old_parent = state.nodes[sibling].parent;
+    Inst new_parent = bvh_new_node();
+
+    BvhNode& P = state.nodes[new_parent];
+    P.parent = old_parent;
+    P.child1 = sibling;
+    P.child2 = leaf;
+
+    if (old_parent != NO_INSTANCE) {
+        BvhNode& O = state.nodes[old_parent];
+        if (O.child1 == sibling) O.child1 = new_parent;
+        else                     O.child2 = new_parent;
+    } else {
+        state.root = new_parent;
+    }
+
+    state.nodes[sibling].parent = new_parent;
+    state.nodes[leaf].parent = new_parent;
+
+    bvh_refit_upwards(new_parent);
+}
+
+static void bvh_remove_leaf(Inst leaf) {
+    PsxBvhState& state = bvh_state();
+
+    if (leaf == state.root) {
+        state.root = NO_INSTANCE;
+        return;
+    }
+
+    Inst parent = state.nodes[leaf].parent;
+    Inst grand_parent = state.nodes[parent].parent;
+    Inst sibling = (state.nodes[parent].child1 == leaf) 
+        ? state.nodes[parent].child2 
+        : state.nodes[parent].child1;
+
+    // sibling takes the place of the parent
+    if (grand_parent != NO_INSTANCE) {
+        BvhNode& G = state.nodes[grand_parent];
+        if (G.child1 == parent) G.child1 = sibling;
+        else                    G.child2 = sibling;
+
+        state.nodes[sibling].parent = grand_parent;
+        bvh_free_node(parent);
+
+        bvh_refit_upwards(grand_parent);
+    } else {
+        state.root = sibling;
+        state.nodes[sibling].parent = NO_INSTANCE;
+        bvh_free_node(parent);
+    }
+}
+
+Inst bvh_insert(Inst collider, const AABB& box, bool dynamic) {
+    Inst leaf = bvh_new_node();
+
+    BvhNode& node = bvh_state().nodes[leaf];
+    node.box = glx_aabb_expand(box, CFG_BVH_FAT_MARGIN);
+    node.collider = collider;
+    node.dynamic = dynamic;
+
+    bvh_insert_leaf(leaf);
+    return leaf;
+}
+
+void bvh_remove(Inst leaf) {
+    bvh_remove_leaf(leaf);
+    bvh_free_node(leaf);
+}
+
+bool bvh_move(Inst leaf, const AABB& box, Vec2 displacement) {
+    BvhNode& node = bvh_get_node(leaf);
+
+    if (glx_aabb_contains(node.box, box)) {
+        return false;
+    }
+
+    bvh_remove_leaf(leaf);
+
+    // predict where the box is heading and stretch the fat box that way
+    AABB fat = glx_aabb_expand(box, CFG_BVH_FAT_MARGIN);
+    Vec2 d = displacement * CFG_BVH_DISPLACEMENT_SCALE;
+
+    if (d.x < 0.f) fat.min.x += d.x; else fat.max.x += d.x;
+    if (d.y < 0.f) fat.min.y += d.y; else fat.max.y += d.y;
+
+    node.box = fat;
+    bvh_insert_leaf(leaf);
+
+    return true;
+}
+
+void bvh_set_dynamic(Inst leaf, bool dynamic) {
+    PsxBvhState& state = bvh_state();
+
+    BvhNode& node = state.nodes[leaf];
+    if (node.dynamic == dynamic) return;
+    node.dynamic = dynamic;
+
+    // walk up until a parent already has the right flag
+    for (Inst id = node.parent; id != NO_INSTANCE; id = state.nodes[id].parent) {
+        BvhNode& parent = state.nodes[id];
+        bool any = state.nodes[parent.child1].dynamic || state.nodes[parent.child2].dynamic;
+
+        if (parent.dynamic == any) break;
+        parent.dynamic = any;
+    }
+}
+
+/*
+    bulk build
+*/
+
 U32 bvh_partition_ids(Inst* ids, U32 count, Axis axis, F32 split) {
     U32 left  = 0;
     U32 right = count;
@@ -68,24 +419,48 @@ U32 bvh_partition_ids(Inst* ids, U32 count, Axis axis, F32 split) {
     return left;
 }
 
+// fill a node as the leaf for a collider
+static Inst bvh_make_leaf(Inst node_id, Inst collider) {
+    BvhNode& node = bvh_state().nodes[node_id];
+    PsxCollider& c = collider_get(collider);
+
+    node.collider = collider;
+    node.box = glx_aabb_expand(c.bounding_box, CFG_BVH_FAT_MARGIN);
+    node.dynamic = c.moving_index != NO_INSTANCE; // static and sleeping colliders are off the moving list
+    c.bvh_leaf = node_id;
+
+    return node_id;
+}
+
+static void bvh_link_children(Inst node_id, Inst child1, Inst child2) {
+    BvhNode& node = bvh_state().nodes[node_id];
+
+    node.child1 = child1;
+    node.child2 = child2;
+    node.collider = NO_INSTANCE;
+
+    bvh_set_node_parent(child1, node_id);
+    bvh_set_node_parent(child2, node_id);
+
+    bvh_refit_node(node);
+}
+
+// spatial median split of the longest axis
 Inst bvh_build_recursive(Inst* ids, U32 count) {
     if (count == 0) return NO_INSTANCE;
 
     // base reqs
     Inst first = ids[0];
     Inst node_id = bvh_new_node();
-    BvhNode& node = bvh_get_node(node_id);
 
     if (count == 1) {
-        node.collider = first;
-        node.box = collider_get_bounding_box(first);
-        return node_id;
+        return bvh_make_leaf(node_id, first);
     }
 
     // get box containing all colliders
     AABB combined = collider_get_bounding_box(first);
     for (U32 i = 1; i < count; ++i) {
-        combined = glx_aabb_merge(combined, collider_get_bounding_box(i));
+        combined = glx_aabb_merge(combined, collider_get_bounding_box(ids[i]));
     }
 
     F32 dx = combined.max.x - combined.min.x;
@@ -106,141 +481,692 @@ Inst bvh_build_recursive(Inst* ids, U32 count) {
     Inst* left_ids = ids;
     Inst* right_ids = ids + left_count;
 
-    node.child1 = bvh_build_recursive(left_ids, left_count);
-    node.child2 = bvh_build_recursive(right_ids, right_count);
-    node.collider = NO_INSTANCE;
+    Inst child1 = bvh_build_recursive(left_ids, left_count);
+    Inst child2 = bvh_build_recursive(right_ids, right_count);
+    bvh_link_children(node_id, child1, child2);
+
+    return node_id;
+}
+
+/*
+    binned surface area heuristic, in 2D the perimeter stands in for the
+    surface area. bins are laid over the centroid bounds of the node so
+    clustered colliders still get split
+*/
+Inst bvh_build_sah(Inst* ids, U32 count) {
+    if (count == 0) return NO_INSTANCE;
+
+    Inst node_id = bvh_new_node();
+
+    if (count == 1) {
+        return bvh_make_leaf(node_id, ids[0]);
+    }
+
+    // centroid bounds
+    Vec2 first = glx_aabb_center(collider_get_bounding_box(ids[0]));
+    AABB centroids = { first, first };
+
+    for (U32 i = 1; i < count; ++i) {
+        Vec2 c = glx_aabb_center(collider_get_bounding_box(ids[i]));
+        centroids = glx_aabb_merge(centroids, { c, c });
+    }
+
+    struct Bin { AABB box; U32 count; };
+    constexpr U32 bin_count = CFG_BVH_SAH_BINS;
 
-    if (node.child1 != NO_INSTANCE) bvh_set_node_parent(node.child1, node_id);
-    if (node.child2 != NO_INSTANCE) bvh_set_node_parent(node.child2, node_id);
+    F32 best_cost = FLT_MAX;
+    U32 best_axis = 0;
+    U32 best_bin  = 0;
 
-    node.box = glx_aabb_merge(
-        bvh_get_node_box(node.child1),
-        bvh_get_node_box(node.child2)
-    );
+    for (U32 axis = 0; axis < 2; ++axis) {
+        F32 lo = centroids.min.raw[axis];
+        F32 extent = centroids.max.raw[axis] - lo;
+        if (extent <= 0.f) continue;
+
+        F32 scale = bin_count / extent;
+
+        Bin bins[bin_count];
+        for (U32 b = 0; b < bin_count; ++b) {
+            bins[b].count = 0;
+        }
+
+        for (U32 i = 0; i < count; ++i) {
+            const AABB& box = collider_get_bounding_box(ids[i]);
+            U32 b = (U32) ((glx_aabb_center(box).raw[axis] - lo) * scale);
+            if (b >= bin_count) b = bin_count - 1;
+
+            bins[b].box = bins[b].count ? glx_aabb_merge(bins[b].box, box) : box;
+            bins[b].count++;
+        }
+
+        // sweep from the right to get the cost of every right side
+        F32 right_area[bin_count];
+        U32 right_count[bin_count];
+        AABB acc{};
+        U32 n = 0;
+
+        for (U32 b = bin_count - 1; b > 0; --b) {
+            if (bins[b].count) {
+                acc = n ? glx_aabb_merge(acc, bins[b].box) : bins[b].box;
+                n += bins[b].count;
+            }
+            right_area[b] = n ? glx_aabb_perimeter(acc) : 0.f;
+            right_count[b] = n;
+        }
+
+        // sweep from the left, a split after bin b puts [0, b] on the left
+        n = 0;
+        for (U32 b = 0; b < bin_count - 1; ++b) {
+            if (bins[b].count) {
+                acc = n ? glx_aabb_merge(acc, bins[b].box) : bins[b].box;
+                n += bins[b].count;
+            }
+
+            if (n == 0 || right_count[b + 1] == 0) continue;
+
+            F32 cost = glx_aabb_perimeter(acc) * n + right_area[b + 1] * right_count[b + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin  = b;
+            }
+        }
+    }
+
+    U32 left_count;
+
+    if (best_cost == FLT_MAX) {
+
+        // all centroids are on top of each other
+        left_count = count / 2;
+    }
+
+    else {
+        F32 lo = centroids.min.raw[best_axis];
+        F32 scale = bin_count / (centroids.max.raw[best_axis] - lo);
+
+        left_count = 0;
+        for (U32 i = 0; i < count; ++i) {
+            Vec2 c = glx_aabb_center(collider_get_bounding_box(ids[i]));
+            U32 b = (U32) ((c.raw[best_axis] - lo) * scale);
+            if (b >= bin_count) b = bin_count - 1;
+
+            if (b <= best_bin) {
+                vswap(ids[i], ids[left_count++]);
+            }
+        }
+    }
+
+    Inst child1 = bvh_build_sah(ids, left_count);
+    Inst child2 = bvh_build_sah(ids + left_count, count - left_count);
+    bvh_link_children(node_id, child1, child2);
 
     return node_id;
 }
 
-void bvh_build(Inst* colliders, U32 count) {
-    g_bvh_node_count = 0;
+void bvh_build(Inst* colliders, U32 count, BvhBuildMode mode) {
+    PsxBvhState& state = bvh_state();
+
+    state.nodes.count = 0;
+    state.free_head = NO_INSTANCE;
 
     if (count == 0) {
-        g_bvh_root = NO_INSTANCE;
+        state.root = NO_INSTANCE;
         return;
     }
 
-    g_bvh_root = bvh_build_recursive(
-        colliders,
-        count
-    );
+    switch (mode) {
+        case (BVH_BUILD_SAH) : { 
+            state.root = bvh_build_sah(colliders, count); 
+            break; 
+        }
+        default : { 
+            state.root = bvh_build_recursive(colliders, count); 
+            break; 
+        }
+    }
+
+    state.nodes[state.root].parent = NO_INSTANCE;
 }
 
-void bvh_render_node(U32 node_id) {
-    if (node_id == NO_INSTANCE) return;
-    BvhNode& n = g_bvh_nodes[node_id];
+/*
+    tree quality
+*/
+
+static void bvh_measure_node(Inst id, U32 depth, F32 root_perimeter, BvhQuality& q) {
+    PsxBvhState& state = bvh_state();
+
+    const BvhNode& node = state.nodes[id];
+    F32 relative = glx_aabb_perimeter(node.box) / root_perimeter;
+
+    q.node_count++;
+    if (depth > q.max_depth) q.max_depth = depth;
+
+    if (bvh_is_leaf(node)) {
+        q.sah_cost += CFG_BVH_SAH_LEAF_COST * relative;
+        q.leaf_count++;
+        q.avg_leaf_depth += (F32) depth;
+        return;
+    }
 
-    shape_bounding_box(n.box);
+    q.sah_cost += CFG_BVH_SAH_TRAVERSAL_COST * relative;
 
-    if (bvh_is_leaf(n)) return;
+    // area shared by the two children, tested twice on every traversal
+    const AABB& a = state.nodes[node.child1].box;
+    const AABB& b = state.nodes[node.child2].box;
+    F32 w = fminf(a.max.x, b.max.x) - fmaxf(a.min.x, b.min.x);
+    F32 h = fminf(a.max.y, b.max.y) - fmaxf(a.min.y, b.min.y);
+    if (w > 0.f && h > 0.f) q.overlap += w * h;
 
-    if (n.child1 != NO_INSTANCE) bvh_render_node(n.child1);
-    if (n.child2 != NO_INSTANCE) bvh_render_node(n.child2);
+    bvh_measure_node(node.child1, depth + 1, root_perimeter, q);
+    bvh_measure_node(node.child2, depth + 1, root_perimeter, q);
 }
 
-void bvh_render() {
-    #if CFG_RENDER_BVH
+BvhQuality bvh_measure_quality() {
+    PsxBvhState& state = bvh_state();
 
-    if (g_bvh_root != NO_INSTANCE) {
-        bvh_render_node(g_bvh_root);
-    }
+    BvhQuality q{};
+    if (state.root == NO_INSTANCE) return q;
+
+    const AABB& root = state.nodes[state.root].box;
+    F32 root_perimeter = glx_aabb_perimeter(root);
+    F32 root_area = (root.max.x - root.min.x) * (root.max.y - root.min.y);
+    if (root_perimeter <= 0.f) return q;
 
-    #endif
+    bvh_measure_node(state.root, 0, root_perimeter, q);
+
+    if (q.leaf_count) q.avg_leaf_depth /= (F32) q.leaf_count;
+    if (root_area > 0.f) q.overlap /= root_area;
+
+    return q;
 }
 
-void bvh_calculate_manifolds() {
-    if (g_bvh_root == NO_INSTANCE) {
-        return;
+void bvh_log_quality(const char* label) {
+    BvhQuality q = bvh_measure_quality();
+
+    LOGI("bvh %s: sah_cost=%.3f max_depth=%u avg_leaf_depth=%.2f overlap=%.4f leaves=%u nodes=%u",
+        label, q.sah_cost, q.max_depth, q.avg_leaf_depth, q.overlap, q.leaf_count, q.node_count);
+}
+
+/*
+    compound local trees
+*/
+
+Inst bvh_local_new() {
+    PsxBvhState& state = bvh_state();
+    return state.locals.handle(state.locals.alloc());
+}
+
+void bvh_local_free(Inst tree) {
+    PsxBvhState& state = bvh_state();
+    if (!state.locals.valid(tree)) return;
+
+    BvhLocalTree& t = state.locals[tree];
+    t.nodes.clear();
+    t.colliders.clear();
+
+    state.locals.free(tree);
+}
+
+// same split as bvh_build_recursive, returns the index of the subtree root
+static U32 bvh_local_build_recursive(BvhLocalTree& t, Inst* ids, U32 count) {
+    U32 index = (U32) t.nodes.size();
+    t.nodes.push_back({});
+
+    if (count == 1) {
+        BvhNode& leaf = t.nodes[index];
+        leaf.collider = ids[0];
+        leaf.box = collider_get_bounding_box(ids[0]);
+        leaf.height = 0;
+        return index;
     }
 
-    struct NodePair { U32 a; U32 b; };
+    AABB combined = collider_get_bounding_box(ids[0]);
+    for (U32 i = 1; i < count; ++i) {
+        combined = glx_aabb_merge(combined, collider_get_bounding_box(ids[i]));
+    }
 
-    static NodePair stack[CFG_MAX_COLLIDERS * 4];
-    U32 stack_top = 0;
+    F32 dx = combined.max.x - combined.min.x;
+    F32 dy = combined.max.y - combined.min.y;
+    Axis axis = (dx > dy) ? AXIS_X : AXIS_Y;
+
+    F32 split = (axis == AXIS_X)
+        ? (combined.min.x + combined.max.x) * 0.5f
+        : (combined.min.y + combined.max.y) * 0.5f;
 
-    stack[stack_top++] = { g_bvh_root, g_bvh_root };
+    U32 left_count = bvh_partition_ids(ids, count, axis, split);
 
-    while (stack_top > 0) {
-        NodePair pair = stack[--stack_top];
-        U32 na = pair.a;
-        U32 nb = pair.b;
+    U32 child1 = bvh_local_build_recursive(t, ids, left_count);
+    U32 child2 = bvh_local_build_recursive(t, ids + left_count, count - left_count);
 
-        if (na == NO_INSTANCE || nb == NO_INSTANCE) {
-            continue;
+    // the vector may have grown, look the node up again
+    BvhNode& node = t.nodes[index];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.box = combined;
+    node.height = 1 + std::max(t.nodes[child1].height, t.nodes[child2].height);
+
+    return index;
+}
+
+static void bvh_local_build(BvhLocalTree& t) {
+    thread_local std::vector<Inst> ids;
+
+    t.nodes.clear();
+    if (t.colliders.empty()) return;
+
+    ids.assign(t.colliders.begin(), t.colliders.end());
+    bvh_local_build_recursive(t, ids.data(), (U32) ids.size());
+}
+
+void bvh_local_add(Inst tree, Inst collider) {
+    BvhLocalTree& t = bvh_state().locals[tree];
+
+    t.colliders.push_back(collider);
+    bvh_local_build(t);
+}
+
+void bvh_local_remove(Inst tree, Inst collider) {
+    BvhLocalTree& t = bvh_state().locals[tree];
+
+    auto it = std::find(t.colliders.begin(), t.colliders.end(), collider);
+    if (it == t.colliders.end()) return;
+
+    t.colliders.erase(it);
+    bvh_local_build(t);
+}
+
+const std::vector<Inst>& bvh_local_colliders(Inst tree) {
+    return bvh_state().locals[tree].colliders;
+}
+
+bool bvh_local_refit(Inst tree, AABB& box) {
+    BvhLocalTree& t = bvh_state().locals[tree];
+    if (t.nodes.empty()) return false;
+
+    // children come after their parent
+    for (U32 i = (U32) t.nodes.size(); i-- > 0;) {
+        BvhNode& node = t.nodes[i];
+
+        if (bvh_is_leaf(node)) {
+            node.box = collider_get_bounding_box(node.collider);
+        } else {
+            node.box = glx_aabb_merge(t.nodes[node.child1].box, t.nodes[node.child2].box);
         }
+    }
 
-        BvhNode& A = g_bvh_nodes[na];
-        BvhNode& B = g_bvh_nodes[nb];
+    box = t.nodes[0].box;
+    return true;
+}
 
-        // When same node, split it into its children combinations
-        if (na == nb) {
-            if (!bvh_is_leaf(A)) {
-                if (A.child1 != NO_INSTANCE) {
-                    stack[stack_top++] = { A.child1, A.child1 };
-                    stack[stack_top++] = { A.child1, A.child2 };
-                }
-                if (A.child2 != NO_INSTANCE) {
-                    stack[stack_top++] = { A.child2, A.child2 };
-                }
-            }
-            continue;
+void bvh_local_query_aabb(Inst tree, const AABB& box, std::vector<Inst>& out) {
+    const BvhLocalTree& t = bvh_state().locals[tree];
+    if (t.nodes.empty()) return;
+
+    thread_local std::vector<U32> stack;
+    stack.clear();
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const BvhNode& N = t.nodes[stack.back()];
+        stack.pop_back();
+
+        if (!glx_aabb_check(N.box, box)) continue;
+
+        if (bvh_is_leaf(N)) {
+            out.push_back(N.collider);
+        } else {
+            stack.push_back(N.child1);
+            stack.push_back(N.child2);
         }
+    }
+}
 
-        if (!glx_aabb_check(A.box, B.box)) {
-            continue;
+// nodes of a compound's local tree, any other collider is a tree of one leaf kept in single
+static const BvhNode* bvh_local_nodes(const PsxCollider& c, BvhNode& single) {
+    if (c.shape == SHAPE_COMPOUND) {
+        const BvhLocalTree& t = bvh_state().locals[c.comp.tree];
+        return t.nodes.empty() ? nullptr : t.nodes.data();
+    }
+
+    single = {};
+    single.box = c.bounding_box;
+    single.collider = c.id;
+    single.height = 0;
+    return &single;
+}
+
+/*
+    pair traversal. the self traversal of the tree is split into subtree pair
+    tasks that run on the job system. every thread writes candidate pairs and
+    contacts into its own buffer, the buffers are merged in collider order so
+    the result does not depend on which thread ran which task
+*/
+
+static bool bvh_pair_is_leaf(const PsxPool<BvhNode>& nodes, const BvhNodePair& pair) {
+    return bvh_is_leaf(nodes[pair.a]) && bvh_is_leaf(nodes[pair.b]) && pair.a != pair.b;
+}
+
+// push the pairs below an internal pair, culled pairs push nothing
+static void bvh_split_pair(const PsxPool<BvhNode>& nodes, const BvhNodePair& pair, std::vector<BvhNodePair>& out) {
+    U32 na = pair.a;
+    U32 nb = pair.b;
+
+    if (na == NO_INSTANCE || nb == NO_INSTANCE) {
+        return;
+    }
+
+    const BvhNode& A = nodes[na];
+    const BvhNode& B = nodes[nb];
+
+    // static subtrees never need to be tested against themselves
+    if (!A.dynamic && !B.dynamic) {
+        return;
+    }
+
+    // When same node, split it into its children combinations
+    if (na == nb) {
+        if (!bvh_is_leaf(A)) {
+            out.push_back({ A.child1, A.child1 });
+            out.push_back({ A.child1, A.child2 });
+            out.push_back({ A.child2, A.child2 });
         }
+        return;
+    }
+
+    if (!glx_aabb_check(A.box, B.box)) {
+        return;
+    }
+
+    bool leafA = bvh_is_leaf(A);
+    bool leafB = bvh_is_leaf(B);
+
+    // At least one is internal: split whichever is "bigger" or not a leaf
+    if (!leafA && (leafB || glx_aabb_perimeter(A.box) >= glx_aabb_perimeter(B.box))) {
+        // Expand A against B
+        out.push_back({ A.child1, nb });
+        out.push_back({ A.child2, nb });
+    } else if (!leafB) {
+        // Expand B against A
+        out.push_back({ na, B.child1 });
+        out.push_back({ na, B.child2 });
+    }
+}
+
+// ca and cb are ordered by id and on different spacials
+static void bvh_push_candidate(const PsxCollider& ca, const PsxCollider& cb, BvhThreadBuffer& buffer) {
+    if (!glx_aabb_check(ca.bounding_box, cb.bounding_box)) {
+        return;
+    }
+
+    // collided once the traversal of the task is done
+    buffer.buckets[manifold_pair_kind(ca.shape, cb.shape)].push_back({ ca.id, cb.id, NO_INSTANCE });
+}
+
+// descend the local trees of two overlapping leaves, at least one of them a compound
+static void bvh_test_compound(const PsxCollider& ca, const PsxCollider& cb, BvhThreadBuffer& buffer) {
+    BvhNode single_a, single_b;
+    const BvhNode* nodes_a = bvh_local_nodes(ca, single_a);
+    const BvhNode* nodes_b = bvh_local_nodes(cb, single_b);
+
+    if (!nodes_a || !nodes_b) return;
+
+    std::vector<BvhNodePair>& stack = buffer.local_stack;
+    stack.clear();
+    stack.push_back({ 0, 0 });
+
+    while (!stack.empty()) {
+        BvhNodePair pair = stack.back();
+        stack.pop_back();
+
+        const BvhNode& A = nodes_a[pair.a];
+        const BvhNode& B = nodes_b[pair.b];
+
+        if (!glx_aabb_check(A.box, B.box)) continue;
 
         bool leafA = bvh_is_leaf(A);
         bool leafB = bvh_is_leaf(B);
 
         if (leafA && leafB) {
-            U32 a_id = A.collider;
-            U32 b_id = B.collider;
-            if (a_id == b_id) continue;
+            const PsxCollider& a = collider_get(A.collider);
+            const PsxCollider& b = collider_get(B.collider);
+
+            if (a.id < b.id) bvh_push_candidate(a, b, buffer);
+            else             bvh_push_candidate(b, a, buffer);
+
+            continue;
+        }
 
-            PsxCollider& ca = collider_get(a_id);
-            PsxCollider& cb = collider_get(b_id);
+        // split the bigger one, like the global traversal
+        if (!leafA && (leafB || glx_aabb_perimeter(A.box) >= glx_aabb_perimeter(B.box))) {
+            stack.push_back({ A.child1, pair.b });
+            stack.push_back({ A.child2, pair.b });
+        } else {
+            stack.push_back({ pair.a, B.child1 });
+            stack.push_back({ pair.a, B.child2 });
+        }
+    }
+}
 
-            if (ca.shape == SHAPE_NONE || cb.shape == SHAPE_NONE) continue;
-            if (!collider_compare_layer(ca, cb)) continue;
+static void bvh_test_leaves(const PsxPool<BvhNode>& nodes, const BvhNodePair& pair, BvhThreadBuffer& buffer) {
+    const BvhNode& A = nodes[pair.a];
+    const BvhNode& B = nodes[pair.b];
 
-            if (ca.spacial == cb.spacial)   continue;
+    if (!A.dynamic && !B.dynamic) return;
+    if (!glx_aabb_check(A.box, B.box)) return;
 
-            if (!glx_aabb_check(ca.bounding_box, cb.bounding_box)) {
-                continue;
-            }
-            
-            ca.phase |= COLLIDER_PHASE_NARROW;
-            cb.phase |= COLLIDER_PHASE_NARROW;
-            
-            Inst manifold = manifold_generate(a_id, b_id);
+    buffer.overlaps++;
 
-            if (manifold != NO_INSTANCE) {
-                ca.phase |= COLLIDER_PHASE_RESOLVE;
-                cb.phase |= COLLIDER_PHASE_RESOLVE;
+    // order by id, the orientation from the tree depends on how it was split
+    U32 a_id = A.collider;
+    U32 b_id = B.collider;
+    if (a_id == b_id) return;
+    if (a_id > b_id) vswap(a_id, b_id);
 
-            }
+    const PsxCollider& ca = collider_get(a_id);
+    const PsxCollider& cb = collider_get(b_id);
+
+    if (ca.shape == SHAPE_NONE || cb.shape == SHAPE_NONE) return;
+    if (!collider_compare_layer(ca, cb)) return;
+
+    // a body never collides with itself, a compound body never visits its own children
+    if (ca.spacial == cb.spacial) return;
+
+    if (ca.shape == SHAPE_COMPOUND || cb.shape == SHAPE_COMPOUND) {
+        bvh_test_compound(ca, cb, buffer);
+        return;
+    }
+
+    bvh_push_candidate(ca, cb, buffer);
+}
+
+// run the task's buckets through their narrowphase batches
+static void bvh_collide_buckets(BvhThreadBuffer& buffer) {
+    for (U32 kind = 0; kind < MM_PAIR_KINDS; ++kind) {
+        std::vector<PsxCollidePair>& bucket = buffer.buckets[kind];
+        if (bucket.empty()) continue;
+
+        manifold_collide_batch(kind, bucket.data(), (U32) bucket.size(), buffer.contacts);
+
+        buffer.candidates.insert(buffer.candidates.end(), bucket.begin(), bucket.end());
+        bucket.clear();
+    }
+}
+
+static void bvh_run_pair_task(void* data, U32 index, U32 thread) {
+    PROFILE_SCOPE(PROFILE_ZONE_PAIR_TASK);
+    PsxBvhState& state = *(PsxBvhState*) data;
+
+    BvhThreadBuffer& buffer = state.buffers[thread];
+    std::vector<BvhNodePair>& stack = buffer.stack;
+
+    U32 visited = 0;
+#if CFG_PROFILE
+    U32 overlaps = buffer.overlaps;
+    U32 candidates = (U32) buffer.candidates.size();
+    U32 contacts = (U32) buffer.contacts.size();
+#endif
+
+    stack.clear();
+    stack.push_back(state.tasks[index]);
+
+    while (!stack.empty()) {
+        BvhNodePair pair = stack.back();
+        stack.pop_back();
+        visited++;
+
+        if (bvh_pair_is_leaf(state.nodes, pair)) {
+            bvh_test_leaves(state.nodes, pair, buffer);
         } else {
-            // At least one is internal: split whichever is "bigger" or not a leaf
-            if (!leafA && (leafB || glx_aabb_perimeter(A.box) >= glx_aabb_perimeter(B.box))) {
-                // Expand A against B
-                if (A.child1 != NO_INSTANCE) stack[stack_top++] = { A.child1, nb };
-                if (A.child2 != NO_INSTANCE) stack[stack_top++] = { A.child2, nb };
+            bvh_split_pair(state.nodes, pair, stack);
+        }
+    }
+
+    bvh_collide_buckets(buffer);
+
+    // once per task, counters belong to the thread that ran it
+#if CFG_PROFILE
+    PROFILE_COUNT(PROFILE_COUNTER_BVH_NODES_VISITED, visited);
+    PROFILE_COUNT(PROFILE_COUNTER_BROADPHASE_PAIRS, buffer.overlaps - overlaps);
+    PROFILE_COUNT(PROFILE_COUNTER_NARROWPHASE_PAIRS, buffer.candidates.size() - candidates);
+    PROFILE_COUNT(PROFILE_COUNTER_CONTACTS, buffer.contacts.size() - contacts);
+#else
+    (void) visited;
+#endif
+}
+
+void bvh_calculate_manifolds() {
+    PROFILE_SCOPE(PROFILE_ZONE_NARROWPHASE);
+    PsxBvhState& state = bvh_state();
+
+    manifolds_begin_update();
+    state.pairs_tested = 0;
+
+    if (state.root == NO_INSTANCE) {
+        manifolds_end_update();
+        return;
+    }
+
+    U32 threads = job_thread_count();
+
+    // expand the root breadth first until there is enough work to share
+    state.tasks.clear();
+    state.tasks.push_back({ state.root, state.root });
+
+    U32 target = threads * CFG_BVH_TASKS_PER_THREAD;
+    while (threads > 1 && state.tasks.size() < target) {
+        bool expanded = false;
+        state.task_scratch.clear();
+
+        for (const BvhNodePair& pair : state.tasks) {
+            if (bvh_pair_is_leaf(state.nodes, pair)) {
+                state.task_scratch.push_back(pair);
             } else {
-                // Expand B against A
-                if (B.child1 != NO_INSTANCE) stack[stack_top++] = { na, B.child1 };
-                if (B.child2 != NO_INSTANCE) stack[stack_top++] = { na, B.child2 };
+                bvh_split_pair(state.nodes, pair, state.task_scratch);
+                expanded = true;
             }
         }
+
+        state.tasks.swap(state.task_scratch);
+        if (!expanded) break;
+    }
+
+    if (state.buffers.size() < threads) {
+        state.buffers.resize(threads);
+    }
+
+    for (BvhThreadBuffer& buffer : state.buffers) {
+        buffer.candidates.clear();
+        buffer.contacts.clear();
+        buffer.overlaps = 0;
+    }
+
+    job_parallel_for((U32) state.tasks.size(), bvh_run_pair_task, &state);
+
+    // merge, ordered by collider pair so any thread count gives the same manifolds
+    state.contacts.clear();
+
+    for (BvhThreadBuffer& buffer : state.buffers) {
+        state.pairs_tested += (U32) buffer.candidates.size();
+
+        for (const PsxCollidePair& pair : buffer.candidates) {
+            collider_add_phase(collider_get(pair.a), COLLIDER_PHASE_NARROW);
+            collider_add_phase(collider_get(pair.b), COLLIDER_PHASE_NARROW);
+
+            if (pair.axis != NO_INSTANCE) manifold_sat_store(pair.a, pair.b, pair.axis);
+        }
+
+        state.contacts.insert(state.contacts.end(), buffer.contacts.begin(), buffer.contacts.end());
+    }
+
+    std::sort(state.contacts.begin(), state.contacts.end(), [](const PsxManifold& a, const PsxManifold& b) {
+        return manifold_pair_key(a.collider_a, a.collider_b) < manifold_pair_key(b.collider_a, b.collider_b);
+    });
+
+    for (const PsxManifold& m : state.contacts) {
+        manifold_store(m);
+
+        collider_add_phase(collider_get(m.collider_a), COLLIDER_PHASE_RESOLVE);
+        collider_add_phase(collider_get(m.collider_b), COLLIDER_PHASE_RESOLVE);
+    }
+
+    manifolds_end_update();
+}
+
+U32 bvh_count_pairs_tested() {
+    return bvh_state().pairs_tested;
+}
+
+void bvh_query_aabb(const AABB& box, std::vector<Inst>& out) {
+    PsxBvhState& state = bvh_state();
+    if (state.root == NO_INSTANCE) return;
+
+    thread_local std::vector<U32> stack;
+    stack.clear();
+    stack.push_back(state.root);
+
+    while (!stack.empty()) {
+        const BvhNode& N = state.nodes[stack.back()];
+        stack.pop_back();
+
+        if (!glx_aabb_check(N.box, box)) continue;
+
+        if (bvh_is_leaf(N)) {
+            const PsxCollider& c = collider_get(N.collider);
+
+            if (c.shape == SHAPE_COMPOUND) {
+                bvh_local_query_aabb(c.comp.tree, box, out);
+            } else {
+                out.push_back(N.collider);
+            }
+        } else {
+            stack.push_back(N.child1);
+            stack.push_back(N.child2);
+        }
+    }
+}
+
+// leaves of a local tree whose boxes the ray enters before max_t
+static void bvh_local_ray_candidates(const BvhLocalTree& t, const PsxRay& ray, F32 max_t, std::vector<Inst>& out) {
+    if (t.nodes.empty()) return;
+
+    thread_local std::vector<U32> stack;
+    stack.clear();
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const BvhNode& N = t.nodes[stack.back()];
+        stack.pop_back();
+
+        F32 tnear, tfar;
+        if (!ray_check_aabb(ray, N.box, tnear, tfar) || tnear > max_t) continue;
+
+        if (bvh_is_leaf(N)) {
+            out.push_back(N.collider);
+        } else {
+            stack.push_back(N.child1);
+            stack.push_back(N.child2);
+        }
     }
 }
 
@@ -249,27 +1175,33 @@ PsxRayResult bvh_cast_ray(
     bool search_groups,
     bool search_layer
 ) {
-    if (g_bvh_root == NO_INSTANCE) 
+    PsxBvhState& state = bvh_state();
+
+    if (state.root == NO_INSTANCE) 
         return {};
 
     struct StackEntry { U32 node; F32 tnear; };
-    StackEntry stack[CFG_MAX_COLLIDERS * 4];
-    U32 top = 0;
 
-    stack[top++] = { g_bvh_root, 0.f };
+    // rays are cast from several threads
+    thread_local std::vector<StackEntry> stack;
+    thread_local std::vector<Inst> candidates;
+    stack.clear();
+
+    stack.push_back({ state.root, 0.f });
 
     bool hit = false;
     F32 best_t = ray.max_dist;
     Vec2 best_normal{};
     U32 best_collider = NO_INSTANCE;
 
-    while (top > 0) {
-        StackEntry e = stack[--top];
+    while (!stack.empty()) {
+        StackEntry e = stack.back();
+        stack.pop_back();
         U32 nid = e.node;
 
         if (nid == NO_INSTANCE) continue;
 
-        BvhNode& N = g_bvh_nodes[nid];
+        BvhNode& N = state.nodes[nid];
 
         F32 tnear, tfar;
         if (!ray_check_aabb(ray, N.box, tnear, tfar)) {
@@ -290,24 +1222,34 @@ PsxRayResult bvh_cast_ray(
             if (search_layer && collider_get_layer(c) != ray.layer)
                 continue;
 
+            // children of a compound whose boxes the ray crosses
+            candidates.clear();
+            if (c.shape == SHAPE_COMPOUND) {
+                bvh_local_ray_candidates(state.locals[c.comp.tree], ray, best_t, candidates);
+            } else {
+                candidates.push_back(cid);
+            }
+
             // run narrow phase
-            F32 t;
-            Vec2 normal;
-
-            bool local_hit = ray_test_collider(ray, c.id, t, normal);
-            if (local_hit && t < best_t && t >= 0.f) {
-                best_t = t;
-                best_normal = normal;
-                best_collider = cid;
-                hit = true;
+            for (Inst candidate : candidates) {
+                F32 t;
+                Vec2 normal;
+
+                bool local_hit = ray_test_collider(ray, candidate, t, normal);
+                if (local_hit && t < best_t && t >= 0.f) {
+                    best_t = t;
+                    best_normal = normal;
+                    best_collider = candidate;
+                    hit = true;
+                }
             }
         }
         else {
             if (N.child1 != NO_INSTANCE)
-                stack[top++] = { N.child1, tnear };
+                stack.push_back({ N.child1, tnear });
 
             if (N.child2 != NO_INSTANCE)
-                stack[top++] = { N.child2, tnear };
+                stack.push_back({ N.child2, tnear });
         }
     }
 
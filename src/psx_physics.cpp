@@ -0,0 +1,120 @@
+#include "psx_physics.h"
+#include "psx_profile.h"
+#include "psx_island.h"
+#include "psx_ccd.h"
+
+struct PsxPhysicsState {
+    F32 fixed_dt = CFG_FIXED_DT;
+    U32 max_substeps = CFG_MAX_SUBSTEPS;
+    F32 accumulator = 0.f;
+
+    PsxStepFn pre_step = nullptr;
+    void* pre_step_data = nullptr;
+};
+
+static PsxPhysicsState& physics_state() {
+    return *world_current()->physics;
+}
+
+PsxPhysicsState* physics_state_new() {
+    return new PsxPhysicsState();
+}
+
+void physics_state_free(PsxPhysicsState* state) {
+    delete state;
+}
+
+void physics_step(F32 dt) {
+    PROFILE_FRAME();
+    PROFILE_SCOPE(PROFILE_ZONE_STEP);
+
+    // every pass below records its own profile zone
+
+    // update all motion properties
+    spacial_integrate_velocities(dt);
+
+    // filter usable colliders
+    collider_filter_updated();
+
+    // refit moved colliders in the dynamic AABB tree
+    collider_build_bvh();
+
+    // generate collision manifolds
+    bvh_calculate_manifolds();
+
+    // wake islands that were touched and group the awake bodies into islands
+    islands_build();
+
+    // solve cached contacts island by island on the job pool, warm started from the last step
+    islands_solve(dt);
+
+    // update all world positions with the solved velocities
+    spacial_integrate_positions(dt);
+
+    // pull bullets back to the first thing they would have passed through
+    ccd_solve(dt);
+
+    // put islands that came to rest to sleep
+    islands_sleep(dt);
+
+}
+
+void physics_step(PsxWorld* world, F32 dt) {
+    PsxWorldScope scope(world);
+    physics_step(dt);
+}
+
+U32 physics_advance(F32 frame_dt) {
+    PsxPhysicsState& state = physics_state();
+
+    state.accumulator += fmaxf(frame_dt, 0.f);
+
+    U32 steps = 0;
+    while (state.accumulator >= state.fixed_dt && steps < state.max_substeps) {
+        if (state.pre_step) state.pre_step(state.fixed_dt, state.pre_step_data);
+
+        physics_step(state.fixed_dt);
+        state.accumulator -= state.fixed_dt;
+        steps++;
+    }
+
+    // too far behind, drop whole steps instead of catching up next frame
+    if (state.accumulator >= state.fixed_dt) {
+        state.accumulator = fmodf(state.accumulator, state.fixed_dt);
+    }
+
+    return steps;
+}
+
+U32 physics_advance(PsxWorld* world, F32 frame_dt) {
+    PsxWorldScope scope(world);
+    return physics_advance(frame_dt);
+}
+
+void physics_set_fixed_dt(F32 dt) {
+    if (dt <= 0.f) {
+        THROW("Physics: fixed dt has to be positive");
+    }
+
+    physics_state().fixed_dt = dt;
+}
+
+F32 physics_get_fixed_dt() {
+    return physics_state().fixed_dt;
+}
+
+void physics_set_max_substeps(U32 steps) {
+    physics_state().max_substeps = steps > 0 ? steps : 1;
+}
+
+void physics_set_pre_step(PsxStepFn fn, void* data) {
+    PsxPhysicsState& state = physics_state();
+
+    state.pre_step = fn;
+    state.pre_step_data = data;
+}
+
+F32 physics_get_alpha() {
+    PsxPhysicsState& state = physics_state();
+    return state.accumulator / state.fixed_dt;
+}
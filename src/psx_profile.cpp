@@ -0,0 +1,359 @@
+#include "psx_profile.h"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+
+static_assert((CFG_PROFILE_RING_SIZE & (CFG_PROFILE_RING_SIZE - 1)) == 0, "profile ring size must be a power of two");
+
+/*
+    ring slots carry the index they were written for, readers copy a slot
+    and check the index before and after so a slot being overwritten is
+    skipped instead of read torn
+*/
+struct PsxProfileSlot {
+    std::atomic<U64> seq;   // index + 1 once written, 0 while writing
+    std::atomic<U64> start;
+    std::atomic<U64> duration;
+    std::atomic<U32> zone_thread; // zone << 16 | thread
+    std::atomic<U32> frame;
+};
+
+struct alignas(64) PsxProfileThread {
+    std::atomic<U64> counters[PROFILE_COUNTER_COUNT];
+};
+
+std::atomic<bool> g_profile_enabled { false };
+
+static PsxProfileSlot g_profile_ring[CFG_PROFILE_RING_SIZE];
+static std::atomic<U64> g_profile_head { 0 };
+static std::atomic<U64> g_profile_tail { 0 }; // samples before this were reset
+
+static PsxProfileThread g_profile_threads[CFG_PROFILE_MAX_THREADS];
+static std::atomic<U32> g_profile_thread_count { 0 };
+static thread_local U32 t_profile_thread = NO_INSTANCE;
+
+static std::atomic<U32> g_profile_frame { 0 };
+
+// frame capture, g_profile_capturing is the only thing profile_frame reads when idle
+static std::atomic<bool> g_profile_capturing { false };
+static std::atomic<bool> g_profile_capture_ready { false }; // frames done, file not written yet
+static std::mutex g_profile_capture_lock;
+static U32 g_profile_capture_first = 0;
+static U32 g_profile_capture_last = 0;
+static U64 g_profile_capture_head = 0;
+static bool g_profile_capture_restore = false;
+static char g_profile_capture_path[256];
+
+static const char* g_profile_zone_names[PROFILE_ZONE_COUNT] = {
+    "step",
+    "integrate_vel",
+    "filter",
+    "broadphase",
+    "narrowphase",
+    "pair_task",
+    "islands",
+    "solve",
+    "solve_task",
+    "integrate_pos",
+    "ccd",
+    "ray_cast",
+};
+
+static const char* g_profile_counter_names[PROFILE_COUNTER_COUNT] = {
+    "bvh_nodes_visited",
+    "broadphase_pairs",
+    "narrowphase_pairs",
+    "contacts",
+    "manifolds_created",
+    "bvh_moves",
+    "rays",
+};
+
+const char* profile_zone_name(U32 zone) {
+    return zone < PROFILE_ZONE_COUNT ? g_profile_zone_names[zone] : "unknown";
+}
+
+const char* profile_counter_name(U32 counter) {
+    return counter < PROFILE_COUNTER_COUNT ? g_profile_counter_names[counter] : "unknown";
+}
+
+void profile_set_enabled(bool enabled) {
+    g_profile_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void profile_reset() {
+    g_profile_tail.store(g_profile_head.load(std::memory_order_acquire), std::memory_order_release);
+
+    for (U32 t = 0; t < CFG_PROFILE_MAX_THREADS; ++t) {
+        for (U32 c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+            g_profile_threads[t].counters[c].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// the step only closes the capture, the file is written by whoever polls profile_write_capture
+static void profile_finish_capture(U32 frame) {
+    std::lock_guard<std::mutex> guard(g_profile_capture_lock);
+    if (!g_profile_capturing.load(std::memory_order_relaxed)) return;
+    if (frame <= g_profile_capture_last) return;
+
+    g_profile_capturing.store(false, std::memory_order_relaxed);
+    profile_set_enabled(g_profile_capture_restore);
+
+    U64 written = g_profile_head.load(std::memory_order_acquire) - g_profile_capture_head;
+    if (written > CFG_PROFILE_RING_SIZE) {
+        LOGE("profile: capture wrote %llu samples, the ring only kept the last %u", (unsigned long long) written, CFG_PROFILE_RING_SIZE);
+    }
+
+    g_profile_capture_ready.store(true, std::memory_order_release);
+}
+
+void profile_frame() {
+    U32 frame = g_profile_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (g_profile_capturing.load(std::memory_order_relaxed)) {
+        profile_finish_capture(frame);
+    }
+}
+
+U32 profile_get_frame() {
+    return g_profile_frame.load(std::memory_order_relaxed);
+}
+
+U64 profile_now_ns() {
+    return (U64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+U32 profile_thread_id() {
+    if (t_profile_thread == NO_INSTANCE) {
+        U32 id = g_profile_thread_count.fetch_add(1, std::memory_order_relaxed);
+
+        // threads past the limit share the last slot, the counters are atomic
+        t_profile_thread = id < CFG_PROFILE_MAX_THREADS ? id : CFG_PROFILE_MAX_THREADS - 1;
+    }
+
+    return t_profile_thread;
+}
+
+void profile_record(U32 zone, U64 start_ns, U64 end_ns) {
+    U64 index = g_profile_head.fetch_add(1, std::memory_order_relaxed);
+    PsxProfileSlot& slot = g_profile_ring[index & (CFG_PROFILE_RING_SIZE - 1)];
+
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.start.store(start_ns, std::memory_order_relaxed);
+    slot.duration.store(end_ns - start_ns, std::memory_order_relaxed);
+    slot.zone_thread.store((zone << 16) | profile_thread_id(), std::memory_order_relaxed);
+    slot.frame.store(profile_get_frame(), std::memory_order_relaxed);
+
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+void profile_count(U32 counter, U64 amount) {
+    g_profile_threads[profile_thread_id()].counters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+U32 profile_read_samples(PsxProfileSample* out, U32 capacity) {
+    U64 head = g_profile_head.load(std::memory_order_acquire);
+    U64 tail = g_profile_tail.load(std::memory_order_acquire);
+
+    if (head - tail > CFG_PROFILE_RING_SIZE) tail = head - CFG_PROFILE_RING_SIZE;
+    if (head - tail > capacity) tail = head - capacity;
+
+    U32 count = 0;
+
+    for (U64 index = tail; index < head; ++index) {
+        const PsxProfileSlot& slot = g_profile_ring[index & (CFG_PROFILE_RING_SIZE - 1)];
+
+        if (slot.seq.load(std::memory_order_acquire) != index + 1) continue;
+
+        PsxProfileSample sample;
+        sample.start_ns    = slot.start.load(std::memory_order_relaxed);
+        sample.duration_ns = slot.duration.load(std::memory_order_relaxed);
+        U32 zone_thread    = slot.zone_thread.load(std::memory_order_relaxed);
+        sample.frame       = slot.frame.load(std::memory_order_relaxed);
+        sample.zone   = zone_thread >> 16;
+        sample.thread = zone_thread & 0xFFFF;
+
+        // overwritten while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != index + 1) continue;
+
+        out[count++] = sample;
+    }
+
+    return count;
+}
+
+PsxProfileStats profile_summarize(U32 zone) {
+    thread_local std::vector<PsxProfileSample> samples;
+    samples.resize(CFG_PROFILE_RING_SIZE);
+
+    U32 count = profile_read_samples(samples.data(), CFG_PROFILE_RING_SIZE);
+
+    std::vector<U64> durations;
+    for (U32 i = 0; i < count; ++i) {
+        if (samples[i].zone == zone) durations.push_back(samples[i].duration_ns);
+    }
+
+    PsxProfileStats stats = { };
+    if (durations.empty()) return stats;
+
+    std::sort(durations.begin(), durations.end());
+
+    U64 sum = 0;
+    for (U64 d : durations) sum += d;
+
+    U32 n = (U32) durations.size();
+    stats.count  = n;
+    stats.min_ns = durations.front();
+    stats.max_ns = durations.back();
+    stats.avg_ns = sum / n;
+    stats.p99_ns = durations[(n * 99 + 99) / 100 - 1]; // nearest rank
+
+    return stats;
+}
+
+U64 profile_get_thread_counter(U32 thread, U32 counter) {
+    if (thread >= CFG_PROFILE_MAX_THREADS || counter >= PROFILE_COUNTER_COUNT) return 0;
+    return g_profile_threads[thread].counters[counter].load(std::memory_order_relaxed);
+}
+
+U64 profile_get_counter(U32 counter) {
+    U64 total = 0;
+
+    for (U32 t = 0; t < profile_count_threads(); ++t) {
+        total += profile_get_thread_counter(t, counter);
+    }
+
+    return total;
+}
+
+U32 profile_count_threads() {
+    U32 count = g_profile_thread_count.load(std::memory_order_relaxed);
+    return count < CFG_PROFILE_MAX_THREADS ? count : CFG_PROFILE_MAX_THREADS;
+}
+
+void profile_log() {
+    printf("--- profile, frame %u\n", profile_get_frame());
+    printf("%-16s %8s %10s %10s %10s %10s\n", "zone", "count", "min_us", "avg_us", "p99_us", "max_us");
+
+    for (U32 z = 0; z < PROFILE_ZONE_COUNT; ++z) {
+        PsxProfileStats s = profile_summarize(z);
+        if (!s.count) continue;
+
+        printf("%-16s %8u %10.2f %10.2f %10.2f %10.2f\n", profile_zone_name(z), s.count,
+            s.min_ns / 1000.0, s.avg_ns / 1000.0, s.p99_ns / 1000.0, s.max_ns / 1000.0);
+    }
+
+    for (U32 c = 0; c < PROFILE_COUNTER_COUNT; ++c) {
+        printf("%-20s %llu\n", profile_counter_name(c), (unsigned long long) profile_get_counter(c));
+    }
+}
+
+/*
+    chrome trace
+*/
+
+void profile_capture_frames(U32 frames, const char* path) {
+    if (!frames || !path) return;
+
+    std::lock_guard<std::mutex> guard(g_profile_capture_lock);
+
+    // a capture already running is replaced
+    if (!g_profile_capturing.load(std::memory_order_relaxed)) {
+        g_profile_capture_restore = profile_enabled();
+    }
+
+    snprintf(g_profile_capture_path, sizeof(g_profile_capture_path), "%s", path);
+    g_profile_capture_ready.store(false, std::memory_order_relaxed);
+
+    // samples of the current frame are tagged before the next profile_frame, start after it
+    g_profile_capture_first = profile_get_frame() + 1;
+    g_profile_capture_last = g_profile_capture_first + frames - 1;
+    g_profile_capture_head = g_profile_head.load(std::memory_order_acquire);
+
+    profile_set_enabled(true);
+    g_profile_capturing.store(true, std::memory_order_relaxed);
+}
+
+bool profile_capturing() {
+    return g_profile_capturing.load(std::memory_order_relaxed);
+}
+
+bool profile_capture_ready() {
+    return g_profile_capture_ready.load(std::memory_order_acquire);
+}
+
+bool profile_write_capture() {
+    if (!g_profile_capture_ready.load(std::memory_order_acquire)) return false;
+
+    char path[sizeof(g_profile_capture_path)];
+    U32 first, last;
+
+    {
+        std::lock_guard<std::mutex> guard(g_profile_capture_lock);
+        if (!g_profile_capture_ready.exchange(false, std::memory_order_acq_rel)) return false;
+
+        memcpy(path, g_profile_capture_path, sizeof(path));
+        first = g_profile_capture_first;
+        last = g_profile_capture_last;
+    }
+
+    if (!profile_write_chrome_trace(path, first, last)) {
+        LOGE("profile: could not write %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+bool profile_write_chrome_trace(const char* path, U32 first_frame, U32 last_frame) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    // per thread, an export and a summary can run at the same time
+    thread_local std::vector<PsxProfileSample> samples;
+    samples.resize(CFG_PROFILE_RING_SIZE);
+
+    U32 count = profile_read_samples(samples.data(), CFG_PROFILE_RING_SIZE);
+    samples.resize(count);
+
+    samples.erase(std::remove_if(samples.begin(), samples.end(), [&](const PsxProfileSample& s) {
+        return s.frame < first_frame || s.frame > last_frame;
+    }), samples.end());
+
+    // parents end after their children, sort by start so the file reads in order
+    std::sort(samples.begin(), samples.end(), [](const PsxProfileSample& a, const PsxProfileSample& b) {
+        return a.start_ns < b.start_ns;
+    });
+
+    U64 origin = samples.empty() ? 0 : samples.front().start_ns;
+    bool threads[CFG_PROFILE_MAX_THREADS] = { };
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"kinematix\"}}");
+
+    for (const PsxProfileSample& s : samples) {
+        if (s.thread < CFG_PROFILE_MAX_THREADS && !threads[s.thread]) {
+            threads[s.thread] = true;
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", s.thread, s.thread);
+        }
+
+        // complete events carry begin and end in one record, times are in microseconds
+        fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"physics\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+            profile_zone_name(s.zone), s.thread,
+            (s.start_ns - origin) / 1000.0, s.duration_ns / 1000.0, s.frame);
+    }
+
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    fclose(file);
+
+    return ok;
+}
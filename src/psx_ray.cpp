@@ -1,4 +1,5 @@
 #include "psx_ray.h"
+#include "psx_profile.h"
 
 bool ray_check_circle(
     const PsxRay& ray, 
@@ -78,6 +79,63 @@ bool ray_check_poly(
     return true;
 }
 
+bool ray_check_capsule(
+    const PsxRay& ray,
+    const Vec2& a,
+    const Vec2& b,
+    F32 radius,
+    F32& dist_out,
+    Vec2& normal_out
+) {
+    const Vec2 r1 = ray.origin;
+    const Vec2 r2 = ray.origin + ray.dir * ray.max_dist;
+
+    bool hit = false;
+    F32 best = FLT_MAX;
+    Vec2 best_norm{};
+
+    // flat sides, a segment is its only side
+    Vec2 side = vec2_normal(vec2_perp(b - a));
+
+    if (side.x != 0.f || side.y != 0.f) {
+        U32 sides = radius > 0.f ? 2 : 1;
+
+        for (U32 i = 0; i < sides; ++i) {
+            Vec2 n = i ? -side : side;
+            Vec2 off = n * radius;
+
+            F32 t = 0.f;
+            Vec2 plane_n{};
+            if (algo_plane_intersection(a + off, b + off, r1, r2, t, plane_n) && t * ray.max_dist < best) {
+                best = t * ray.max_dist;
+                best_norm = radius == 0.f && vec2_dot(n, ray.dir) > 0.f ? -n : n;
+                hit = true;
+            }
+        }
+    }
+
+    // rounded ends
+    if (radius > 0.f) {
+        const Vec2 ends[2] = { a, b };
+
+        for (U32 i = 0; i < 2; ++i) {
+            F32 d;
+            Vec2 n;
+            if (ray_check_circle(ray, ends[i], radius, d, n) && d < best) {
+                best = d;
+                best_norm = n;
+                hit = true;
+            }
+        }
+    }
+
+    if (!hit) { return false; }
+
+    dist_out   = best;
+    normal_out = best_norm;
+    return true;
+}
+
 bool ray_check_aabb(
     const PsxRay& ray,
     const AABB& box,
@@ -141,6 +199,17 @@ bool ray_test_collider(const PsxRay& ray, Inst collider, F32& out_dist, Vec2& ou
                 out_normal
             );
 
+        case SHAPE_CAPSULE:
+        case SHAPE_SEGMENT:
+            return ray_check_capsule(
+                ray,
+                c.caps.world[0],
+                c.caps.world[1],
+                c.caps.radius,
+                out_dist,
+                out_normal
+            );
+
         default:
             return false;
     }
@@ -149,5 +218,8 @@ bool ray_test_collider(const PsxRay& ray, Inst collider, F32& out_dist, Vec2& ou
 }
 
 PsxRayResult ray_cast(const PsxRay& ray) {
+    PROFILE_SCOPE(PROFILE_ZONE_RAYCAST);
+    PROFILE_COUNT(PROFILE_COUNTER_RAYS, 1);
+
     return bvh_cast_ray(ray, ray.group != NO_INSTANCE, ray.layer != NO_INSTANCE);
 }
\ No newline at end of file
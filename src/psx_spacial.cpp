@@ -1,72 +1,267 @@
 #include "psx_spacial.h"
-#include "glx_shape.h"
+#include "psx_kernel.h"
+#include "psx_profile.h"
+#include "psx_pool.h"
+#include "psx_world.h"
+#include "psx_island.h"
+#include "psx_collider.h"
+
+struct PsxSpacialState {
+    PsxSpacialStreams streams;
+    PsxPool<PsxSpacialInfo> spacials;
+
+    // world properties
+    F32 gravity = 1000.f;
+};
+
+static PsxSpacialState& spacial_state() {
+    return *world_current()->spacial;
+}
+
+PsxSpacialState* spacial_state_new() {
+    return new PsxSpacialState();
+}
 
-static PsxSpacial g_spacials[CFG_MAX_SPACIALS] = { };
-static U32 g_spacials_free[CFG_MAX_SPACIALS] = { };
-static U32 g_spacials_free_top = 0;
-static U32 g_next_spacial = 0;
+void spacial_state_free(PsxSpacialState* state) {
+    PsxSpacialStreams& st = state->streams;
+
+    free(st.vel);
+    free(st.force);
+    free(st.pos);
+    free(st.prev_pos);
+    free(st.ang_vel);
+    free(st.torque);
+    free(st.ang);
+    free(st.prev_ang);
+    free(st.rot);
+    free(st.inv_mass);
+    free(st.inv_inertia);
+    free(st.flags);
+    free(st.sleep_time);
+    free(st.owner);
+
+    state->spacials.release();
+    delete state;
+}
 
-// global properties
-static F32 gravity = 1000.f;
+PsxSpacial spacial_get(Inst spacial) {
+    PsxSpacialState& state = spacial_state();
 
-PsxSpacial& spacial_get(Inst spacial) {
-    if (spacial >= g_next_spacial) {
-        THROW("Collider: attempt to get invalid s");
+    if (!state.spacials.valid(spacial)) {
+        THROW("Spacial: attempt to get invalid or stale spacial %u", spacial);
     }
 
-    return g_spacials[spacial];
+    PsxSpacialInfo& info = state.spacials[spacial];
+    PsxSpacialStreams& st = state.streams;
+    U32 slot = info.slot;
+
+    return {
+        info.user_data,
+        st.vel[slot], st.force[slot], st.pos[slot], st.prev_pos[slot],
+        st.ang_vel[slot], st.torque[slot], st.ang[slot], st.prev_ang[slot],
+        info.mass, st.inv_mass[slot], info.inertia, st.inv_inertia[slot],
+        st.flags[slot], info.index, info.layer, info.group,
+        info.in_use
+    };
 }
 
-PsxSpacial& spacial_alloc() {
-    Inst spacial;
+bool spacial_valid(Inst spacial) {
+    return spacial_state().spacials.valid(spacial);
+}
 
-    if (g_spacials_free_top > 0) {
-        g_spacials_free_top--;
-        spacial = g_spacials_free[g_spacials_free_top];
+Inst spacial_handle(U32 slot) {
+    return spacial_state().spacials.handle(slot);
+}
+
+PsxSpacialStreams& spacial_streams() {
+    return spacial_state().streams;
+}
+
+PsxSpacialInfo& spacial_get_info(Inst spacial) {
+    PsxSpacialState& state = spacial_state();
+
+    if (!state.spacials.valid(spacial)) {
+        THROW("Spacial: attempt to get invalid or stale spacial %u", spacial);
     }
 
-    else {
-        if (g_next_spacial >= CFG_MAX_SPACIALS) {
-            THROW("Physics: no more colliders");
+    return state.spacials[spacial];
+}
+
+bool spacial_is_sleeping(Inst spacial) {
+    return spacial_get_info(spacial).island != NO_INSTANCE;
+}
+
+template <typename T>
+static void spacial_grow_stream(T*& stream, U32 capacity) {
+    stream = (T*) realloc(stream, capacity * sizeof(T));
+    if (!stream) THROW("Physics: out of memory for spacial streams");
+}
+
+static void spacial_grow_streams() {
+    PsxSpacialStreams& st = spacial_state().streams;
+    U32 capacity = st.capacity ? st.capacity * 2 : (1u << CFG_POOL_CHUNK_SHIFT);
+
+    spacial_grow_stream(st.vel, capacity);
+    spacial_grow_stream(st.force, capacity);
+    spacial_grow_stream(st.pos, capacity);
+    spacial_grow_stream(st.prev_pos, capacity);
+    spacial_grow_stream(st.ang_vel, capacity);
+    spacial_grow_stream(st.torque, capacity);
+    spacial_grow_stream(st.ang, capacity);
+    spacial_grow_stream(st.prev_ang, capacity);
+    spacial_grow_stream(st.rot, capacity);
+    spacial_grow_stream(st.inv_mass, capacity);
+    spacial_grow_stream(st.inv_inertia, capacity);
+    spacial_grow_stream(st.flags, capacity);
+    spacial_grow_stream(st.sleep_time, capacity);
+    spacial_grow_stream(st.owner, capacity);
+
+    st.capacity = capacity;
+}
+
+/*
+    awake list
+*/
+
+static void spacial_swap_slots(U32 a, U32 b) {
+    PsxSpacialState& state = spacial_state();
+
+    if (a == b) return;
+
+    PsxSpacialStreams& st = state.streams;
+
+    vswap(st.vel[a],         st.vel[b]);
+    vswap(st.force[a],       st.force[b]);
+    vswap(st.pos[a],         st.pos[b]);
+    vswap(st.prev_pos[a],    st.prev_pos[b]);
+    vswap(st.ang_vel[a],     st.ang_vel[b]);
+    vswap(st.torque[a],      st.torque[b]);
+    vswap(st.ang[a],         st.ang[b]);
+    vswap(st.prev_ang[a],    st.prev_ang[b]);
+    vswap(st.rot[a],         st.rot[b]);
+    vswap(st.inv_mass[a],    st.inv_mass[b]);
+    vswap(st.inv_inertia[a], st.inv_inertia[b]);
+    vswap(st.flags[a],       st.flags[b]);
+    vswap(st.sleep_time[a],  st.sleep_time[b]);
+    vswap(st.owner[a],       st.owner[b]);
+
+    state.spacials[st.owner[a]].slot = a;
+    state.spacials[st.owner[b]].slot = b;
+}
+
+// move spacial into the packed awake range
+static void spacial_set_awake(PsxSpacialInfo& info) {
+    if (info.awake) return;
+
+    PsxSpacialStreams& st = spacial_state().streams;
+    spacial_swap_slots(info.slot, st.awake_count++);
+    info.awake = true;
+}
+
+// move spacial out of the packed awake range
+static void spacial_set_inactive(PsxSpacialInfo& info) {
+    if (!info.awake) return;
+
+    PsxSpacialStreams& st = spacial_state().streams;
+    spacial_swap_slots(info.slot, --st.awake_count);
+    info.awake = false;
+}
+
+void spacial_set_sleeping(Inst spacial, U32 island) {
+    PsxSpacialInfo& info = spacial_get_info(spacial);
+    PsxSpacialStreams& st = spacial_state().streams;
+
+    if (st.flags[info.slot] & SPACIAL_FLAG_STATIC) return;
+
+    info.island = island;
+    st.sleep_time[info.slot] = 0.f;
+
+    if (island == NO_INSTANCE) {
+        spacial_set_awake(info);
+        return;
+    }
+
+    // a sleeping body keeps its pose and nothing else
+    st.vel[info.slot] = { 0, 0 };
+    st.force[info.slot] = { 0, 0 };
+    st.ang_vel[info.slot] = 0.f;
+    st.torque[info.slot] = 0.f;
+    st.prev_pos[info.slot] = st.pos[info.slot];
+    st.prev_ang[info.slot] = st.ang[info.slot];
+
+    spacial_set_inactive(info);
+}
+
+PsxSpacial spacial_alloc() {
+    PsxSpacialState& state = spacial_state();
+
+    U32 before = state.spacials.count;
+    U32 slot = state.spacials.alloc();
+    Inst spacial = state.spacials.handle(slot);
+
+    if (state.spacials.count != before) {
+
+        // new spacials get a slot at the end of the streams
+        PsxSpacialStreams& st = state.streams;
+        if (st.count >= st.capacity) {
+            spacial_grow_streams();
         }
 
-        spacial = g_next_spacial++;
+        state.spacials[slot].slot = st.count;
+        state.spacials[slot].awake = false;
+        st.owner[st.count++] = spacial;
     }
 
 
     // instance new collider atspacial
-    PsxSpacial& s = g_spacials[spacial];
+    PsxSpacialInfo& s = state.spacials[slot];
 
     if (s.in_use) {
-        THROW("Physics: got s in use @spacial=%i",spacial);
+        THROW("Physics: got s in use @spacial=%i", slot);
     }
 
-    s.index =spacial;
+    // the stream slot keeps the handle of its current owner
+    state.streams.owner[s.slot] = spacial;
+    state.streams.sleep_time[s.slot] = 0.f;
+
+    s.index = spacial;
     s.in_use = true;
     s.user_data = nullptr;
+    s.collider = NO_INSTANCE;
+    s.island = NO_INSTANCE;
 
-    return s;
+    return spacial_get(spacial);
 }
 
 void spacial_free(Inst spacial) {
-    PsxSpacial& s = spacial_get(spacial);
+    PsxSpacialState& state = spacial_state();
+
+    if (!state.spacials.valid(spacial)) {
+        return;
+    }
+
+    PsxSpacialInfo& s = state.spacials[spacial];
         
     if (!s.in_use) {
         return;
     }
 
+    // whatever rested on the spacial has to fall
+    island_wake(spacial);
+
+    // colliders outlive it, but nothing is stepped against a freed spacial
+    colliders_detach_spacial(spacial);
+
+    spacial_set_inactive(s);
+
     s.in_use = false;
     s.user_data = nullptr;
 
-    if (g_spacials_free_top >= CFG_MAX_COLLIDERS) {
-        THROW("Physics: no more free slots for spacials");
-    }
-
-    g_spacials_free[g_spacials_free_top++] = s.index;
+    state.spacials.free(spacial);
 }
 
 U32 spacial_new(PsxSpacialConfig cfg) {
-    PsxSpacial& s = spacial_alloc();
+    PsxSpacial s = spacial_alloc();
 
     s.pos = cfg.pos;
     s.prev_pos = s.pos;
@@ -75,6 +270,7 @@ U32 spacial_new(PsxSpacialConfig cfg) {
 
     s.ang = cfg.iang;
     s.prev_ang = s.ang;
+    spacial_streams().rot[spacial_get_info(s.index).slot] = vec2_rotation(s.ang);
     s.ang_vel = cfg.iang_vel;
     s.torque = cfg.iang_acc;
 
@@ -96,35 +292,78 @@ U32 spacial_new(PsxSpacialConfig cfg) {
     s.user_data = cfg.user_data;
     s.group = cfg.group;
     s.layer = cfg.layer;
+
+    // only dynamic bodies are integrated
+    Inst index = s.index;
+    if (!(cfg.flags & SPACIAL_FLAG_STATIC)) {
+        spacial_set_awake(spacial_state().spacials[index]);
+    }
     
-    return s.index;
+    return index;
 }
 
-void spacial_move_to(PsxSpacial& s, Vec2 pos) {
+void spacial_move_to(PsxSpacial s, Vec2 pos) {
+
+    // waking moves the spacial to another slot, the view has to be fetched again
+    if (island_wake(s.index)) {
+        spacial_move_to(spacial_get(s.index), pos);
+        return;
+    }
+
+    // a teleport is not interpolated, the body is drawn where it was put
     s.pos = pos;
+    s.prev_pos = pos;
 }
 
 void spacial_move_to(Inst spacial, Vec2 pos) {
     spacial_move_to(spacial_get(spacial), pos);
 }
 
-void spacial_accellarate(PsxSpacial& s, Vec2 force) {
+void spacial_rotate_to(Inst spacial, F32 ang) {
+    island_wake(spacial);
+
+    PsxSpacialStreams& st = spacial_state().streams;
+    U32 slot = spacial_get_info(spacial).slot;
+
+    st.ang[slot] = ang;
+    st.prev_ang[slot] = ang;
+    st.rot[slot] = vec2_rotation(ang);
+}
+
+void spacial_accellarate(PsxSpacial s, Vec2 force) {
     if (s.flags & SPACIAL_FLAG_STATIC) return;
+    if (force.x == 0.f && force.y == 0.f) return; // a zero push doesn't keep a body awake
+
+    if (island_wake(s.index)) {
+        spacial_accellarate(spacial_get(s.index), force);
+        return;
+    }
 
     s.force += force;
 }
 
-void spacial_impulse(PsxSpacial& s, Vec2 impulse) {
+void spacial_impulse(PsxSpacial s, Vec2 impulse) {
     if (s.flags & SPACIAL_FLAG_STATIC) return;
+    if (impulse.x == 0.f && impulse.y == 0.f) return;
+
+    if (island_wake(s.index)) {
+        spacial_impulse(spacial_get(s.index), impulse);
+        return;
+    }
 
     s.vel += impulse * s.inv_mass;
 }
 
 
-void spacial_impulse(PsxSpacial& s, Vec2 impulse, Vec2 contact_point_world) {
+void spacial_impulse(PsxSpacial s, Vec2 impulse, Vec2 contact_point_world) {
     if (s.flags & SPACIAL_FLAG_STATIC) return;
     if (s.inv_mass == 0.f && s.inv_inertia == 0.f) return;
 
+    if (island_wake(s.index)) {
+        spacial_impulse(spacial_get(s.index), impulse, contact_point_world);
+        return;
+    }
+
     // linear part
     if (s.inv_mass > 0.f) {
         s.vel += impulse * s.inv_mass;
@@ -140,61 +379,42 @@ void spacial_impulse(PsxSpacial& s, Vec2 impulse, Vec2 contact_point_world) {
     }
 }
 
-void spacial_integrate_velocities(F32 dt) {
-    for (int i = 0; i < g_next_spacial; ++i) {
-        PsxSpacial& s = spacial_get(i);
-        if (!s.in_use) continue;
-
-        if (s.flags & SPACIAL_FLAG_STATIC) continue;
+// packed awake range of the streams
+static PsxKernelBodies spacial_awake_bodies() {
+    PsxSpacialStreams& st = spacial_state().streams;
 
-        if (s.inv_mass == 0.f) {
-            // clear forces but do not integrate
-            s.force   = {0, 0};
-            s.torque  = 0.f;
-            continue;
-        }
+    return {
+        .vel = st.vel,
+        .force = st.force,
+        .pos = st.pos,
+        .prev_pos = st.prev_pos,
 
-        // Gravity
-        Vec2 g_vector = {0, 0};
-        if (!(s.flags & SPACIAL_FLAG_NO_GRAV)) {
-            g_vector.y = gravity;
-        }
+        .ang_vel = st.ang_vel,
+        .torque = st.torque,
+        .ang = st.ang,
+        .prev_ang = st.prev_ang,
 
-        // Linear acceleration
-        Vec2 acc = (s.force * s.inv_mass) + g_vector;
+        .inv_mass = st.inv_mass,
+        .flags = st.flags,
 
-        // Update linear velocity
-        s.vel += acc * dt;
-        s.vel *= expf(-CFG_DRAG_COEFFICIENT * dt);
-
-        // Angular acceleration
-        s.ang_vel += s.torque * dt;
-        s.ang_vel *= expf(-CFG_ANG_DRAG_COEFFICIENT * dt);
+        .count = st.awake_count,
+    };
+}
 
-        // Clear accumulated forces/torques
-        s.force  = {0, 0};
-        s.torque = 0.f;
-    }
+void spacial_integrate_velocities(F32 dt) {
+    PROFILE_SCOPE(PROFILE_ZONE_INTEGRATE_VEL);
+    kernel_integrate_velocities(spacial_awake_bodies(), kernel_make_step(dt, spacial_state().gravity));
 }
 
 void spacial_integrate_positions(F32 dt) {
-    for (int i = 0; i < g_next_spacial; ++i) {
-        PsxSpacial& s = spacial_get(i);
-        if (!s.in_use) continue;
-
-        if (s.flags & SPACIAL_FLAG_STATIC) continue;
+    PROFILE_SCOPE(PROFILE_ZONE_INTEGRATE_POS);
+    PsxSpacialStreams& st = spacial_state().streams;
 
-        if (s.inv_mass == 0.f) continue;
+    kernel_integrate_positions(spacial_awake_bodies(), dt);
 
-        // Save previous position before integrating
-        s.prev_pos = s.pos;
-        s.prev_ang = s.ang;
-
-        // Position update
-        s.pos += s.vel * dt;
-
-        // Angle update
-        s.ang += s.ang_vel * dt;
+    // one sin/cos per turning body, the colliders on it share it
+    for (U32 i = 0; i < st.awake_count; ++i) {
+        if (st.ang[i] != st.prev_ang[i]) st.rot[i] = vec2_rotation(st.ang[i]);
     }
 }
 
@@ -218,23 +438,40 @@ F32 spacial_get_ang(Inst spacial) {
     return spacial_get(spacial).ang;
 }
 
-void spacial_render() {
+Vec2 spacial_get_interpolated_pos(Inst spacial, F32 alpha) {
+    PsxSpacial s = spacial_get(spacial);
+    return s.prev_pos + (s.pos - s.prev_pos) * alpha;
+}
+
+F32 spacial_get_interpolated_ang(Inst spacial, F32 alpha) {
+    PsxSpacial s = spacial_get(spacial);
+    return s.prev_ang + (s.ang - s.prev_ang) * alpha;
+}
 
-    #if CFG_RENDER_FORCES
+U32 count_awake_spacials() {
+    return spacial_state().streams.awake_count;
+}
 
-    for (int i = 0; i < g_next_spacial; ++i) {
-        const PsxSpacial& spacial = spacial_get(i);
-        if (!spacial.in_use) continue;
+U32 count_spacial_slots() {
+    return spacial_state().spacials.count;
+}
 
-        shape_line(spacial.pos, spacial.pos + spacial.vel / 50.f);
+U64 spacial_memory_bytes() {
+    PsxSpacialState& state = spacial_state();
 
-        // printf("%.4f %.4f %.4f %.4f\n", spacial.pos.x, spacial.pos.y, spacial.vel.x, spacial.vel.y);
-    }
+    const PsxSpacialStreams& st = state.streams;
+    U64 per_slot = 5 * sizeof(Vec2) + 7 * sizeof(F32) + sizeof(U32) + sizeof(Inst);
 
-    #endif
+    return state.spacials.bytes() + (U64) st.capacity * per_slot;
+}
 
+void spacial_set_gravity(F32 gravity) {
+    spacial_state().gravity = gravity;
 }
 
+F32 spacial_get_gravity() {
+    return spacial_state().gravity;
+}
 
 // ew
 void spacial_add_force(Inst spacial, Vec2 impulse) 
@@ -0,0 +1,61 @@
+#include "psx_world.h"
+#include "psx_spacial.h"
+#include "psx_collider.h"
+#include "psx_arena.h"
+#include "psx_manifold.h"
+#include "psx_material.h"
+#include "psx_partition.h"
+#include "psx_island.h"
+#include "psx_physics.h"
+
+static thread_local PsxWorld* t_world = nullptr;
+
+PsxWorld* world_new() {
+    PsxWorld* world = new PsxWorld();
+
+    world->spacial  = spacial_state_new();
+    world->collider = collider_state_new();
+    world->arena    = arena_state_new();
+    world->manifold = manifold_state_new();
+    world->material = material_state_new();
+    world->bvh      = bvh_state_new();
+    world->island   = island_state_new();
+    world->physics  = physics_state_new();
+
+    return world;
+}
+
+void world_free(PsxWorld* world) {
+    if (!world) return;
+
+    if (world == t_world) {
+        THROW("World: attempt to free the world bound to this thread");
+    }
+
+    spacial_state_free(world->spacial);
+    collider_state_free(world->collider);
+    arena_state_free(world->arena);
+    manifold_state_free(world->manifold);
+    material_state_free(world->material);
+    bvh_state_free(world->bvh);
+    island_state_free(world->island);
+    physics_state_free(world->physics);
+
+    delete world;
+}
+
+PsxWorld* world_bind(PsxWorld* world) {
+    PsxWorld* previous = t_world;
+    t_world = world;
+    return previous;
+}
+
+PsxWorld* world_current() {
+    PsxWorld* world = t_world;
+    return world ? world : world_default();
+}
+
+PsxWorld* world_default() {
+    static PsxWorld* world = world_new();
+    return world;
+}